@@ -18,6 +18,7 @@ struct PointLight {
     float constant;
     float linear;
     float quadratic;
+    float radius;
 };
 struct SpotLight {
     vec3 position;
@@ -32,24 +33,35 @@ struct SpotLight {
     float quadratic;
 };
 
-#define NR_POINT_LIGHTS 4
-
 in vec3 FragPos;
 in vec3 Normal;
 in vec2 TexCoords;
+in vec3 Color;
+in float ViewDepth;
 
 out vec4 FragColor;
 
 uniform vec3 viewPos;
-uniform vec3 overrideColor;
 
 uniform DirLight dirLight;
-uniform PointLight pointLights[NR_POINT_LIGHTS];
 uniform SpotLight spotLight;
 uniform Material material;
 
+// clustered point lights (src/clustered_lights.h): the frustum is cut into clusterGrid
+// clusters, and each lists the lights that reach it
+uniform samplerBuffer pointLightData;        // 3 texels per light, the global lights first
+uniform usamplerBuffer clusterRanges;        // per cluster: first index, light count
+uniform usamplerBuffer clusterLightIndices;  // cluster after cluster
+uniform int clusterGlobalLights;             // lights reaching every cluster, not binned
+uniform bool clusterBinnedLights;            // false if every light is global: no lookup
+uniform ivec3 clusterGrid;
+uniform vec2 clusterTileSize;                // pixels
+uniform vec2 clusterDepthScaleBias;          // slice = log(view depth) * x + y
+
+PointLight FetchPointLight(int index);
+
 vec3 CalcDirLight(DirLight light, vec3 normal, vec3 viewDir);
-vec3 CalcPointLight(PointLight light, vec3 normal, vec3 fragPos, vec3 viewDir);
+vec3 CalcPointLight(PointLight light, vec3 normal, vec3 fragPos, vec3 viewDir, vec3 texDiffuse, vec3 texSpec);
 vec3 CalcSpotLight(SpotLight light, vec3 normal, vec3 fragPos, vec3 viewDir);
 
 void main()
@@ -63,11 +75,23 @@ void main()
 
     vec3 result = vec3(0.0);
     result += CalcDirLight(dirLight, norm, viewDir);
-    for (int i=0;i<NR_POINT_LIGHTS;i++) result += CalcPointLight(pointLights[i], norm, FragPos, viewDir);
+
+    // the global point lights, then only those of this fragment's cluster
+    for (int i = 0; i < clusterGlobalLights; i++)
+        result += CalcPointLight(FetchPointLight(i), norm, FragPos, viewDir, texDiffuse, texSpec);
+    if (clusterBinnedLights) {
+        ivec3 cell = ivec3(ivec2(gl_FragCoord.xy / clusterTileSize), int(floor(log(ViewDepth) * clusterDepthScaleBias.x + clusterDepthScaleBias.y)));
+        cell = clamp(cell, ivec3(0), clusterGrid - 1);
+        uvec2 range = texelFetch(clusterRanges, cell.x + clusterGrid.x * (cell.y + clusterGrid.y * cell.z)).xy;
+        for (uint i = 0u; i < range.y; i++) {
+            int index = int(texelFetch(clusterLightIndices, int(range.x + i)).r);
+            result += CalcPointLight(FetchPointLight(index), norm, FragPos, viewDir, texDiffuse, texSpec);
+        }
+    }
     result += CalcSpotLight(spotLight, norm, FragPos, viewDir);
 
-    // blend with texture and overrideColor
-    vec3 color = mix(texDiffuse, overrideColor, 0.15);
+    // blend with texture and the instance color
+    vec3 color = mix(texDiffuse, Color, 0.15);
     FragColor = vec4(result * color, 1.0);
 }
 
@@ -83,17 +107,40 @@ vec3 CalcDirLight(DirLight light, vec3 normal, vec3 viewDir)
     return ambient + diffuse + specular;
 }
 
-vec3 CalcPointLight(PointLight light, vec3 normal, vec3 fragPos, vec3 viewDir)
+PointLight FetchPointLight(int index)
+{
+    vec4 positionRadius = texelFetch(pointLightData, 3 * index);
+    vec4 colorLinear = texelFetch(pointLightData, 3 * index + 1);
+    PointLight light;
+    light.position = positionRadius.xyz;
+    light.radius = positionRadius.w;
+    light.ambient = colorLinear.rgb * 0.1;
+    light.diffuse = colorLinear.rgb * 0.8;
+    light.specular = colorLinear.rgb;
+    light.constant = 1.0;
+    light.linear = colorLinear.w;
+    light.quadratic = texelFetch(pointLightData, 3 * index + 2).x;
+    return light;
+}
+
+// texDiffuse and texSpec are sampled once in main, not once per light
+vec3 CalcPointLight(PointLight light, vec3 normal, vec3 fragPos, vec3 viewDir, vec3 texDiffuse, vec3 texSpec)
 {
+    float distance = length(light.position - fragPos);
+    // a cluster's lights reach some of it, not necessarily this fragment
+    if (distance >= light.radius) return vec3(0.0);
     vec3 lightDir = normalize(light.position - fragPos);
     float diff = max(dot(normal, lightDir), 0.0);
     vec3 reflectDir = reflect(-lightDir, normal);
     float spec = pow(max(dot(viewDir, reflectDir), 0.0), material.shininess);
-    float distance = length(light.position - fragPos);
     float attenuation = 1.0 / (light.constant + light.linear * distance + light.quadratic * (distance*distance));
-    vec3 ambient = light.ambient * vec3(texture(material.diffuse, TexCoords));
-    vec3 diffuse = light.diffuse * diff * vec3(texture(material.diffuse, TexCoords));
-    vec3 specular = light.specular * spec * vec3(texture(material.specular, TexCoords));
+    // faded to zero at the radius the lights were binned with: (1 - (d / r)^4)^2
+    float d2 = distance * distance / (light.radius * light.radius);
+    float fade = 1.0 - d2 * d2;
+    attenuation *= fade * fade;
+    vec3 ambient = light.ambient * texDiffuse;
+    vec3 diffuse = light.diffuse * diff * texDiffuse;
+    vec3 specular = light.specular * spec * texSpec;
     ambient *= attenuation; diffuse *= attenuation; specular *= attenuation;
     return ambient + diffuse + specular;
 }
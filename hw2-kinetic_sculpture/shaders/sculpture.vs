@@ -6,12 +6,15 @@ layout (location = 2) in vec2 aTexCoords;
 out vec3 FragPos;
 out vec3 Normal;
 out vec2 TexCoords;
+out vec3 Color;
+out float ViewDepth;  // picks the fragment's light cluster
 
 uniform mat4 model;
+uniform mat3 normalMatrix;  // computed once per cube on the CPU
 uniform mat4 view;
 uniform mat4 projection;
 uniform float time;
-uniform vec3 overrideColor; // optional per-instance color
+uniform vec3 overrideColor; // per-instance color
 
 void main()
 {
@@ -22,7 +25,10 @@ void main()
 
     vec4 worldPos = model * vec4(pos, 1.0);
     FragPos = vec3(worldPos);
-    Normal = mat3(transpose(inverse(model))) * aNormal;
+    Normal = normalMatrix * aNormal;
     TexCoords = aTexCoords;
-    gl_Position = projection * view * worldPos;
+    Color = overrideColor;
+    vec4 viewPos = view * worldPos;
+    ViewDepth = -viewPos.z;
+    gl_Position = projection * viewPos;
 }
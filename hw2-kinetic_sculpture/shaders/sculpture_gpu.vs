@@ -0,0 +1,75 @@
+#version 330 core
+layout (location = 0) in vec3 aPos;
+layout (location = 1) in vec3 aNormal;
+layout (location = 2) in vec2 aTexCoords;
+// per instance (attribute divisor 1), uploaded once
+layout (location = 3) in vec4 aBasePhase;  // base position, phase
+layout (location = 4) in float aOrbit;     // 1 if the cube orbits the world Y-axis
+layout (location = 5) in float aColorPhase;
+
+out vec3 FragPos;
+out vec3 Normal;
+out vec2 TexCoords;
+out vec3 Color;
+out float ViewDepth;  // picks the fragment's light cluster
+
+uniform mat4 view;
+uniform mat4 projection;
+uniform float time;
+
+// rotation of angle radians around axis, as glm::rotate
+mat3 rotation(float angle, vec3 axis)
+{
+    vec3 a = normalize(axis);
+    float c = cos(angle);
+    vec3 t = (1.0 - c) * a;
+    vec3 s = sin(angle) * a;
+    return mat3(t.x * a.x + c,   t.x * a.y + s.z, t.x * a.z - s.y,
+                t.y * a.x - s.z, t.y * a.y + c,   t.y * a.z + s.x,
+                t.z * a.x + s.y, t.z * a.y - s.x, t.z * a.z + c);
+}
+
+void main()
+{
+    // SculptureModel's kinetic motion (sculpture.h), evaluated per vertex from time
+    vec3 base = aBasePhase.xyz;
+    float phase = aBasePhase.w;
+
+    // Primary translation with wave motion
+    float waveOffset = sin(time * 1.5 + phase) * 0.4;
+    float spiralOffset = cos(time * 0.8 + phase * 0.7) * 0.3;
+    vec3 animatedPos = base + vec3(spiralOffset, waveOffset, spiralOffset * 0.5);
+
+    // orbit around world Y (rings and patterns only), then the two local rotations
+    mat3 rotate = rotation(time * 2.0 + phase, vec3(1.0, 0.3, 0.7)) * rotation(time * 1.2 + phase * 0.5, vec3(0.2, 1.0, 0.1));
+    if (aOrbit > 0.5)
+        rotate = rotation(time * 0.3 + phase, vec3(0.0, 1.0, 0.0)) * rotate;
+
+    // Dynamic scaling with breathing effect
+    float breathe = 0.3 + 0.15 * sin(time * 2.5 + phase * 0.8);
+    float pulse = 0.05 * sin(time * 8.0 + phase);
+
+    // small vertex displacement for 'breathing' effect (optional)
+    vec3 pos = aPos;
+    float disp = sin(time*3.0 + aPos.x*4.0 + aPos.y*3.0) * 0.02;
+    pos += normalize(aNormal) * disp;
+
+    mat3 upper = rotate * (breathe + pulse);
+    vec3 worldPos = animatedPos + upper * pos;
+    FragPos = worldPos;
+    // rotation and uniform scale only: the upper 3x3 is the normal matrix, as NormalMatrix gives it
+    Normal = upper * aNormal;
+    TexCoords = aTexCoords;
+
+    // SculptureColor
+    float colorPhase = aColorPhase + time * 0.5;
+    vec3 baseColor = vec3(0.4 + 0.4 * sin(colorPhase),
+                          0.5 + 0.3 * sin(colorPhase * 1.3 + 1.0),
+                          0.6 + 0.4 * sin(colorPhase * 0.7 + 2.0));
+    float heightFactor = (base.y + 5.0) / 10.0;
+    Color = mix(baseColor, vec3(0.8, 0.3, 0.9), heightFactor * 0.3);
+
+    vec4 viewPos = view * vec4(worldPos, 1.0);
+    ViewDepth = -viewPos.z;
+    gl_Position = projection * viewPos;
+}
@@ -0,0 +1,35 @@
+#version 330 core
+layout (location = 0) in vec3 aPos;
+layout (location = 1) in vec3 aNormal;
+layout (location = 2) in vec2 aTexCoords;
+// per instance (attribute divisor 1)
+layout (location = 3) in mat4 aModel;  // locations 3-6
+layout (location = 7) in vec3 aColor;
+layout (location = 8) in mat3 aNormalMatrix;  // locations 8-10
+
+out vec3 FragPos;
+out vec3 Normal;
+out vec2 TexCoords;
+out vec3 Color;
+out float ViewDepth;  // picks the fragment's light cluster
+
+uniform mat4 view;
+uniform mat4 projection;
+uniform float time;
+
+void main()
+{
+    // small vertex displacement for 'breathing' effect (optional)
+    vec3 pos = aPos;
+    float disp = sin(time*3.0 + aPos.x*4.0 + aPos.y*3.0) * 0.02;
+    pos += normalize(aNormal) * disp;
+
+    vec4 worldPos = aModel * vec4(pos, 1.0);
+    FragPos = vec3(worldPos);
+    Normal = aNormalMatrix * aNormal;
+    TexCoords = aTexCoords;
+    Color = aColor;
+    vec4 viewPos = view * worldPos;
+    ViewDepth = -viewPos.z;
+    gl_Position = projection * viewPos;
+}
@@ -0,0 +1,311 @@
+#ifndef BENCHMARK_H
+#define BENCHMARK_H
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include <glm/gtc/type_ptr.hpp>
+
+#include "filesystem.h"
+#include "sculpture.h"
+#include "sculpture_simd.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// Command-line benchmarks (--bench-*). CPU ones run before any window is created; GL
+// ones get a hidden window from main.
+class Benchmark
+{
+public:
+    // Per-frame model and normal matrices for count cubes (the sculpture's 92, then 10k
+    // and 100k, when count is 0). The glm chain is SculptureModel plus NormalMatrix, as the
+    // per-draw path computes them, against SculptureTransforms::Build. At a few times both are compared
+    // with the same transforms evaluated in double precision. The SIMD kernel fails if its
+    // largest error, on the model or the normal matrix, is more than twice the glm chain's.
+    static int Transforms(int count)
+    {
+        std::vector<int> counts;
+        if (count > 0)
+            counts.push_back(count);
+        else
+            counts = {SCULPTURE_CUBES, 10000, MAX_INSTANCES};
+        std::cout << "sculpture transforms (model + normal matrix), " << sculpture_lanes::LaneWidth << " SIMD lanes\n";
+
+        int failures = 0;
+        for (int n : counts)
+        {
+            std::vector<glm::vec3> instances = BuildSculpture(n);
+            SculptureTransforms transforms;
+            transforms.Assign(instances);
+            std::vector<glm::mat4> models(n), simdModels(n);
+            std::vector<glm::mat3> normals(n), simdNormals(n);
+
+            // about 2M cubes per path, and at least 10 frames
+            const int frames = std::max(10, 2000000 / n);
+            double glmMs = 0.0, simdMs = 0.0;
+            double glmModelError = 0.0, glmNormalError = 0.0, simdModelError = 0.0, simdNormalError = 0.0;
+            for (int f = 0; f < frames; f++)
+            {
+                const float time = 0.37f * (float)f;
+                auto start = Clock::now();
+                for (int i = 0; i < n; i++)
+                {
+                    models[i] = SculptureModel(instances[i], i, time);
+                    normals[i] = NormalMatrix(models[i]);
+                }
+                glmMs += Ms(start);
+                start = Clock::now();
+                transforms.Build(time, &simdModels[0][0][0], 16, &simdNormals[0][0][0], 9, nullptr, 0);
+                simdMs += Ms(start);
+
+                if (f % (frames / 3) != 0)
+                    continue;
+                for (int i = 0; i < n; i++)
+                {
+                    double model[4][3], normal[3][3];
+                    ReferenceTransform(instances[i], i, time, model, normal);
+                    glmModelError = std::max(glmModelError, ModelError(models[i], model));
+                    glmNormalError = std::max(glmNormalError, NormalError(normals[i], normal));
+                    simdModelError = std::max(simdModelError, ModelError(simdModels[i], model));
+                    simdNormalError = std::max(simdNormalError, NormalError(simdNormals[i], normal));
+                }
+            }
+
+            bool fail = simdModelError > 2.0 * glmModelError || simdNormalError > 2.0 * glmNormalError;
+            failures += fail;
+            std::cout << "  " << n << " cubes: glm " << Ns(glmMs, frames, n) << " ns/cube, SIMD " << Ns(simdMs, frames, n)
+                      << " ns/cube (" << glmMs / simdMs << "x)\n"
+                      << "    largest error against double precision: model glm " << glmModelError << ", SIMD " << simdModelError
+                      << "; normal matrix glm " << glmNormalError << ", SIMD " << simdNormalError << (fail ? "  FAIL" : "") << "\n";
+        }
+        return failures;
+    }
+
+    // GPU time of one instanced draw of count cubes (vao, its instance buffer already
+    // filled) under sculpture_instanced.vs, measured with GL_TIME_ELAPSED queries, with the
+    // shader's normal line in three forms: the normal matrix attribute, the model's upper
+    // 3x3 (the uniform-scale fast path in the shader), and the per-vertex
+    // transpose(inverse()) it replaced. Each is timed with rasterizer discard (vertex work
+    // only) and as a full draw; the median of several draws is reported. Next to the query
+    // is the wall time to glFinish: software renderers such as llvmpipe shade vertices
+    // inside the draw call, outside what GL_TIME_ELAPSED covers.
+    static int NormalMatrices(unsigned int vao, int count, const glm::mat4 &view, const glm::mat4 &projection)
+    {
+        const std::string vertex = ReadFile(FileSystem::getPath("shaders/sculpture_instanced.vs"));
+        const std::string fragment = ReadFile(FileSystem::getPath("shaders/sculpture.fs"));
+        const std::string normalLine = "Normal = aNormalMatrix * aNormal;";
+        const size_t at = vertex.find(normalLine);
+        if (at == std::string::npos)
+        {
+            std::cout << "ERROR::BENCHMARK:: no \"" << normalLine << "\" in sculpture_instanced.vs" << std::endl;
+            return 1;
+        }
+        struct Variant
+        {
+            const char *name;
+            const char *normalLine;
+        };
+        const Variant variants[] = {{"normal matrix attribute", "Normal = aNormalMatrix * aNormal;"},
+                                    {"model's upper 3x3", "Normal = mat3(aModel) * aNormal;"},
+                                    {"inverse per vertex", "Normal = mat3(transpose(inverse(aModel))) * aNormal;"}};
+
+        std::cout << "sculpture_instanced.vs normal matrix, " << count << " cubes (" << count * 36 << " vertices), "
+                  << glGetString(GL_RENDERER) << "\n";
+        const int Warmups = 2, Draws = 7;
+        GLuint query;
+        glGenQueries(1, &query);
+        glBindVertexArray(vao);
+        int failures = 0;
+        for (const Variant &variant : variants)
+        {
+            std::string source = vertex;
+            source.replace(at, normalLine.size(), variant.normalLine);
+            GLuint program = Program(source, fragment);
+            if (!program)
+            {
+                failures++;
+                continue;
+            }
+            glUseProgram(program);
+            glUniformMatrix4fv(glGetUniformLocation(program, "view"), 1, GL_FALSE, glm::value_ptr(view));
+            glUniformMatrix4fv(glGetUniformLocation(program, "projection"), 1, GL_FALSE, glm::value_ptr(projection));
+            glUniform1f(glGetUniformLocation(program, "time"), 1.0f);
+            // sampler types may not share a unit; the light buffers are left unbound (no point lights)
+            const char *samplers[] = {"material.diffuse", "material.specular", "pointLightData", "clusterRanges", "clusterLightIndices"};
+            for (int unit = 0; unit < 5; unit++)
+                glUniform1i(glGetUniformLocation(program, samplers[unit]), unit);
+
+            double gpuMs[2], wallMs[2];
+            for (int full = 0; full < 2; full++)
+            {
+                if (!full)
+                    glEnable(GL_RASTERIZER_DISCARD);
+                std::vector<double> gpu, wall;
+                for (int d = 0; d < Warmups + Draws; d++)
+                {
+                    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+                    glFinish();
+                    auto start = Clock::now();
+                    glBeginQuery(GL_TIME_ELAPSED, query);
+                    glDrawArraysInstanced(GL_TRIANGLES, 0, 36, count);
+                    glEndQuery(GL_TIME_ELAPSED);
+                    glFinish();
+                    double ms = Ms(start);
+                    GLuint64 ns = 0;
+                    glGetQueryObjectui64v(query, GL_QUERY_RESULT, &ns);
+                    if (d >= Warmups)
+                    {
+                        gpu.push_back(ns * 1e-6);
+                        wall.push_back(ms);
+                    }
+                }
+                glDisable(GL_RASTERIZER_DISCARD);
+                gpuMs[full] = Median(gpu);
+                wallMs[full] = Median(wall);
+            }
+            std::cout << "  " << variant.name << ": vertex only " << gpuMs[0] << " ms (wall " << wallMs[0] << " ms), full draw "
+                      << gpuMs[1] << " ms (wall " << wallMs[1] << " ms)\n";
+            glDeleteProgram(program);
+        }
+        glDeleteQueries(1, &query);
+        return failures;
+    }
+
+private:
+    typedef std::chrono::steady_clock Clock;
+
+    static double Median(std::vector<double> values)
+    {
+        std::sort(values.begin(), values.end());
+        return values[values.size() / 2];
+    }
+
+    static std::string ReadFile(const std::string &path)
+    {
+        std::ifstream file(path);
+        std::stringstream stream;
+        stream << file.rdbuf();
+        return stream.str();
+    }
+
+    // linked program from vertex and fragment source, or 0 (after printing the log)
+    static GLuint Program(const std::string &vertexSource, const std::string &fragmentSource)
+    {
+        GLuint program = glCreateProgram();
+        const std::string *sources[2] = {&vertexSource, &fragmentSource};
+        const GLenum types[2] = {GL_VERTEX_SHADER, GL_FRAGMENT_SHADER};
+        for (int i = 0; i < 2; i++)
+        {
+            GLuint shader = glCreateShader(types[i]);
+            const char *text = sources[i]->c_str();
+            glShaderSource(shader, 1, &text, NULL);
+            glCompileShader(shader);
+            glAttachShader(program, shader);
+            glDeleteShader(shader);
+        }
+        glLinkProgram(program);
+        GLint linked;
+        glGetProgramiv(program, GL_LINK_STATUS, &linked);
+        if (!linked)
+        {
+            GLchar log[1024];
+            glGetProgramInfoLog(program, 1024, NULL, log);
+            std::cout << "ERROR::BENCHMARK::PROGRAM_LINKING_ERROR\n" << log << std::endl;
+            glDeleteProgram(program);
+            return 0;
+        }
+        return program;
+    }
+
+    static double Ms(Clock::time_point start)
+    {
+        return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+    }
+
+    static double Ns(double ms, int frames, int count)
+    {
+        return ms * 1e6 / ((double)frames * count);
+    }
+
+    // SculptureModel in double precision, from the same float angles: model[column][row]
+    // (upper 3x4), and its normal matrix (the upper 3x3, as NormalMatrix gives for
+    // rotation * uniform scale)
+    static void ReferenceTransform(const glm::vec3 &pos, int i, float time, double model[4][3], double normal[3][3])
+    {
+        const float phase = (float)i * 0.15f;
+        const double spiralOffset = std::cos((double)(time * 0.8f + phase * 0.7f)) * 0.3;
+        model[3][0] = (double)pos.x + spiralOffset;
+        model[3][1] = (double)pos.y + std::sin((double)(time * 1.5f + phase)) * 0.4;
+        model[3][2] = (double)pos.z + spiralOffset * 0.5;
+
+        double rotation[3][3], local1[3][3], local2[3][3];
+        AxisRotation(glm::normalize(glm::vec3(1.0f, 0.3f, 0.7f)), time * 2.0f + phase, local1);
+        AxisRotation(glm::normalize(glm::vec3(0.2f, 1.0f, 0.1f)), time * 1.2f + phase * 0.5f, local2);
+        Multiply(local1, local2, rotation);
+        if (i >= SPIRAL_LEVELS)
+        {
+            double orbit[3][3], local[3][3];
+            AxisRotation(glm::vec3(0.0f, 1.0f, 0.0f), time * 0.3f + phase, orbit);
+            std::copy(&rotation[0][0], &rotation[0][0] + 9, &local[0][0]);
+            Multiply(orbit, local, rotation);
+        }
+
+        const double scale = 0.3 + 0.15 * std::sin((double)(time * 2.5f + phase * 0.8f)) + 0.05 * std::sin((double)(time * 8.0f + phase));
+        for (int column = 0; column < 3; column++)
+        {
+            for (int row = 0; row < 3; row++)
+            {
+                model[column][row] = rotation[column][row] * scale;
+                normal[column][row] = model[column][row];
+            }
+        }
+    }
+
+    static void AxisRotation(const glm::vec3 &axis, float angle, double r[3][3])
+    {
+        const double n[3] = {axis.x, axis.y, axis.z};
+        const double c = std::cos((double)angle), s = std::sin((double)angle);
+        for (int column = 0; column < 3; column++)
+            for (int row = 0; row < 3; row++)
+                r[column][row] = (1.0 - c) * n[row] * n[column] + (row == column ? c : 0.0);
+        r[0][1] += s * n[2];
+        r[0][2] -= s * n[1];
+        r[1][0] -= s * n[2];
+        r[1][2] += s * n[0];
+        r[2][0] += s * n[1];
+        r[2][1] -= s * n[0];
+    }
+
+    static void Multiply(const double a[3][3], const double b[3][3], double r[3][3])
+    {
+        for (int column = 0; column < 3; column++)
+            for (int row = 0; row < 3; row++)
+                r[column][row] = a[0][row] * b[column][0] + a[1][row] * b[column][1] + a[2][row] * b[column][2];
+    }
+
+    static double ModelError(const glm::mat4 &m, const double reference[4][3])
+    {
+        double error = 0.0;
+        for (int column = 0; column < 4; column++)
+            for (int row = 0; row < 3; row++)
+                error = std::max(error, std::fabs((double)m[column][row] - reference[column][row]));
+        return error;
+    }
+
+    static double NormalError(const glm::mat3 &m, const double reference[3][3])
+    {
+        double error = 0.0;
+        for (int column = 0; column < 3; column++)
+            for (int row = 0; row < 3; row++)
+                error = std::max(error, std::fabs((double)m[column][row] - reference[column][row]));
+        return error;
+    }
+};
+
+#endif
@@ -0,0 +1,417 @@
+#ifndef CLUSTERED_LIGHTS_H
+#define CLUSTERED_LIGHTS_H
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include "point_lights.h"
+#include "shader_m.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <initializer_list>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Clustered forward lighting: the view frustum is cut into TilesX x TilesY screen tiles
+// and Slices depth slices, exponentially spaced between the near and far planes. Each
+// frame every point light's sphere of influence is binned into the clusters it touches,
+// on all cores, and the per-cluster light lists go to the fragment shader as buffer
+// textures (GL 3.3 has no SSBOs). A fragment finds its cluster from gl_FragCoord and
+// its view depth and shades only that cluster's lights; see shaders/sculpture.fs.
+// Lights spanning the whole grid (the scene's six reach past the far plane) are not
+// binned: they come first in pointLightData, and every fragment shades them. When no
+// light is left to bin, the cluster lists are neither built nor uploaded and the shader
+// skips its cluster lookup.
+//
+// Buffer textures, bound from the unit given to Bind:
+//   pointLightData       RGBA32F, 3 texels per light: position, radius / color, linear /
+//                        quadratic; the global lights, then the binned ones
+//   clusterRanges        RG32UI, per cluster: first entry in clusterLightIndices, count
+//   clusterLightIndices  R16UI, lights (their place in pointLightData), cluster after
+//                        cluster
+class ClusteredLights
+{
+public:
+    static const int TilesX = 32;
+    static const int TilesY = 18;
+    static const int Slices = 48;
+    static const int ClusterCount = TilesX * TilesY * Slices;
+    static const int MaxLightsPerCluster = 128;  // further lights are dropped (and counted)
+
+    struct Stats
+    {
+        double buildMs = 0.0;     // binning and packing, without the upload
+        int visibleLights = 0;    // lights touching the frustum
+        int globalLights = 0;     // shaded everywhere instead of binned
+        int indices = 0;          // entries over all clusters
+        int maxClusterLights = 0;
+        int dropped = 0;          // past MaxLightsPerCluster
+    };
+
+    // Needs a current GL context, and Release before that context goes. workerCount 0 = one per hardware thread (the calling
+    // thread included), at most one per slice.
+    explicit ClusteredLights(int workerCount = 0)
+    {
+        if (workerCount <= 0)
+            workerCount = (int)std::thread::hardware_concurrency();
+        workerCount = std::min(std::max(workerCount, 1), Slices);
+        for (int w = 1; w < workerCount; w++)
+            threads.emplace_back(&ClusteredLights::WorkerLoop, this, w);
+
+        scratch.resize((size_t)ClusterCount * MaxLightsPerCluster);
+        counts.resize(ClusterCount);
+        ranges.resize(ClusterCount * 2);
+        sliceDropped.resize(Slices);
+
+        glGenBuffers(3, buffers);
+        glGenTextures(3, textures);
+        const GLenum formats[3] = { GL_RGBA32F, GL_RG32UI, GL_R16UI };
+        for (int i = 0; i < 3; i++) {
+            glBindBuffer(GL_TEXTURE_BUFFER, buffers[i]);
+            glBufferData(GL_TEXTURE_BUFFER, 16, NULL, GL_STREAM_DRAW);
+            glBindTexture(GL_TEXTURE_BUFFER, textures[i]);
+            glTexBuffer(GL_TEXTURE_BUFFER, formats[i], buffers[i]);
+        }
+        glBindTexture(GL_TEXTURE_BUFFER, 0);
+        glBindBuffer(GL_TEXTURE_BUFFER, 0);
+    }
+
+    ~ClusteredLights()
+    {
+        {
+            std::lock_guard<std::mutex> guard(lock);
+            quit = true;
+        }
+        wake.notify_all();
+        for (std::thread &thread : threads)
+            thread.join();
+    }
+
+    // Deletes the buffers and textures, while the GL context is still current
+    void Release()
+    {
+        glDeleteTextures(3, textures);
+        glDeleteBuffers(3, buffers);
+    }
+
+    ClusteredLights(const ClusteredLights &) = delete;
+    ClusteredLights &operator=(const ClusteredLights &) = delete;
+
+    // Bins lights (at world positions) into the clusters of the frustum of view and
+    // projection, a glm::perspective with the given near and far planes, and uploads
+    // the light data and cluster lists.
+    void Update(const std::vector<PointLightParams> &lights, const std::vector<glm::vec3> &positions,
+                const glm::mat4 &view, const glm::mat4 &projection, float zNear, float zFar)
+    {
+        auto start = Clock::now();
+        if (projection[0][0] != xScale || projection[1][1] != yScale || zNear != nearPlane || zFar != farPlane) {
+            xScale = projection[0][0];
+            yScale = projection[1][1];
+            nearPlane = zNear;
+            farPlane = zFar;
+            BuildClusterBounds();
+        }
+
+        source = &lights;
+        worldPositions = &positions;
+        viewMatrix = view;
+        lightCount = (int)std::min(lights.size(), positions.size());
+        bounds.resize(lightCount);
+        slots.resize(lightCount);
+        Parallel(BOUND_LIGHTS);
+
+        // the global lights, then the binned ones, each as its 3 texels; a binned light's
+        // place among them is what the cluster lists hold
+        stats = Stats();
+        lightTexels.clear();
+        binned.clear();
+        for (int i = 0; i < lightCount; i++) {
+            if (!bounds[i].visible)
+                continue;
+            stats.visibleLights++;
+            if (bounds[i].global)
+                AddTexels(i);
+            else
+                binned.push_back(i);
+        }
+        stats.globalLights = stats.visibleLights - (int)binned.size();
+        for (size_t k = 0; k < binned.size(); k++) {
+            slots[binned[k]] = (GLushort)(stats.globalLights + k);
+            AddTexels(binned[k]);
+        }
+
+        // the cluster lists packed back to back; with every light global the shader
+        // skips the lookup, so they are left as they were
+        indices.clear();
+        if (!binned.empty()) {
+            Parallel(BIN_SLICES);
+            for (int c = 0; c < ClusterCount; c++) {
+                ranges[2 * c] = (GLuint)indices.size();
+                ranges[2 * c + 1] = (GLuint)counts[c];
+                const GLushort *list = &scratch[(size_t)c * MaxLightsPerCluster];
+                indices.insert(indices.end(), list, list + counts[c]);
+                stats.maxClusterLights = std::max(stats.maxClusterLights, counts[c]);
+            }
+            for (int s = 0; s < Slices; s++)
+                stats.dropped += sliceDropped[s];
+        }
+        stats.indices = (int)indices.size();
+        stats.buildMs = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+
+        Upload(0, lightTexels.data(), lightTexels.size() * sizeof(glm::vec4));
+        if (!binned.empty()) {
+            Upload(1, ranges.data(), ranges.size() * sizeof(GLuint));
+            Upload(2, indices.data(), indices.size() * sizeof(GLushort));
+        }
+    }
+
+    // Binds the buffer textures to texture units firstUnit to firstUnit + 2 and sets the
+    // cluster uniforms of shader, which must be in use
+    void Bind(const Shader &shader, int firstUnit, int framebufferWidth, int framebufferHeight) const
+    {
+        const char *samplers[3] = { "pointLightData", "clusterRanges", "clusterLightIndices" };
+        for (int i = 0; i < 3; i++) {
+            glActiveTexture(GL_TEXTURE0 + firstUnit + i);
+            glBindTexture(GL_TEXTURE_BUFFER, textures[i]);
+            shader.setInt(samplers[i], firstUnit + i);
+        }
+        glUniform3i(glGetUniformLocation(shader.ID, "clusterGrid"), TilesX, TilesY, Slices);
+        shader.setVec2("clusterTileSize", (float)framebufferWidth / TilesX, (float)framebufferHeight / TilesY);
+        // slice = log(depth) * scale + bias
+        float scale = Slices / std::log(farPlane / nearPlane);
+        shader.setVec2("clusterDepthScaleBias", scale, -std::log(nearPlane) * scale);
+        shader.setInt("clusterGlobalLights", stats.globalLights);
+        shader.setBool("clusterBinnedLights", !binned.empty());
+    }
+
+    const Stats &GetStats() const { return stats; }
+
+private:
+    typedef std::chrono::steady_clock Clock;
+    enum Phase { BOUND_LIGHTS, BIN_SLICES };
+
+    // a light's view-space sphere and the block of clusters around it
+    struct LightBounds
+    {
+        glm::vec3 center;
+        float radius;
+        bool visible;
+        bool global;  // spans every cluster, so it is not binned
+        int slice0, slice1, tileX0, tileX1, tileY0, tileY1;
+    };
+
+    struct Box
+    {
+        glm::vec3 min, max;
+    };
+
+    int Slice(float depth) const
+    {
+        int slice = (int)std::floor(std::log(depth / nearPlane) / std::log(farPlane / nearPlane) * Slices);
+        return std::min(std::max(slice, 0), Slices - 1);
+    }
+
+    static int Tile(float ndc, int tiles)
+    {
+        int tile = (int)std::floor((ndc * 0.5f + 0.5f) * tiles);
+        return std::min(std::max(tile, 0), tiles - 1);
+    }
+
+    // view-space boxes of every cluster: the tile's corner rays between the slice's depths
+    void BuildClusterBounds()
+    {
+        clusterBounds.resize(ClusterCount);
+        for (int s = 0; s < Slices; s++) {
+            float d0 = nearPlane * std::pow(farPlane / nearPlane, (float)s / Slices);
+            float d1 = nearPlane * std::pow(farPlane / nearPlane, (float)(s + 1) / Slices);
+            for (int y = 0; y < TilesY; y++) {
+                float y0 = (2.0f * y / TilesY - 1.0f) / yScale, y1 = (2.0f * (y + 1) / TilesY - 1.0f) / yScale;
+                for (int x = 0; x < TilesX; x++) {
+                    float x0 = (2.0f * x / TilesX - 1.0f) / xScale, x1 = (2.0f * (x + 1) / TilesX - 1.0f) / xScale;
+                    Box &box = clusterBounds[x + TilesX * (y + TilesY * s)];
+                    box.min = glm::vec3(std::min(x0 * d0, x0 * d1), std::min(y0 * d0, y0 * d1), -d1);
+                    box.max = glm::vec3(std::max(x1 * d0, x1 * d1), std::max(y1 * d0, y1 * d1), -d0);
+                }
+            }
+        }
+    }
+
+    // lights [begin, end): view-space sphere, depth slices and a conservative tile
+    // rectangle; global if that is the whole grid
+    void BoundLights(int begin, int end)
+    {
+        for (int i = begin; i < end; i++) {
+            LightBounds &light = bounds[i];
+            light.center = glm::vec3(viewMatrix * glm::vec4((*worldPositions)[i], 1.0f));
+            light.radius = (*source)[i].radius;
+            float depth = -light.center.z;
+            float zMin = depth - light.radius, zMax = depth + light.radius;
+            light.visible = zMax >= nearPlane && zMin <= farPlane;
+            if (!light.visible)
+                continue;
+            light.slice0 = Slice(std::max(zMin, nearPlane));
+            light.slice1 = Slice(std::min(zMax, farPlane));
+
+            light.global = false;
+            if (zMin <= nearPlane) {
+                // reaches the camera's plane: any tile
+                light.tileX0 = light.tileY0 = 0;
+                light.tileX1 = TilesX - 1;
+                light.tileY1 = TilesY - 1;
+                light.global = light.slice0 == 0 && light.slice1 == Slices - 1;
+                continue;
+            }
+            // the sphere's view-space box projects inside its four nearest and farthest corners
+            float xMin = 1e30f, xMax = -1e30f, yMin = 1e30f, yMax = -1e30f;
+            for (float d : { zMin, zMax }) {
+                for (float sign : { -1.0f, 1.0f }) {
+                    float x = xScale * (light.center.x + sign * light.radius) / d;
+                    float y = yScale * (light.center.y + sign * light.radius) / d;
+                    xMin = std::min(xMin, x); xMax = std::max(xMax, x);
+                    yMin = std::min(yMin, y); yMax = std::max(yMax, y);
+                }
+            }
+            light.visible = xMax >= -1.0f && xMin <= 1.0f && yMax >= -1.0f && yMin <= 1.0f;
+            light.tileX0 = Tile(xMin, TilesX);
+            light.tileX1 = Tile(xMax, TilesX);
+            light.tileY0 = Tile(yMin, TilesY);
+            light.tileY1 = Tile(yMax, TilesY);
+        }
+    }
+
+    // slices [begin, end): each light's sphere against the boxes of its clusters there.
+    // Slices own disjoint clusters, so workers never share a list.
+    void BinSlices(int begin, int end)
+    {
+        for (int s = begin; s < end; s++) {
+            sliceDropped[s] = 0;
+            int *sliceCounts = &counts[TilesX * TilesY * s];
+            std::fill(sliceCounts, sliceCounts + TilesX * TilesY, 0);
+            for (int i = 0; i < lightCount; i++) {
+                const LightBounds &light = bounds[i];
+                if (!light.visible || light.global || s < light.slice0 || s > light.slice1)
+                    continue;
+                float radius2 = light.radius * light.radius;
+                for (int y = light.tileY0; y <= light.tileY1; y++) {
+                    for (int x = light.tileX0; x <= light.tileX1; x++) {
+                        int cluster = x + TilesX * (y + TilesY * s);
+                        const Box &box = clusterBounds[cluster];
+                        glm::vec3 offset = light.center - glm::clamp(light.center, box.min, box.max);
+                        if (glm::dot(offset, offset) > radius2)
+                            continue;
+                        int &count = counts[cluster];
+                        if (count == MaxLightsPerCluster) {
+                            sliceDropped[s]++;
+                            continue;
+                        }
+                        scratch[(size_t)cluster * MaxLightsPerCluster + count++] = slots[i];
+                    }
+                }
+            }
+        }
+    }
+
+    void RunPhase(Phase phase, int worker)
+    {
+        const int workers = (int)threads.size() + 1;
+        const int count = phase == BOUND_LIGHTS ? lightCount : Slices;
+        const int begin = count * worker / workers, end = count * (worker + 1) / workers;
+        if (phase == BOUND_LIGHTS)
+            BoundLights(begin, end);
+        else
+            BinSlices(begin, end);
+    }
+
+    // runs phase on every worker, the calling thread being worker 0, and waits for them
+    void Parallel(Phase phase)
+    {
+        if (!threads.empty()) {
+            std::lock_guard<std::mutex> guard(lock);
+            currentPhase = phase;
+            generation++;
+            busy = (int)threads.size();
+        }
+        wake.notify_all();
+        RunPhase(phase, 0);
+        std::unique_lock<std::mutex> guard(lock);
+        done.wait(guard, [this] { return busy == 0; });
+    }
+
+    void WorkerLoop(int worker)
+    {
+        unsigned int seen = 0;
+        for (;;) {
+            Phase phase;
+            {
+                std::unique_lock<std::mutex> guard(lock);
+                wake.wait(guard, [&] { return quit || generation != seen; });
+                if (quit)
+                    return;
+                seen = generation;
+                phase = currentPhase;
+            }
+            RunPhase(phase, worker);
+            std::lock_guard<std::mutex> guard(lock);
+            if (--busy == 0)
+                done.notify_one();
+        }
+    }
+
+    // light i's 3 texels, appended to lightTexels
+    void AddTexels(int i)
+    {
+        const PointLightParams &light = (*source)[i];
+        lightTexels.push_back(glm::vec4((*worldPositions)[i], light.radius));
+        lightTexels.push_back(glm::vec4(light.color, light.linear));
+        lightTexels.push_back(glm::vec4(light.quadratic, 0.0f, 0.0f, 0.0f));
+    }
+
+    // orphans the buffer's storage, so the upload does not wait for draws still reading it
+    void Upload(int i, const void *data, size_t bytes)
+    {
+        glBindBuffer(GL_TEXTURE_BUFFER, buffers[i]);
+        glBufferData(GL_TEXTURE_BUFFER, std::max(bytes, (size_t)16), NULL, GL_STREAM_DRAW);
+        glBufferSubData(GL_TEXTURE_BUFFER, 0, bytes, data);
+        glBindBuffer(GL_TEXTURE_BUFFER, 0);
+    }
+
+    // frustum the cluster boxes were built for
+    float xScale = 0.0f, yScale = 0.0f, nearPlane = 0.0f, farPlane = 0.0f;
+    std::vector<Box> clusterBounds;
+
+    // this frame's input and per-light bounds
+    const std::vector<PointLightParams> *source = nullptr;
+    const std::vector<glm::vec3> *worldPositions = nullptr;
+    glm::mat4 viewMatrix;
+    int lightCount = 0;
+    std::vector<LightBounds> bounds;
+    std::vector<int> binned;        // visible and not global
+    std::vector<GLushort> slots;    // a binned light's place in pointLightData
+
+    // per cluster, MaxLightsPerCluster slots and how many are used
+    std::vector<GLushort> scratch;
+    std::vector<int> counts;
+    std::vector<int> sliceDropped;
+
+    // what gets uploaded
+    std::vector<glm::vec4> lightTexels;
+    std::vector<GLuint> ranges;
+    std::vector<GLushort> indices;
+    GLuint buffers[3];
+    GLuint textures[3];
+    Stats stats;
+
+    std::vector<std::thread> threads;
+    std::mutex lock;
+    std::condition_variable wake, done;
+    Phase currentPhase = BOUND_LIGHTS;
+    unsigned int generation = 0;  // bumped per phase; guarded by lock, as are busy and quit
+    int busy = 0;
+    bool quit = false;
+};
+
+#endif
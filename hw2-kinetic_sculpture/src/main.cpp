@@ -13,10 +13,19 @@
 #include "filesystem.h"
 #include "shader_m.h"
 #include "camera.h"
+#include "sculpture.h"
+#include "sculpture_simd.h"
+#include "point_lights.h"
+#include "clustered_lights.h"
+#include "benchmark.h"
 
 #include <iostream>
 #include <vector>
 #include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cstddef>
 
 void framebuffer_size_callback(GLFWwindow* window, int width, int height);
 void mouse_callback(GLFWwindow* window, double xpos, double ypos);
@@ -38,8 +47,60 @@ bool firstMouse = true;
 float deltaTime = 0.0f;
 float lastFrame = 0.0f;
 
-int main()
+// how the sculpture is drawn (M cycles through them)
+enum RenderPath { PER_DRAW, INSTANCED, GPU_MOTION, RENDER_PATH_COUNT };
+const char* RENDER_PATH_NAMES[RENDER_PATH_COUNT] = { "per-draw", "instanced", "GPU motion" };
+RenderPath renderPath = INSTANCED;
+bool renderPathKeyDown = false;
+
+// per-instance vertex attributes of the instanced path
+struct InstanceData {
+    glm::mat4 model;
+    glm::vec3 color;
+    glm::mat3 normalMatrix;
+};
+
+int main(int argc, char** argv)
 {
+    // --bench-transforms [N]: CPU transform builder timings and accuracy, no window needed
+    if (argc > 1 && strcmp(argv[1], "--bench-transforms") == 0) {
+        return Benchmark::Transforms(argc > 2 ? atoi(argv[2]) : 0);
+    }
+    // --bench-normals [N]: vertex shader cost of the normal matrix for N cubes (default
+    // MAX_INSTANCES), GL timer queries and wall time in a hidden window
+    bool benchNormals = argc > 1 && strcmp(argv[1], "--bench-normals") == 0;
+
+    // command line: --instances N   number of cubes (up to MAX_INSTANCES)
+    //               --per-draw      start on the one-draw-call-per-cube path
+    //               --gpu-motion    start on the path evaluating the motion in the vertex shader
+    //               --no-vsync      uncapped frame rate, to compare the paths
+    //               --lights N      number of point lights (up to MAX_POINT_LIGHTS)
+    int instanceCount = SCULPTURE_CUBES;
+    int lightCount = SCENE_POINT_LIGHTS;
+    bool vsync = true;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--instances") == 0 && i + 1 < argc) {
+            instanceCount = atoi(argv[++i]);
+            if (instanceCount < 1) instanceCount = 1;
+            if (instanceCount > MAX_INSTANCES) instanceCount = MAX_INSTANCES;
+        } else if (strcmp(argv[i], "--per-draw") == 0) {
+            renderPath = PER_DRAW;
+        } else if (strcmp(argv[i], "--gpu-motion") == 0) {
+            renderPath = GPU_MOTION;
+        } else if (strcmp(argv[i], "--no-vsync") == 0) {
+            vsync = false;
+        } else if (strcmp(argv[i], "--lights") == 0 && i + 1 < argc) {
+            lightCount = atoi(argv[++i]);
+            if (lightCount < 1) lightCount = 1;
+            if (lightCount > MAX_POINT_LIGHTS) lightCount = MAX_POINT_LIGHTS;
+        }
+    }
+    if (benchNormals) {
+        instanceCount = argc > 2 ? atoi(argv[2]) : MAX_INSTANCES;
+        if (instanceCount < 1) instanceCount = 1;
+        if (instanceCount > MAX_INSTANCES) instanceCount = MAX_INSTANCES;
+    }
+
     // glfw init
     glfwInit();
     glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
@@ -48,10 +109,12 @@ int main()
 #ifdef __APPLE__
     glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
 #endif
+    if (benchNormals) glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
 
     GLFWwindow* window = glfwCreateWindow(SCR_WIDTH, SCR_HEIGHT, "Enhanced Kinetic Sculpture", NULL, NULL);
     if (!window) { std::cout<<"Failed creating window\n"; glfwTerminate(); return -1; }
     glfwMakeContextCurrent(window);
+    glfwSwapInterval(vsync ? 1 : 0);
     glfwSetFramebufferSizeCallback(window, framebuffer_size_callback);
     glfwSetCursorPosCallback(window, mouse_callback);
     glfwSetScrollCallback(window, scroll_callback);
@@ -62,7 +125,13 @@ int main()
 
     // shaders
     Shader sculptureShader(FileSystem::getPath("shaders/sculpture.vs").c_str(), FileSystem::getPath("shaders/sculpture.fs").c_str());
+    Shader instancedShader(FileSystem::getPath("shaders/sculpture_instanced.vs").c_str(), FileSystem::getPath("shaders/sculpture.fs").c_str());
+    Shader gpuMotionShader(FileSystem::getPath("shaders/sculpture_gpu.vs").c_str(), FileSystem::getPath("shaders/sculpture.fs").c_str());
     Shader lightCubeShader(FileSystem::getPath("shaders/light_cube.vs").c_str(), FileSystem::getPath("shaders/light_cube.fs").c_str());
+    // the per-draw path sets these for every cube: looked up once, not by name per call
+    const GLint modelLocation = glGetUniformLocation(sculptureShader.ID, "model");
+    const GLint normalMatrixLocation = glGetUniformLocation(sculptureShader.ID, "normalMatrix");
+    const GLint overrideColorLocation = glGetUniformLocation(sculptureShader.ID, "overrideColor");
 
     // base cube vertices (position, normal, texcoords)
     float vertices[] = {
@@ -123,24 +192,90 @@ int main()
     glBindBuffer(GL_ARRAY_BUFFER, VBO);
     glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
 
+    // the cube's vertex attributes, for the bound VAO
+    auto cubeAttributes = [&]() {
+        glBindBuffer(GL_ARRAY_BUFFER, VBO);
+        // pos
+        glVertexAttribPointer(0,3,GL_FLOAT,GL_FALSE,8*sizeof(float),(void*)0);
+        glEnableVertexAttribArray(0);
+        // normal
+        glVertexAttribPointer(1,3,GL_FLOAT,GL_FALSE,8*sizeof(float),(void*)(3*sizeof(float)));
+        glEnableVertexAttribArray(1);
+        // texcoords
+        glVertexAttribPointer(2,2,GL_FLOAT,GL_FALSE,8*sizeof(float),(void*)(6*sizeof(float)));
+        glEnableVertexAttribArray(2);
+    };
+
     glBindVertexArray(cubeVAO);
-    // pos
-    glVertexAttribPointer(0,3,GL_FLOAT,GL_FALSE,8*sizeof(float),(void*)0);
-    glEnableVertexAttribArray(0);
-    // normal
-    glVertexAttribPointer(1,3,GL_FLOAT,GL_FALSE,8*sizeof(float),(void*)(3*sizeof(float)));
-    glEnableVertexAttribArray(1);
-    // texcoords
-    glVertexAttribPointer(2,2,GL_FLOAT,GL_FALSE,8*sizeof(float),(void*)(6*sizeof(float)));
-    glEnableVertexAttribArray(2);
-
-    // light cube VAO
-    unsigned int lightCubeVAO;
+    cubeAttributes();
+
+    // Enhanced sculpture configuration: Create multiple interconnected structures
+    // (spiral tower, orbiting rings and floating patterns, then an outer field up to instanceCount)
+    std::vector<glm::vec3> instances = BuildSculpture(instanceCount);
+    std::vector<InstanceData> instanceData(instances.size());
+    // the instanced path's CPU motion, several cubes at a time
+    SculptureTransforms sculptureTransforms;
+    sculptureTransforms.Assign(instances);
+
+    // instanced cube VAO: the cube's vertices plus one model matrix, color and normal matrix per instance
+    unsigned int instanceVBO, instancedVAO;
+    glGenVertexArrays(1, &instancedVAO);
+    glGenBuffers(1, &instanceVBO);
+    glBindVertexArray(instancedVAO);
+    cubeAttributes();
+    glBindBuffer(GL_ARRAY_BUFFER, instanceVBO);
+    glBufferData(GL_ARRAY_BUFFER, instanceCount * sizeof(InstanceData), NULL, GL_STREAM_DRAW);
+    // a mat4 attribute takes four locations, one per column
+    for (int column = 0; column < 4; column++) {
+        glVertexAttribPointer(3 + column, 4, GL_FLOAT, GL_FALSE, sizeof(InstanceData), (void*)(column * sizeof(glm::vec4)));
+        glEnableVertexAttribArray(3 + column);
+        glVertexAttribDivisor(3 + column, 1);
+    }
+    glVertexAttribPointer(7, 3, GL_FLOAT, GL_FALSE, sizeof(InstanceData), (void*)offsetof(InstanceData, color));
+    glEnableVertexAttribArray(7);
+    glVertexAttribDivisor(7, 1);
+    // the normal matrix, a mat3: three locations from 8
+    for (int column = 0; column < 3; column++) {
+        glVertexAttribPointer(8 + column, 3, GL_FLOAT, GL_FALSE, sizeof(InstanceData), (void*)(offsetof(InstanceData, normalMatrix) + column * sizeof(glm::vec3)));
+        glEnableVertexAttribArray(8 + column);
+        glVertexAttribDivisor(8 + column, 1);
+    }
+
+    // GPU motion VAO: the cube's vertices plus each cube's static motion parameters, uploaded
+    // once; sculpture_gpu.vs evaluates the motion and color from time
+    std::vector<SculptureParams> sculptureParams = BuildSculptureParams(instances);
+    unsigned int paramsVBO, gpuMotionVAO;
+    glGenVertexArrays(1, &gpuMotionVAO);
+    glGenBuffers(1, &paramsVBO);
+    glBindVertexArray(gpuMotionVAO);
+    cubeAttributes();
+    glBindBuffer(GL_ARRAY_BUFFER, paramsVBO);
+    glBufferData(GL_ARRAY_BUFFER, sculptureParams.size() * sizeof(SculptureParams), sculptureParams.data(), GL_STATIC_DRAW);
+    glVertexAttribPointer(3, 4, GL_FLOAT, GL_FALSE, sizeof(SculptureParams), (void*)offsetof(SculptureParams, position));
+    glEnableVertexAttribArray(3);
+    glVertexAttribDivisor(3, 1);
+    glVertexAttribPointer(4, 1, GL_FLOAT, GL_FALSE, sizeof(SculptureParams), (void*)offsetof(SculptureParams, orbit));
+    glEnableVertexAttribArray(4);
+    glVertexAttribDivisor(4, 1);
+    glVertexAttribPointer(5, 1, GL_FLOAT, GL_FALSE, sizeof(SculptureParams), (void*)offsetof(SculptureParams, colorPhase));
+    glEnableVertexAttribArray(5);
+    glVertexAttribDivisor(5, 1);
+
+    // light cube VAO: the cube's positions plus one model matrix per light
+    unsigned int lightCubeVAO, lightModelVBO;
     glGenVertexArrays(1,&lightCubeVAO);
+    glGenBuffers(1, &lightModelVBO);
     glBindVertexArray(lightCubeVAO);
     glBindBuffer(GL_ARRAY_BUFFER,VBO);
     glVertexAttribPointer(0,3,GL_FLOAT,GL_FALSE,8*sizeof(float),(void*)0);
     glEnableVertexAttribArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, lightModelVBO);
+    glBufferData(GL_ARRAY_BUFFER, lightCount * sizeof(glm::mat4), NULL, GL_STREAM_DRAW);
+    for (int column = 0; column < 4; column++) {
+        glVertexAttribPointer(3 + column, 4, GL_FLOAT, GL_FALSE, sizeof(glm::mat4), (void*)(column * sizeof(glm::vec4)));
+        glEnableVertexAttribArray(3 + column);
+        glVertexAttribDivisor(3 + column, 1);
+    }
 
     // load textures
     unsigned int diffuseMap = loadTexture(FileSystem::getPath("resources/textures/3DPear004_HQ-1K-PNG_Color.png").c_str());
@@ -149,67 +284,39 @@ int main()
     sculptureShader.use();
     sculptureShader.setInt("material.diffuse", 0);
     sculptureShader.setInt("material.specular", 1);
-
-    // Enhanced sculpture configuration: Create multiple interconnected structures
-    std::vector<glm::vec3> instances;
-    
-    // Central spiral tower
-    const int SPIRAL_LEVELS = 20;
-    for (int i = 0; i < SPIRAL_LEVELS; i++) {
-        float height = (float)i * 0.4f - 4.0f;
-        float angle = (float)i * 0.5f;
-        float radius = 2.0f + sin((float)i * 0.3f) * 1.0f;
-        
-        float x = radius * cos(angle);
-        float z = radius * sin(angle);
-        instances.push_back(glm::vec3(x, height, z));
-    }
-    
-    // Orbiting rings
-    const int RINGS = 3;
-    const int RING_SEGMENTS = 16;
-    for (int ring = 0; ring < RINGS; ring++) {
-        float ringHeight = (float)ring * 3.0f - 2.0f;
-        float ringRadius = 5.0f + (float)ring * 1.5f;
-        
-        for (int i = 0; i < RING_SEGMENTS; i++) {
-            float angle = (float)i / (float)RING_SEGMENTS * glm::two_pi<float>();
-            float x = ringRadius * cos(angle);
-            float z = ringRadius * sin(angle);
-            instances.push_back(glm::vec3(x, ringHeight, z));
-        }
-    }
-    
-    // Floating geometric patterns
-    const int PATTERN_COUNT = 24;
-    for (int i = 0; i < PATTERN_COUNT; i++) {
-        float angle = (float)i / (float)PATTERN_COUNT * glm::two_pi<float>();
-        float radius = 8.0f;
-        float x = radius * cos(angle);
-        float z = radius * sin(angle);
-        float y = sin(angle * 3.0f) * 2.0f;
-        instances.push_back(glm::vec3(x, y, z));
+    instancedShader.use();
+    instancedShader.setInt("material.diffuse", 0);
+    instancedShader.setInt("material.specular", 1);
+    gpuMotionShader.use();
+    gpuMotionShader.setInt("material.diffuse", 0);
+    gpuMotionShader.setInt("material.specular", 1);
+
+    if (benchNormals) {
+        // the instance buffer as the instanced path fills it, one second in
+        const size_t stride = sizeof(InstanceData) / sizeof(float);
+        sculptureTransforms.Build(1.0f, &instanceData[0].model[0][0], stride, &instanceData[0].normalMatrix[0][0], stride,
+                                  &instanceData[0].color[0], stride);
+        glBindBuffer(GL_ARRAY_BUFFER, instanceVBO);
+        glBufferSubData(GL_ARRAY_BUFFER, 0, instanceData.size() * sizeof(InstanceData), instanceData.data());
+        glm::mat4 projection = glm::perspective(glm::radians(camera.Zoom), (float)SCR_WIDTH/(float)SCR_HEIGHT, 0.1f, 100.0f);
+        int failures = Benchmark::NormalMatrices(instancedVAO, instanceCount, camera.GetViewMatrix(), projection);
+        glfwTerminate();
+        return failures;
     }
 
-    // Enhanced multiple light sources with varied colors
-    std::vector<glm::vec3> pointLightPositions = {
-        glm::vec3( 6.0f,  4.0f,  6.0f),   // warm orange light
-        glm::vec3(-6.0f,  2.0f, -6.0f),  // cool blue light
-        glm::vec3( 0.0f, -3.0f,  8.0f),  // purple light
-        glm::vec3( 8.0f,  1.0f, -4.0f),  // green light
-        glm::vec3(-4.0f,  6.0f,  4.0f),  // red light
-        glm::vec3( 2.0f, -2.0f, -8.0f)   // cyan light
-    };
+    // Enhanced multiple light sources with varied colors: the scene's six, then accent
+    // lights up to lightCount, binned into view frustum clusters every frame
+    std::vector<PointLightParams> pointLights = BuildPointLights(lightCount);
+    std::vector<glm::vec3> lightPositions(pointLights.size());
+    std::vector<glm::mat4> lightModels(pointLights.size());
+    ClusteredLights clusteredLights;
 
-    // Light colors for variety
-    std::vector<glm::vec3> lightColors = {
-        glm::vec3(1.0f, 0.7f, 0.3f),  // warm orange
-        glm::vec3(0.3f, 0.7f, 1.0f),  // cool blue
-        glm::vec3(0.8f, 0.3f, 1.0f),  // purple
-        glm::vec3(0.3f, 1.0f, 0.5f),  // green
-        glm::vec3(1.0f, 0.3f, 0.3f),  // red
-        glm::vec3(0.3f, 1.0f, 1.0f)   // cyan
-    };
+    // frame statistics, shown in the title about once a second
+    RenderPath statsPath = renderPath;
+    float statsStart = (float)glfwGetTime();
+    int statsFrames = 0;
+    double sculptureCpuTime = 0.0;
+    double clusterCpuTime = 0.0;
 
     // render loop
     while(!glfwWindowShouldClose(window)){
@@ -219,65 +326,74 @@ int main()
 
         processInput(window);
 
+        if (renderPath != statsPath || currentFrame - statsStart >= 1.0f) {
+            if (renderPath == statsPath && statsFrames > 0) {
+                const ClusteredLights::Stats& lightStats = clusteredLights.GetStats();
+                char title[320];
+                snprintf(title, sizeof(title), "Enhanced Kinetic Sculpture - %s, %d cubes, %d lights: %.2f ms/frame, sculpture CPU %.3f ms/frame, "
+                         "light clusters CPU %.3f ms/frame (%d global lights, %d per cluster at most, %d dropped)",
+                         RENDER_PATH_NAMES[statsPath], (int)instances.size(), (int)pointLights.size(),
+                         1000.0 * (currentFrame - statsStart) / statsFrames, 1000.0 * sculptureCpuTime / statsFrames,
+                         1000.0 * clusterCpuTime / statsFrames, lightStats.globalLights, lightStats.maxClusterLights, lightStats.dropped);
+                glfwSetWindowTitle(window, title);
+                std::cout << title << std::endl;
+            }
+            statsPath = renderPath;
+            statsStart = currentFrame;
+            statsFrames = 0;
+            sculptureCpuTime = 0.0;
+            clusterCpuTime = 0.0;
+        }
+        statsFrames++;
+
         // Enhanced background with gradient effect
         glClearColor(0.02f, 0.02f, 0.06f, 1.0f);
         glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
-        // set lighting uniforms
-        sculptureShader.use();
-        sculptureShader.setVec3("viewPos", camera.Position);
-        sculptureShader.setFloat("material.shininess", 128.0f);
+        // set lighting uniforms on the shader drawing the sculpture
+        Shader& activeShader = renderPath == INSTANCED ? instancedShader : renderPath == GPU_MOTION ? gpuMotionShader : sculptureShader;
+        activeShader.use();
+        activeShader.setVec3("viewPos", camera.Position);
+        activeShader.setFloat("material.shininess", 128.0f);
 
         // Enhanced directional light (moonlight effect)
-        sculptureShader.setVec3("dirLight.direction", -0.3f, -1.0f, -0.4f);
-        sculptureShader.setVec3("dirLight.ambient", 0.05f, 0.05f, 0.08f);
-        sculptureShader.setVec3("dirLight.diffuse", 0.2f, 0.25f, 0.35f);
-        sculptureShader.setVec3("dirLight.specular", 0.3f, 0.35f, 0.5f);
-
-        // Animate multiple point lights with different patterns
-        for (unsigned int i = 0; i < pointLightPositions.size() && i < 4; ++i) {
-            glm::vec3 base = pointLightPositions[i];
-            
-            // Each light has unique movement pattern
-            float timeOffset = (float)i * 1.57f; // π/2 offset
-            float moveRadius = 2.0f + sin(currentFrame * 0.3f + timeOffset) * 1.0f;
-            float moveSpeed = 0.8f + (float)i * 0.2f;
-            
-            glm::vec3 pos = base + glm::vec3(
-                cos(currentFrame * moveSpeed + timeOffset) * moveRadius,
-                sin(currentFrame * 0.7f + timeOffset) * 1.5f,
-                sin(currentFrame * moveSpeed + timeOffset) * moveRadius
-            );
-            
-            std::string idx = "pointLights[" + std::to_string(i) + "]";
-            sculptureShader.setVec3(idx + ".position", pos);
-            sculptureShader.setVec3(idx + ".ambient", lightColors[i] * 0.1f);
-            sculptureShader.setVec3(idx + ".diffuse", lightColors[i] * 0.8f);
-            sculptureShader.setVec3(idx + ".specular", lightColors[i]);
-            sculptureShader.setFloat(idx + ".constant", 1.0f);
-            sculptureShader.setFloat(idx + ".linear", 0.07f);
-            sculptureShader.setFloat(idx + ".quadratic", 0.017f);
-        }
-
-        // Enhanced spotlight (follows camera)
-        sculptureShader.setVec3("spotLight.position", camera.Position);
-        sculptureShader.setVec3("spotLight.direction", camera.Front);
-        sculptureShader.setFloat("spotLight.cutOff", glm::cos(glm::radians(15.0f)));
-        sculptureShader.setFloat("spotLight.outerCutOff", glm::cos(glm::radians(20.0f)));
-        sculptureShader.setVec3("spotLight.ambient", 0.0f, 0.0f, 0.0f);
-        sculptureShader.setVec3("spotLight.diffuse", 1.2f, 1.2f, 1.0f);
-        sculptureShader.setVec3("spotLight.specular", 1.5f, 1.5f, 1.2f);
-        sculptureShader.setFloat("spotLight.constant", 1.0f);
-        sculptureShader.setFloat("spotLight.linear", 0.045f);
-        sculptureShader.setFloat("spotLight.quadratic", 0.0075f);
+        activeShader.setVec3("dirLight.direction", -0.3f, -1.0f, -0.4f);
+        activeShader.setVec3("dirLight.ambient", 0.05f, 0.05f, 0.08f);
+        activeShader.setVec3("dirLight.diffuse", 0.2f, 0.25f, 0.35f);
+        activeShader.setVec3("dirLight.specular", 0.3f, 0.35f, 0.5f);
 
         // projection / view
         glm::mat4 projection = glm::perspective(glm::radians(camera.Zoom), (float)SCR_WIDTH/(float)SCR_HEIGHT, 0.1f, 100.0f);
         glm::mat4 view = camera.GetViewMatrix();
-        sculptureShader.setMat4("projection", projection);
-        sculptureShader.setMat4("view", view);
 
-        sculptureShader.setFloat("time", currentFrame);
+        // Animate multiple point lights with different patterns, then bin them into the
+        // clusters of this frame's frustum
+        double clusterStart = glfwGetTime();
+        for (size_t i = 0; i < pointLights.size(); ++i) {
+            lightPositions[i] = PointLightPosition(pointLights[i], currentFrame);
+        }
+        clusteredLights.Update(pointLights, lightPositions, view, projection, 0.1f, 100.0f);
+        int framebufferWidth, framebufferHeight;
+        glfwGetFramebufferSize(window, &framebufferWidth, &framebufferHeight);
+        clusteredLights.Bind(activeShader, 2, framebufferWidth, framebufferHeight);
+        clusterCpuTime += glfwGetTime() - clusterStart;
+
+        // Enhanced spotlight (follows camera)
+        activeShader.setVec3("spotLight.position", camera.Position);
+        activeShader.setVec3("spotLight.direction", camera.Front);
+        activeShader.setFloat("spotLight.cutOff", glm::cos(glm::radians(15.0f)));
+        activeShader.setFloat("spotLight.outerCutOff", glm::cos(glm::radians(20.0f)));
+        activeShader.setVec3("spotLight.ambient", 0.0f, 0.0f, 0.0f);
+        activeShader.setVec3("spotLight.diffuse", 1.2f, 1.2f, 1.0f);
+        activeShader.setVec3("spotLight.specular", 1.5f, 1.5f, 1.2f);
+        activeShader.setFloat("spotLight.constant", 1.0f);
+        activeShader.setFloat("spotLight.linear", 0.045f);
+        activeShader.setFloat("spotLight.quadratic", 0.0075f);
+
+        activeShader.setMat4("projection", projection);
+        activeShader.setMat4("view", view);
+
+        activeShader.setFloat("time", currentFrame);
 
         // bind textures
         glActiveTexture(GL_TEXTURE0);
@@ -285,87 +401,58 @@ int main()
         glActiveTexture(GL_TEXTURE1);
         glBindTexture(GL_TEXTURE_2D, specularMap);
 
-        // Enhanced instance rendering with complex transformations
-        glBindVertexArray(cubeVAO);
-        for (size_t i = 0; i < instances.size(); ++i) {
-            glm::vec3 pos = instances[i];
-            float phase = (float)i * 0.15f;
-            
-            // Complex kinetic motion using multiple transformation matrices
-            glm::mat4 model = glm::mat4(1.0f);
-            
-            // Primary translation with wave motion
-            float waveOffset = sin(currentFrame * 1.5f + phase) * 0.4f;
-            float spiralOffset = cos(currentFrame * 0.8f + phase * 0.7f) * 0.3f;
-            glm::vec3 animatedPos = pos + glm::vec3(spiralOffset, waveOffset, spiralOffset * 0.5f);
-            model = glm::translate(model, animatedPos);
-            
-            // Rotation around world Y-axis (orbital motion)
-            if (i >= SPIRAL_LEVELS) { // Only rings and patterns orbit
-                model = glm::rotate(model, currentFrame * 0.3f + phase, glm::vec3(0.0f, 1.0f, 0.0f));
+        double sculptureStart = glfwGetTime();
+        if (renderPath == INSTANCED) {
+            // Every cube's model matrix, color and normal matrix streamed into the instance buffer, then one draw call
+            const size_t stride = sizeof(InstanceData) / sizeof(float);
+            sculptureTransforms.Build(currentFrame, &instanceData[0].model[0][0], stride, &instanceData[0].normalMatrix[0][0], stride,
+                                      &instanceData[0].color[0], stride);
+            GLsizeiptr bytes = instanceData.size() * sizeof(InstanceData);
+            glBindBuffer(GL_ARRAY_BUFFER, instanceVBO);
+            // orphan last frame's storage so the upload does not wait for draws still reading it
+            glBufferData(GL_ARRAY_BUFFER, bytes, NULL, GL_STREAM_DRAW);
+            glBufferSubData(GL_ARRAY_BUFFER, 0, bytes, instanceData.data());
+            glBindVertexArray(instancedVAO);
+            glDrawArraysInstanced(GL_TRIANGLES, 0, 36, (GLsizei)instances.size());
+        } else if (renderPath == GPU_MOTION) {
+            // No per-cube work: the vertex shader moves and colors each cube from time
+            glBindVertexArray(gpuMotionVAO);
+            glDrawArraysInstanced(GL_TRIANGLES, 0, 36, (GLsizei)instances.size());
+        } else {
+            // Enhanced instance rendering with complex transformations, one draw call per cube
+            glBindVertexArray(cubeVAO);
+            for (size_t i = 0; i < instances.size(); ++i) {
+                glm::mat4 model = SculptureModel(instances[i], (int)i, currentFrame);
+                glm::mat3 normalMatrix = NormalMatrix(model);
+                glm::vec3 color = SculptureColor(instances[i], (int)i, currentFrame);
+                glUniformMatrix4fv(modelLocation, 1, GL_FALSE, glm::value_ptr(model));
+                glUniformMatrix3fv(normalMatrixLocation, 1, GL_FALSE, glm::value_ptr(normalMatrix));
+                glUniform3fv(overrideColorLocation, 1, glm::value_ptr(color));
+                glDrawArrays(GL_TRIANGLES, 0, 36);
             }
-            
-            // Local rotation for each cube
-            model = glm::rotate(model, currentFrame * 2.0f + phase, glm::vec3(1.0f, 0.3f, 0.7f));
-            model = glm::rotate(model, currentFrame * 1.2f + phase * 0.5f, glm::vec3(0.2f, 1.0f, 0.1f));
-            
-            // Dynamic scaling with breathing effect
-            float breathe = 0.3f + 0.15f * sin(currentFrame * 2.5f + phase * 0.8f);
-            float pulse = 0.05f * sin(currentFrame * 8.0f + phase);
-            model = glm::scale(model, glm::vec3(breathe + pulse));
-            
-            sculptureShader.setMat4("model", model);
-
-            // Enhanced per-instance coloring with smooth transitions
-            float colorPhase = (float)i * 0.08f + currentFrame * 0.5f;
-            glm::vec3 baseColor = glm::vec3(
-                0.4f + 0.4f * sin(colorPhase),
-                0.5f + 0.3f * sin(colorPhase * 1.3f + 1.0f),
-                0.6f + 0.4f * sin(colorPhase * 0.7f + 2.0f)
-            );
-            
-            // Add height-based color variation
-            float heightFactor = (pos.y + 5.0f) / 10.0f;
-            baseColor = mix(baseColor, glm::vec3(0.8f, 0.3f, 0.9f), heightFactor * 0.3f);
-            
-            sculptureShader.setVec3("overrideColor", baseColor);
-
-            glDrawArrays(GL_TRIANGLES, 0, 36);
         }
+        sculptureCpuTime += glfwGetTime() - sculptureStart;
 
-        // Enhanced light cube rendering with colors
-        lightCubeShader.use();
-        lightCubeShader.setMat4("projection", projection);
-        lightCubeShader.setMat4("view", view);
-        glBindVertexArray(lightCubeVAO);
-        
-        for (unsigned int i = 0; i < pointLightPositions.size(); ++i) {
-            glm::vec3 base = pointLightPositions[i];
-            
-            // Same movement as lighting calculation
-            float timeOffset = (float)i * 1.57f;
-            float moveRadius = 2.0f + sin(currentFrame * 0.3f + timeOffset) * 1.0f;
-            float moveSpeed = 0.8f + (float)i * 0.2f;
-            
-            glm::vec3 pos = base + glm::vec3(
-                cos(currentFrame * moveSpeed + timeOffset) * moveRadius,
-                sin(currentFrame * 0.7f + timeOffset) * 1.5f,
-                sin(currentFrame * moveSpeed + timeOffset) * moveRadius
-            );
-            
+        // Enhanced light cube rendering, every light in one draw call
+        for (size_t i = 0; i < pointLights.size(); ++i) {
             glm::mat4 model = glm::mat4(1.0f);
-            model = glm::translate(model, pos);
-            
+            model = glm::translate(model, lightPositions[i]);
+
             // Pulsing scale for light cubes
             float lightPulse = 0.2f + 0.1f * sin(currentFrame * 6.0f + (float)i);
-            model = glm::scale(model, glm::vec3(lightPulse));
-            
+            model = glm::scale(model, glm::vec3(lightPulse * pointLights[i].cubeScale));
+
             // Rotate light cubes
-            model = glm::rotate(model, currentFrame * 3.0f + (float)i, glm::vec3(1.0f, 1.0f, 0.0f));
-            
-            lightCubeShader.setMat4("model", model);
-            glDrawArrays(GL_TRIANGLES, 0, 36);
+            lightModels[i] = glm::rotate(model, currentFrame * 3.0f + (float)i, glm::vec3(1.0f, 1.0f, 0.0f));
         }
+        lightCubeShader.use();
+        lightCubeShader.setMat4("projection", projection);
+        lightCubeShader.setMat4("view", view);
+        glBindBuffer(GL_ARRAY_BUFFER, lightModelVBO);
+        glBufferData(GL_ARRAY_BUFFER, lightModels.size() * sizeof(glm::mat4), NULL, GL_STREAM_DRAW);
+        glBufferSubData(GL_ARRAY_BUFFER, 0, lightModels.size() * sizeof(glm::mat4), lightModels.data());
+        glBindVertexArray(lightCubeVAO);
+        glDrawArraysInstanced(GL_TRIANGLES, 0, 36, (GLsizei)lightModels.size());
 
         glfwSwapBuffers(window);
         glfwPollEvents();
@@ -373,7 +460,13 @@ int main()
 
     glDeleteVertexArrays(1,&cubeVAO);
     glDeleteVertexArrays(1,&lightCubeVAO);
+    glDeleteVertexArrays(1,&instancedVAO);
+    glDeleteVertexArrays(1,&gpuMotionVAO);
     glDeleteBuffers(1,&VBO);
+    glDeleteBuffers(1,&instanceVBO);
+    glDeleteBuffers(1,&paramsVBO);
+    glDeleteBuffers(1,&lightModelVBO);
+    clusteredLights.Release();
 
     glfwTerminate();
     return 0;
@@ -387,6 +480,11 @@ void processInput(GLFWwindow *window)
     if (glfwGetKey(window, GLFW_KEY_S) == GLFW_PRESS) camera.ProcessKeyboard(BACKWARD, deltaTime);
     if (glfwGetKey(window, GLFW_KEY_A) == GLFW_PRESS) camera.ProcessKeyboard(LEFT, deltaTime);
     if (glfwGetKey(window, GLFW_KEY_D) == GLFW_PRESS) camera.ProcessKeyboard(RIGHT, deltaTime);
+
+    // M cycles through the render paths, once per press
+    bool renderPathKey = glfwGetKey(window, GLFW_KEY_M) == GLFW_PRESS;
+    if (renderPathKey && !renderPathKeyDown) renderPath = (RenderPath)((renderPath + 1) % RENDER_PATH_COUNT);
+    renderPathKeyDown = renderPathKey;
 }
 
 void framebuffer_size_callback(GLFWwindow* window, int width, int height) { 
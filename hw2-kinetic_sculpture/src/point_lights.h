@@ -0,0 +1,101 @@
+#ifndef POINT_LIGHTS_H
+#define POINT_LIGHTS_H
+
+#include <glm/glm.hpp>
+#include <glm/gtc/constants.hpp>
+
+#include <cmath>
+#include <vector>
+
+// Point light layout
+const int SCENE_POINT_LIGHTS = 6;  // the colored lights the scene was designed around
+const int MAX_POINT_LIGHTS = 1024;
+
+// A light's reach: where its attenuation falls to this fraction, the shader fades it to zero
+const float LIGHT_CUTOFF = 1.0f / 256.0f;
+
+struct PointLightParams {
+    glm::vec3 base;    // center of its orbit
+    glm::vec3 color;   // ambient 0.1x, diffuse 0.8x, specular 1x
+    float timeOffset;
+    float moveSpeed;
+    float linear;      // attenuation 1 / (1 + linear * d + quadratic * d^2)
+    float quadratic;
+    float radius;      // no light past this distance
+    float cubeScale;   // size of the light cube drawn at its position
+};
+
+// Distance at which 1 / (1 + linear * d + quadratic * d^2) drops to cutoff
+inline float AttenuationRadius(float linear, float quadratic, float cutoff)
+{
+    float c = 1.0f - 1.0f / cutoff;
+    return (-linear + std::sqrt(linear * linear - 4.0f * quadratic * c)) / (2.0f * quadratic);
+}
+
+// The scene's six lights, then (past SCENE_POINT_LIGHTS) small accent lights scattered
+// around the sculpture, golden-angle spaced, each with a short reach of its own
+inline std::vector<PointLightParams> BuildPointLights(int count)
+{
+    const glm::vec3 sceneBases[SCENE_POINT_LIGHTS] = {
+        glm::vec3( 6.0f,  4.0f,  6.0f),   // warm orange light
+        glm::vec3(-6.0f,  2.0f, -6.0f),   // cool blue light
+        glm::vec3( 0.0f, -3.0f,  8.0f),   // purple light
+        glm::vec3( 8.0f,  1.0f, -4.0f),   // green light
+        glm::vec3(-4.0f,  6.0f,  4.0f),   // red light
+        glm::vec3( 2.0f, -2.0f, -8.0f)    // cyan light
+    };
+    const glm::vec3 sceneColors[SCENE_POINT_LIGHTS] = {
+        glm::vec3(1.0f, 0.7f, 0.3f),  // warm orange
+        glm::vec3(0.3f, 0.7f, 1.0f),  // cool blue
+        glm::vec3(0.8f, 0.3f, 1.0f),  // purple
+        glm::vec3(0.3f, 1.0f, 0.5f),  // green
+        glm::vec3(1.0f, 0.3f, 0.3f),  // red
+        glm::vec3(0.3f, 1.0f, 1.0f)   // cyan
+    };
+
+    std::vector<PointLightParams> lights(count);
+    for (int i = 0; i < count; i++) {
+        PointLightParams &light = lights[i];
+        if (i < SCENE_POINT_LIGHTS) {
+            light.base = sceneBases[i];
+            light.color = sceneColors[i];
+            light.timeOffset = (float)i * 1.57f; // π/2 offset
+            light.moveSpeed = 0.8f + (float)i * 0.2f;
+            light.linear = 0.07f;
+            light.quadratic = 0.017f;
+            light.radius = AttenuationRadius(light.linear, light.quadratic, LIGHT_CUTOFF);
+            light.cubeScale = 1.0f;
+            continue;
+        }
+
+        // accent lights fill a shell around the sculpture, radius 3 to 16, 14 units high
+        int k = i - SCENE_POINT_LIGHTS;
+        float spread = (float)k / (float)(MAX_POINT_LIGHTS - SCENE_POINT_LIGHTS);
+        float angle = (float)k * 2.39996f; // golden angle
+        float radius = 3.0f + 13.0f * std::sqrt(std::fmod((float)k * 0.618034f, 1.0f));
+        light.base = glm::vec3(radius * std::cos(angle), -6.0f + 14.0f * std::fmod(spread * 37.0f, 1.0f), radius * std::sin(angle));
+
+        float hue = std::fmod((float)k * 0.618034f + 0.3f, 1.0f) * glm::two_pi<float>();
+        light.color = glm::vec3(0.6f) + 0.4f * glm::vec3(std::cos(hue), std::cos(hue - 2.094f), std::cos(hue + 2.094f));
+        light.timeOffset = angle;
+        light.moveSpeed = 0.4f + 0.6f * std::fmod((float)k * 0.381966f, 1.0f);
+        light.linear = 0.7f;
+        light.quadratic = 1.8f;
+        light.radius = 2.0f;
+        light.cubeScale = 0.4f;
+    }
+    return lights;
+}
+
+// Where light is at time: a wobbling circle about its base
+inline glm::vec3 PointLightPosition(const PointLightParams &light, float time)
+{
+    float moveRadius = 2.0f + sin(time * 0.3f + light.timeOffset) * 1.0f;
+    return light.base + glm::vec3(
+        cos(time * light.moveSpeed + light.timeOffset) * moveRadius,
+        sin(time * 0.7f + light.timeOffset) * 1.5f,
+        sin(time * light.moveSpeed + light.timeOffset) * moveRadius
+    );
+}
+
+#endif
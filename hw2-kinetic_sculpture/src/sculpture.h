@@ -0,0 +1,155 @@
+#ifndef SCULPTURE_H
+#define SCULPTURE_H
+
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <cmath>
+#include <vector>
+
+// Sculpture layout
+const int SPIRAL_LEVELS = 20;     // central spiral tower (these cubes do not orbit)
+const int RINGS = 3;              // orbiting rings
+const int RING_SEGMENTS = 16;
+const int PATTERN_COUNT = 24;     // floating geometric patterns
+const int SCULPTURE_CUBES = SPIRAL_LEVELS + RINGS * RING_SEGMENTS + PATTERN_COUNT;
+const int FIELD_LAYERS = 9;       // layers of the outer field grown for larger instance counts
+const int MAX_INSTANCES = 100000;
+
+// Base positions of the first count cubes: the spiral tower, the rings and the patterns,
+// then (past SCULPTURE_CUBES) an outer field of rings about a unit apart, FIELD_LAYERS high.
+inline std::vector<glm::vec3> BuildSculpture(int count)
+{
+    std::vector<glm::vec3> instances;
+    instances.reserve(count > SCULPTURE_CUBES ? count : SCULPTURE_CUBES);
+
+    // Central spiral tower
+    for (int i = 0; i < SPIRAL_LEVELS; i++) {
+        float height = (float)i * 0.4f - 4.0f;
+        float angle = (float)i * 0.5f;
+        float radius = 2.0f + sin((float)i * 0.3f) * 1.0f;
+
+        float x = radius * cos(angle);
+        float z = radius * sin(angle);
+        instances.push_back(glm::vec3(x, height, z));
+    }
+
+    // Orbiting rings
+    for (int ring = 0; ring < RINGS; ring++) {
+        float ringHeight = (float)ring * 3.0f - 2.0f;
+        float ringRadius = 5.0f + (float)ring * 1.5f;
+
+        for (int i = 0; i < RING_SEGMENTS; i++) {
+            float angle = (float)i / (float)RING_SEGMENTS * glm::two_pi<float>();
+            float x = ringRadius * cos(angle);
+            float z = ringRadius * sin(angle);
+            instances.push_back(glm::vec3(x, ringHeight, z));
+        }
+    }
+
+    // Floating geometric patterns
+    for (int i = 0; i < PATTERN_COUNT; i++) {
+        float angle = (float)i / (float)PATTERN_COUNT * glm::two_pi<float>();
+        float radius = 8.0f;
+        float x = radius * cos(angle);
+        float z = radius * sin(angle);
+        float y = sin(angle * 3.0f) * 2.0f;
+        instances.push_back(glm::vec3(x, y, z));
+    }
+
+    // Outer field, one ring of layers at a time until there are enough cubes
+    for (float radius = 10.0f; (int)instances.size() < count; radius += 1.2f) {
+        int segments = (int)(glm::two_pi<float>() * radius);
+        for (int layer = 0; layer < FIELD_LAYERS && (int)instances.size() < count; layer++) {
+            for (int i = 0; i < segments && (int)instances.size() < count; i++) {
+                float angle = ((float)i + 0.5f * (float)(layer & 1)) / (float)segments * glm::two_pi<float>();
+                float y = ((float)layer - (FIELD_LAYERS - 1) * 0.5f) * 1.5f + sin(angle * 4.0f + radius) * 0.5f;
+                instances.push_back(glm::vec3(radius * cos(angle), y, radius * sin(angle)));
+            }
+        }
+    }
+
+    instances.resize(count);
+    return instances;
+}
+
+// Static per-cube inputs of the GPU-evaluated motion (shaders/sculpture_gpu.vs): everything
+// SculptureModel and SculptureColor take besides the time
+struct SculptureParams {
+    glm::vec3 position;  // base position
+    float phase;         // cube index * 0.15
+    float orbit;         // 1 for cubes that orbit the world Y-axis, 0 for the spiral tower
+    float colorPhase;    // cube index * 0.08
+};
+
+inline std::vector<SculptureParams> BuildSculptureParams(const std::vector<glm::vec3> &instances)
+{
+    std::vector<SculptureParams> params(instances.size());
+    for (size_t i = 0; i < instances.size(); ++i) {
+        params[i].position = instances[i];
+        params[i].phase = (float)i * 0.15f;
+        params[i].orbit = i >= SPIRAL_LEVELS ? 1.0f : 0.0f;
+        params[i].colorPhase = (float)i * 0.08f;
+    }
+    return params;
+}
+
+// Complex kinetic motion of cube i using multiple transformation matrices
+inline glm::mat4 SculptureModel(const glm::vec3 &pos, int i, float time)
+{
+    float phase = (float)i * 0.15f;
+    glm::mat4 model = glm::mat4(1.0f);
+
+    // Primary translation with wave motion
+    float waveOffset = sin(time * 1.5f + phase) * 0.4f;
+    float spiralOffset = cos(time * 0.8f + phase * 0.7f) * 0.3f;
+    glm::vec3 animatedPos = pos + glm::vec3(spiralOffset, waveOffset, spiralOffset * 0.5f);
+    model = glm::translate(model, animatedPos);
+
+    // Rotation around world Y-axis (orbital motion)
+    if (i >= SPIRAL_LEVELS) { // Only rings and patterns orbit
+        model = glm::rotate(model, time * 0.3f + phase, glm::vec3(0.0f, 1.0f, 0.0f));
+    }
+
+    // Local rotation for each cube
+    model = glm::rotate(model, time * 2.0f + phase, glm::vec3(1.0f, 0.3f, 0.7f));
+    model = glm::rotate(model, time * 1.2f + phase * 0.5f, glm::vec3(0.2f, 1.0f, 0.1f));
+
+    // Dynamic scaling with breathing effect
+    float breathe = 0.3f + 0.15f * sin(time * 2.5f + phase * 0.8f);
+    float pulse = 0.05f * sin(time * 8.0f + phase);
+    return glm::scale(model, glm::vec3(breathe + pulse));
+}
+
+// Normal matrix of model. A rotation times a uniform scale (every cube here) takes the fast
+// path: its upper 3x3 is the inverse transpose up to that scale, which the fragment shader
+// normalizes away. Anything else pays for the inverse.
+inline glm::mat3 NormalMatrix(const glm::mat4 &model)
+{
+    glm::mat3 upper = glm::mat3(model);
+    float xx = glm::dot(upper[0], upper[0]);
+    float tolerance = xx * 1e-4f;
+    if (std::fabs(glm::dot(upper[1], upper[1]) - xx) <= tolerance && std::fabs(glm::dot(upper[2], upper[2]) - xx) <= tolerance &&
+        std::fabs(glm::dot(upper[0], upper[1])) <= tolerance && std::fabs(glm::dot(upper[0], upper[2])) <= tolerance &&
+        std::fabs(glm::dot(upper[1], upper[2])) <= tolerance) {
+        return upper;
+    }
+    return glm::transpose(glm::inverse(upper));
+}
+
+// Enhanced per-instance coloring with smooth transitions
+inline glm::vec3 SculptureColor(const glm::vec3 &pos, int i, float time)
+{
+    float colorPhase = (float)i * 0.08f + time * 0.5f;
+    glm::vec3 baseColor = glm::vec3(
+        0.4f + 0.4f * sin(colorPhase),
+        0.5f + 0.3f * sin(colorPhase * 1.3f + 1.0f),
+        0.6f + 0.4f * sin(colorPhase * 0.7f + 2.0f)
+    );
+
+    // Add height-based color variation
+    float heightFactor = (pos.y + 5.0f) / 10.0f;
+    return mix(baseColor, glm::vec3(0.8f, 0.3f, 0.9f), heightFactor * 0.3f);
+}
+
+#endif
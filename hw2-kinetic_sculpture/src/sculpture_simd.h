@@ -0,0 +1,248 @@
+#ifndef SCULPTURE_SIMD_H
+#define SCULPTURE_SIMD_H
+
+#include <glm/glm.hpp>
+
+#include "sculpture.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <vector>
+
+#if defined(__AVX__)
+#define SCULPTURE_AVX 1
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define SCULPTURE_SSE 1
+#include <emmintrin.h>
+#endif
+
+// One float per cube: the transform kernel moves LaneWidth cubes at once, each cube
+// in its own SIMD lane.
+namespace sculpture_lanes
+{
+#if defined(SCULPTURE_AVX)
+    const int LaneWidth = 8;
+    typedef __m256 Lane;
+    inline Lane Set1(float v) { return _mm256_set1_ps(v); }
+    inline Lane Load(const float *p) { return _mm256_loadu_ps(p); }
+    inline void Store(float *p, Lane v) { _mm256_storeu_ps(p, v); }
+    inline Lane Add(Lane a, Lane b) { return _mm256_add_ps(a, b); }
+    inline Lane Sub(Lane a, Lane b) { return _mm256_sub_ps(a, b); }
+    inline Lane Mul(Lane a, Lane b) { return _mm256_mul_ps(a, b); }
+    inline Lane Round(Lane a) { return _mm256_round_ps(a, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC); }
+#elif defined(SCULPTURE_SSE)
+    const int LaneWidth = 4;
+    typedef __m128 Lane;
+    inline Lane Set1(float v) { return _mm_set1_ps(v); }
+    inline Lane Load(const float *p) { return _mm_loadu_ps(p); }
+    inline void Store(float *p, Lane v) { _mm_storeu_ps(p, v); }
+    inline Lane Add(Lane a, Lane b) { return _mm_add_ps(a, b); }
+    inline Lane Sub(Lane a, Lane b) { return _mm_sub_ps(a, b); }
+    inline Lane Mul(Lane a, Lane b) { return _mm_mul_ps(a, b); }
+    inline Lane Round(Lane a) { return _mm_cvtepi32_ps(_mm_cvtps_epi32(a)); }  // |a| < 2^31
+#else
+    const int LaneWidth = 1;
+    typedef float Lane;
+    inline Lane Set1(float v) { return v; }
+    inline Lane Load(const float *p) { return *p; }
+    inline void Store(float *p, Lane v) { *p = v; }
+    inline Lane Add(Lane a, Lane b) { return a + b; }
+    inline Lane Sub(Lane a, Lane b) { return a - b; }
+    inline Lane Mul(Lane a, Lane b) { return a * b; }
+    inline Lane Round(Lane a) { return std::nearbyint(a); }
+#endif
+
+    // sin and cos of x, within 3.3e-7 of libm's for |x| up to 2e4 (the phases of 100k cubes).
+    // x = j * pi/2 + r with |r| <= pi/4 (pi/2 split in three so j * part is exact), then
+    // the cephes sinf/cosf polynomials on r. The quadrant q = j mod 4 swaps and negates
+    // them; it is worked out in floats since AVX has no 256-bit integer ops.
+    inline void SinCos(Lane x, Lane &s, Lane &c)
+    {
+        Lane j = Round(Mul(x, Set1(0.63661977236f)));
+        Lane r = Sub(x, Mul(j, Set1(1.5703125f)));
+        r = Sub(r, Mul(j, Set1(4.837512969970703125e-4f)));
+        r = Sub(r, Mul(j, Set1(7.54978995489188216e-8f)));
+        Lane r2 = Mul(r, r);
+
+        Lane sinR = Add(Mul(r2, Set1(-1.9515295891e-4f)), Set1(8.3321608736e-3f));
+        sinR = Add(Mul(sinR, r2), Set1(-1.6666654611e-1f));
+        sinR = Add(Mul(Mul(sinR, r2), r), r);
+        Lane cosR = Add(Mul(r2, Set1(2.443315711809948e-5f)), Set1(-1.388731625493765e-3f));
+        cosR = Add(Mul(cosR, r2), Set1(4.166664568298827e-2f));
+        cosR = Add(Sub(Mul(Mul(cosR, r2), r2), Mul(r2, Set1(0.5f))), Set1(1.0f));
+
+        // q in 0..3 (the 0.375 keeps the rounding off ties); high = q >= 2, odd = q & 1
+        Lane q = Sub(j, Mul(Round(Sub(Mul(j, Set1(0.25f)), Set1(0.375f))), Set1(4.0f)));
+        Lane high = Round(Sub(Mul(q, Set1(0.5f)), Set1(0.25f)));
+        Lane odd = Sub(q, Mul(high, Set1(2.0f)));
+        // sin is negative in quadrants 2 and 3, cos in 1 and 2 (odd xor high)
+        Lane sinSign = Sub(Set1(1.0f), Mul(high, Set1(2.0f)));
+        Lane cosFlip = Sub(Add(odd, high), Mul(Mul(odd, high), Set1(2.0f)));
+        Lane cosSign = Sub(Set1(1.0f), Mul(cosFlip, Set1(2.0f)));
+        Lane swap = Mul(odd, Sub(cosR, sinR));
+        s = Mul(Add(sinR, swap), sinSign);
+        c = Mul(Sub(cosR, swap), cosSign);
+    }
+
+    // rotation of the angle with sine s and cosine c around unit axis n, as glm::rotate;
+    // r[column][row]
+    inline void AxisRotation(const glm::vec3 &n, Lane s, Lane c, Lane r[3][3])
+    {
+        Lane k = Sub(Set1(1.0f), c);
+        for (int column = 0; column < 3; column++) {
+            for (int row = 0; row < 3; row++) {
+                Lane v = Mul(k, Set1(n[row] * n[column]));
+                if (row == column)
+                    v = Add(v, c);
+                else  // cross product matrix of n: +n[z] at (row 1, column 0), and so on
+                    v = Add(v, Mul(s, Set1((column + 1) % 3 == row ? n[3 - row - column] : -n[3 - row - column])));
+                r[column][row] = v;
+            }
+        }
+    }
+}
+
+// The sculpture's cubes as a structure of arrays, and a SIMD version of SculptureModel,
+// SculptureColor and the model's normal matrix over them.
+//
+// Every cube's transform is translate(animated position) * [orbit] * two local rotations
+// * uniform scale. The kernel evaluates it for LaneWidth cubes per pass with SinCos in
+// place of the libm calls. The orbit is applied to every lane, as the identity for the
+// spiral tower, so there are no branches. Rotation * uniform scale needs no inverse:
+// its normal matrix is the upper 3x3 itself, as NormalMatrix returns it.
+class SculptureTransforms
+{
+public:
+    void Assign(const std::vector<glm::vec3> &instances)
+    {
+        count = (int)instances.size();
+        // padded to whole lane groups; the padding is computed but never written out
+        const size_t padded = (size_t)(count + sculpture_lanes::LaneWidth - 1) / sculpture_lanes::LaneWidth * sculpture_lanes::LaneWidth;
+        for (std::vector<float> *v : {&x, &y, &z, &phase, &orbit, &colorPhase, &heightMix})
+            v->assign(padded, 0.0f);
+        for (int i = 0; i < count; i++) {
+            x[i] = instances[i].x;
+            y[i] = instances[i].y;
+            z[i] = instances[i].z;
+            phase[i] = (float)i * 0.15f;
+            orbit[i] = i >= SPIRAL_LEVELS ? 1.0f : 0.0f;
+            colorPhase[i] = (float)i * 0.08f;
+            heightMix[i] = (instances[i].y + 5.0f) / 10.0f * 0.3f;
+        }
+    }
+
+    int Count() const { return count; }
+
+    // Each cube's model matrix (16 floats, column major), normal matrix (9 floats) and
+    // color (3 floats) at time. Cube i's model starts at models + i * modelStride floats,
+    // and so on; a null pointer skips that output.
+    void Build(float time, float *models, size_t modelStride, float *normals, size_t normalStride, float *colors, size_t colorStride) const
+    {
+        using namespace sculpture_lanes;
+        const glm::vec3 localAxis1 = glm::normalize(glm::vec3(1.0f, 0.3f, 0.7f));
+        const glm::vec3 localAxis2 = glm::normalize(glm::vec3(0.2f, 1.0f, 0.1f));
+
+        // lane outputs, then copied out cube by cube: rotation * scale (also the normal
+        // matrix), translation, color
+        float out[15][LaneWidth];
+        for (int first = 0; first < count; first += LaneWidth) {
+            Lane p = Load(&phase[first]);
+            Lane s, c, unused;
+
+            // Primary translation with wave motion
+            SinCos(Add(Set1(time * 1.5f), p), s, unused);
+            Lane waveOffset = Mul(s, Set1(0.4f));
+            SinCos(Add(Set1(time * 0.8f), Mul(p, Set1(0.7f))), unused, c);
+            Lane spiralOffset = Mul(c, Set1(0.3f));
+            Store(out[9], Add(Load(&x[first]), spiralOffset));
+            Store(out[10], Add(Load(&y[first]), waveOffset));
+            Store(out[11], Add(Load(&z[first]), Mul(spiralOffset, Set1(0.5f))));
+
+            // Local rotations, combined
+            Lane local1[3][3], local2[3][3], rotation[3][3];
+            SinCos(Add(Set1(time * 2.0f), p), s, c);
+            AxisRotation(localAxis1, s, c, local1);
+            SinCos(Add(Set1(time * 1.2f), Mul(p, Set1(0.5f))), s, c);
+            AxisRotation(localAxis2, s, c, local2);
+            for (int column = 0; column < 3; column++)
+                for (int row = 0; row < 3; row++)
+                    rotation[column][row] = Add(Add(Mul(local1[0][row], local2[column][0]), Mul(local1[1][row], local2[column][1])),
+                                                Mul(local1[2][row], local2[column][2]));
+
+            // Orbit around world Y in front of them; the identity where orbit is 0
+            SinCos(Add(Set1(time * 0.3f), p), s, c);
+            Lane o = Load(&orbit[first]);
+            Lane orbitCos = Add(Set1(1.0f), Mul(o, Sub(c, Set1(1.0f))));
+            Lane orbitSin = Mul(o, s);
+            for (int column = 0; column < 3; column++) {
+                Lane rx = rotation[column][0], rz = rotation[column][2];
+                rotation[column][0] = Add(Mul(orbitCos, rx), Mul(orbitSin, rz));
+                rotation[column][2] = Sub(Mul(orbitCos, rz), Mul(orbitSin, rx));
+            }
+
+            // Dynamic scaling with breathing effect
+            SinCos(Add(Set1(time * 2.5f), Mul(p, Set1(0.8f))), s, unused);
+            Lane breathe = Add(Set1(0.3f), Mul(Set1(0.15f), s));
+            SinCos(Add(Set1(time * 8.0f), p), s, unused);
+            Lane scale = Add(breathe, Mul(Set1(0.05f), s));
+            for (int column = 0; column < 3; column++)
+                for (int row = 0; row < 3; row++)
+                    Store(out[column * 3 + row], Mul(rotation[column][row], scale));
+
+            if (colors) {
+                Lane cp = Add(Load(&colorPhase[first]), Set1(time * 0.5f));
+                Lane base[3];
+                SinCos(cp, s, unused);
+                base[0] = Add(Set1(0.4f), Mul(Set1(0.4f), s));
+                SinCos(Add(Mul(cp, Set1(1.3f)), Set1(1.0f)), s, unused);
+                base[1] = Add(Set1(0.5f), Mul(Set1(0.3f), s));
+                SinCos(Add(Mul(cp, Set1(0.7f)), Set1(2.0f)), s, unused);
+                base[2] = Add(Set1(0.6f), Mul(Set1(0.4f), s));
+                // mix towards (0.8, 0.3, 0.9) by the height
+                Lane h = Load(&heightMix[first]);
+                const float target[3] = {0.8f, 0.3f, 0.9f};
+                for (int k = 0; k < 3; k++)
+                    Store(out[12 + k], Add(Mul(base[k], Sub(Set1(1.0f), h)), Mul(Set1(target[k]), h)));
+            }
+
+            const int lanes = std::min(LaneWidth, count - first);
+            for (int l = 0; l < lanes; l++) {
+                const size_t cube = (size_t)(first + l);
+                if (models) {
+                    float *m = models + cube * modelStride;
+                    for (int column = 0; column < 3; column++) {
+                        m[column * 4 + 0] = out[column * 3 + 0][l];
+                        m[column * 4 + 1] = out[column * 3 + 1][l];
+                        m[column * 4 + 2] = out[column * 3 + 2][l];
+                        m[column * 4 + 3] = 0.0f;
+                    }
+                    m[12] = out[9][l];
+                    m[13] = out[10][l];
+                    m[14] = out[11][l];
+                    m[15] = 1.0f;
+                }
+                if (normals) {
+                    for (int k = 0; k < 9; k++)
+                        normals[cube * normalStride + k] = out[k][l];
+                }
+                if (colors) {
+                    for (int k = 0; k < 3; k++)
+                        colors[cube * colorStride + k] = out[12 + k][l];
+                }
+            }
+        }
+    }
+
+private:
+    int count = 0;
+    // per cube, padded to whole lane groups
+    std::vector<float> x, y, z;       // base position
+    std::vector<float> phase;         // index * 0.15
+    std::vector<float> orbit;         // 1 if the cube orbits the world Y-axis
+    std::vector<float> colorPhase;    // index * 0.08
+    std::vector<float> heightMix;     // how far the color mixes towards purple
+};
+
+#endif
@@ -0,0 +1,21 @@
+#pragma once
+#include <string>
+#include <vector>
+
+class Game;
+
+// Offline measurements, selected from the command line in main.cpp.
+class Benchmark {
+public:
+    // cold (Assimp import + bake) vs warm (mapped MeshCache) Model construction; needs a current GL context
+    static void ModelLoad(const std::vector<std::string>& modelPaths, int runs);
+    // Model::ConvertScene serial vs parallel on a synthetic aiScene; CPU only
+    static void MeshConversion(int meshCount, int runs);
+    // CollisionWorld overlap/sweep query throughput against 10k, 100k and 1M static boxes; CPU only
+    static void CollisionQueries(int queries);
+    // BoundsCuller SSE vs scalar (plus per-instance bounds transform) over count random instances; CPU only
+    static void FrustumCulling(int count, int runs);
+    // runs frames of scripted input at a fixed dt through Update/Render/RenderUi on the current
+    // (usually headless) context and writes frame-time percentiles, phase times and draw calls as JSON
+    static bool FrameTimes(Game& game, int frames, int width, int height, const std::string& jsonPath);
+};
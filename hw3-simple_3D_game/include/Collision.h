@@ -10,4 +10,7 @@ class Collision {
 public:
     static AABB FromPositionSize(const glm::vec3& pos, const glm::vec3& halfSize);
     static bool TestAABB(const AABB& a, const AABB& b);
+    // box moving by delta against a static target: time of first contact in [0,1] and the
+    // contact normal (zero if they already overlap at t = 0)
+    static bool SweepAABB(const AABB& moving, const glm::vec3& delta, const AABB& target, float& time, glm::vec3& normal);
 };
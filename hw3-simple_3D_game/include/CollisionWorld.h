@@ -0,0 +1,80 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <unordered_map>
+#include <vector>
+#include <glm/glm.hpp>
+#include "Collision.h"
+
+// Broadphase over Collision's AABBs. Boxes are bucketed into a uniform hash grid
+// so overlap and sweep queries only test the boxes in the cells they touch.
+// Boxes spanning more than MaxCellsPerBox cells go to an "oversized" list that
+// every query checks, which keeps huge static boxes from flooding the grid.
+class CollisionWorld {
+public:
+    typedef uint32_t Handle;
+    static const Handle InvalidHandle = 0xffffffffu;
+    static const int MaxCellsPerBox = 64;
+
+    struct SweepHit {
+        Handle handle = InvalidHandle;
+        float time = 1.0f;                  // fraction of delta travelled before contact
+        glm::vec3 normal = glm::vec3(0.0f); // zero if already overlapping at the start
+    };
+
+    explicit CollisionWorld(float cellSize = 2.0f);
+
+    // layer is a bit mask tested against the queries' layerMask; userData is returned untouched
+    Handle Insert(const AABB& box, uint32_t layer = 1, uint32_t userData = 0);
+    void Remove(Handle handle);
+    void Move(Handle handle, const AABB& box);
+
+    const AABB& GetBox(Handle handle) const { return proxies[handle].box; }
+    uint32_t GetUserData(Handle handle) const { return proxies[handle].userData; }
+    size_t Size() const { return proxies.size() - freeList.size(); }
+
+    // appends every live box overlapping box whose layer intersects layerMask
+    void QueryOverlap(const AABB& box, uint32_t layerMask, std::vector<Handle>& out) const;
+    // earliest contact of box moving by delta; false if the whole move is clear.
+    // skipOverlaps ignores boxes it already overlaps, so they don't hide the rest
+    bool Sweep(const AABB& box, const glm::vec3& delta, uint32_t layerMask, SweepHit& hit, bool skipOverlaps = false) const;
+
+    // moves box by delta, stopping at contacts and sliding along them; returns the applied move
+    glm::vec3 SlideMove(const AABB& box, const glm::vec3& delta, uint32_t layerMask, int maxIterations = 3) const;
+
+private:
+    struct CellRange {
+        int min[3];
+        int max[3];
+    };
+
+    struct Proxy {
+        AABB box;
+        uint32_t layer = 0;
+        uint32_t userData = 0;
+        CellRange cells;
+        bool oversized = false;
+        bool alive = false;
+    };
+
+    CellRange RangeFor(const AABB& box) const;
+    static long long CellCount(const CellRange& range);
+    static uint64_t CellKey(int x, int y, int z);
+
+    void Link(Handle handle);
+    void Unlink(Handle handle);
+
+    // calls fn(handle) once per live candidate in range (dedup via visit stamps)
+    template <typename Fn>
+    void ForEachCandidate(const CellRange& range, uint32_t layerMask, Fn fn) const;
+
+    float cellSize;
+    float invCellSize;
+    std::unordered_map<uint64_t, std::vector<Handle>> cells;
+    std::vector<Handle> oversized;
+    std::vector<Proxy> proxies;
+    std::vector<Handle> freeList;
+
+    mutable std::vector<uint32_t> visited;
+    mutable uint32_t visitStamp = 0;
+};
@@ -0,0 +1,53 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+#include <glm/glm.hpp>
+#include "Mesh.h"
+
+// six normalised planes (xyz = inward normal, w = distance) of a view-projection matrix
+struct Frustum {
+    glm::vec4 planes[6];
+
+    static Frustum FromViewProjection(const glm::mat4& viewProjection);
+};
+
+// World-space bounding spheres and axis-aligned boxes, sharing a center, kept as
+// structure-of-arrays so Cull() can test four instances per plane with one SSE
+// compare. An instance is outside if either its sphere or its box is entirely
+// behind a plane; for a plane that amounts to testing the smaller of the sphere's
+// radius and the box's extent along the plane normal. Fill with Add() each frame,
+// cull once, then look visibility up by the index Add() returned.
+class BoundsCuller {
+public:
+    struct Stats {
+        unsigned int tested = 0;
+        unsigned int visible = 0;
+        unsigned int culled = 0;
+        unsigned int boxCulled = 0;  // part of culled: the sphere alone would have kept them
+    };
+
+    void Clear();
+    void Reserve(size_t count);
+    // a sphere only (its box is the cube around it)
+    uint32_t Add(const glm::vec3& center, float radius);
+    // local-space bounds placed by transform: the radius grows with the largest axis
+    // scale, the box is the world AABB of the transformed local box
+    uint32_t Add(const glm::mat4& transform, const MeshBounds& bounds);
+
+    // SSE path (scalar on targets without it); both fill the same visibility flags
+    void Cull(const Frustum& frustum);
+    void CullScalar(const Frustum& frustum);
+
+    bool IsVisible(uint32_t index) const { return visible[index] != 0; }
+    size_t Size() const { return x.size(); }
+    const Stats& GetStats() const { return stats; }
+
+private:
+    size_t CullRange(const Frustum& frustum, size_t begin, size_t end, unsigned int& boxCulled);
+
+    std::vector<float> x, y, z, r;
+    std::vector<float> ex, ey, ez; // box half extents
+    std::vector<uint8_t> visible;
+    Stats stats;
+};
@@ -0,0 +1,25 @@
+#pragma once
+#include <glm/glm.hpp>
+
+// CPU mirror of the std140 FrameData block shared by model.vert, model.frag and
+// skybox.vert. vec3 values are padded to vec4 as std140 requires.
+struct FrameData {
+    glm::mat4 projection;
+    glm::mat4 view;
+    glm::vec4 viewPos;
+    glm::vec4 lightPos;
+    glm::vec4 lightColor;
+};
+
+// One uniform buffer holding the per-frame values, uploaded once per frame and
+// read by every program whose FrameData block is bound to BindingPoint.
+class FrameUniforms {
+public:
+    static const unsigned int BindingPoint = 0;
+
+    void Init();
+    void Update(const FrameData& data);
+
+private:
+    unsigned int UBO = 0;
+};
@@ -0,0 +1,122 @@
+#pragma once
+#include <functional>
+#include <string>
+#include <vector>
+#include <glm/glm.hpp>
+#include "Camera.h"
+#include "CollisionWorld.h"
+#include "Culling.h"
+#include "FrameUniforms.h"
+#include "Model.h"
+#include "Player.h"
+#include "RenderQueue.h"
+#include "Shader.h"
+
+// one frame of player input, from the keyboard or a benchmark script
+struct GameInput {
+    bool forward = false;
+    bool back = false;
+    bool left = false;
+    bool right = false;
+    bool spin = false;
+};
+
+// Game state plus the per-frame update and render passes, independent of how
+// the GL context and input were created (GLFW window or headless benchmark).
+//
+// Game logic (player movement, bone pickup, obstacle blocking) runs in fixed
+// TickSeconds steps. Update() turns elapsed wall time into whole ticks and
+// Render() draws the state interpolated between the last two ticks, so the
+// simulation is independent of the frame rate.
+class Game {
+public:
+    // CPU wall time of each phase of the last frame, in milliseconds;
+    // update and collision are summed over every tick the frame ran
+    struct PhaseTimes {
+        double update = 0.0;
+        double collision = 0.0;
+        double draw = 0.0;
+        double cull = 0.0;  // part of draw
+        double ui = 0.0;
+        int ticks = 0;
+    };
+
+    static const int BoneCount = 10;
+    static constexpr float TickSeconds = 1.0f / 60.0f;
+    // wall time beyond this per frame is dropped rather than simulated (stalls, debugger breaks)
+    static constexpr float MaxFrameSeconds = 0.25f;
+
+    Game();
+    // loads shaders, models and the skybox; resolve maps a repo-relative path to one that exists
+    void Init(const std::function<std::string(const std::string&)>& resolve);
+
+    // runs as many fixed ticks as frameDt (plus leftover time) covers; no rendering work
+    void Update(float frameDt, const GameInput& input);
+    // exactly one fixed simulation step
+    void Tick(const GameInput& input);
+    void Render(int width, int height);
+    // Score and Stats windows; the platform backend's NewFrame must already have run
+    void RenderUi(int width);
+
+    // every draw call of the last frame: the render queue's, the skybox and ImGui's
+    unsigned int DrawCalls() const { return renderQueue.GetStats().drawCalls + SkyboxDrawCalls + uiDrawCalls; }
+
+    int CollectedCount() const;
+    const PhaseTimes& GetPhaseTimes() const { return phaseTimes; }
+    const RenderQueue::Stats& GetRenderStats() const { return renderQueue.GetStats(); }
+    const BoundsCuller::Stats& GetCullStats() const { return culler.GetStats(); }
+
+private:
+    // the part of the simulation Render() interpolates
+    struct SimState {
+        glm::vec3 position;
+        float yaw;
+        float spinAngle;
+        float time;
+    };
+
+    void MovePlayer(float dt, const GameInput& input);
+    void ResolveCollisions(const glm::vec3& prevPos);
+    SimState Snapshot() const;
+    static SimState Interpolate(const SimState& a, const SimState& b, float alpha);
+    void FollowCamera(const SimState& state);
+
+    Shader modelShader;
+    Shader instancedShader;
+    Shader skyShader;
+    FrameUniforms frameUniforms;
+    RenderQueue renderQueue;
+
+    Player player;
+    Model sceneModel;
+    Model itemModel;
+    Camera camera;
+
+    static const unsigned int SkyboxDrawCalls = 1;
+    unsigned int uiDrawCalls = 0;  // ImGui draw commands of the last RenderUi
+
+    unsigned int skyVAO = 0;
+    unsigned int skyVBO = 0;
+    unsigned int cubemapTex = 0;
+
+    std::vector<glm::vec3> bonePositions;
+    std::vector<bool> bonesCollected;
+    std::vector<glm::vec3> trashPositions;
+    std::vector<InstanceData> trashInstances;
+    std::vector<InstanceData> boneInstances;
+    std::vector<InstanceData> visibleInstances; // scratch for the culled instance lists
+    BoundsCuller culler;
+
+    // bones and trash cans live in the broadphase; collected bones are removed from it
+    CollisionWorld collisionWorld;
+    std::vector<CollisionWorld::Handle> contacts;
+
+    float time = 0.0f;         // simulated seconds, drives the bone animation
+    float spinAngle = 0.0f;    // dog spin while R is held
+    float accumulator = 0.0f;  // wall time not yet simulated, always < TickSeconds after Update
+    float alpha = 0.0f;        // accumulator / TickSeconds, blend factor for Render
+    SimState previous;
+    SimState current;
+    PhaseTimes phaseTimes;
+    Shader::FrameStats lastShaderStats;
+};
@@ -0,0 +1,24 @@
+#pragma once
+
+// OpenGL 3.3 core context with no window, for benchmarks on machines without a
+// display or GPU (e.g. Mesa llvmpipe). Uses an EGL pbuffer when the build found
+// EGL (SIMPLE3D_HAS_EGL); otherwise Create() fails and the caller falls back to
+// a hidden GLFW window.
+class HeadlessContext {
+public:
+    HeadlessContext() {}
+    ~HeadlessContext();
+    HeadlessContext(const HeadlessContext&) = delete;
+    HeadlessContext& operator=(const HeadlessContext&) = delete;
+
+    // creates the context and makes it current on this thread
+    bool Create(int width, int height);
+    void Destroy();
+    // for gladLoadGLLoader
+    static void* GetProcAddress(const char* name);
+
+private:
+    void* display = nullptr;
+    void* surface = nullptr;
+    void* context = nullptr;
+};
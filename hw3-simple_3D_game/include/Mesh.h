@@ -11,6 +11,38 @@ struct Vertex {
     glm::vec2 TexCoords;
 };
 
+// local-space bounds of one mesh (or a whole model), computed once at load
+struct MeshBounds {
+    glm::vec3 min = glm::vec3(0.0f);
+    glm::vec3 max = glm::vec3(0.0f);
+    glm::vec3 center = glm::vec3(0.0f); // sphere center, the AABB center
+    float radius = 0.0f;                // farthest vertex from center
+
+    static MeshBounds FromVertices(const Vertex* vertices, size_t count);
+    // smallest bounds (AABB union, sphere around both spheres) enclosing a and b
+    static MeshBounds Merge(const MeshBounds& a, const MeshBounds& b);
+};
+
+// material texture reference as named in the source model (resolved to a GL id at load)
+struct TextureRef {
+    std::string type;
+    std::string path;
+};
+
+// CPU-side output of processMesh, before any GL objects exist
+struct MeshData {
+    std::vector<Vertex> vertices;
+    std::vector<unsigned int> indices;
+    std::vector<TextureRef> textures;
+    MeshBounds bounds;
+};
+
+// per-instance attributes read through Mesh::InstanceVAO (locations 3-6 = model, 7 = color)
+struct InstanceData {
+    glm::mat4 model;
+    glm::vec4 color; // rgb = object color, a = 1 to use it instead of the texture
+};
+
 class Mesh {
 public:
     struct Texture {
@@ -21,11 +53,25 @@ public:
     std::vector<Vertex> vertices;
     std::vector<unsigned int> indices;
     std::vector<Texture> textures;
+    unsigned int indexCount = 0;
+    MeshBounds bounds;
 
-    Mesh(std::vector<Vertex> vertices, std::vector<unsigned int> indices, std::vector<Texture> textures = {});
+    // bounds are computed from the vertices unless the caller already has them
+    Mesh(std::vector<Vertex> vertices, std::vector<unsigned int> indices, std::vector<Texture> textures = {}, const MeshBounds* bounds = nullptr);
+    // uploads straight from caller-owned memory (e.g. a mapped MeshCache); no CPU copy is kept
+    Mesh(const Vertex* vertexData, size_t vertexCount, const unsigned int* indexData, size_t indexCount, std::vector<Texture> textures = {}, const MeshBounds* bounds = nullptr);
+    // immediate draw; leaves the VAO and textures bound (RenderQueue is the batched path)
     void Draw();
 
+    unsigned int GetVAO() const { return VAO; }
+    // second VAO over the same VBO/EBO plus per-instance InstanceData attributes from instanceVBO, built on first use
+    unsigned int InstanceVAO(unsigned int instanceVBO);
+    // groups meshes that bind the same textures: the first texture's GL id (TextureCache shares ids), 0 if untextured
+    unsigned int GetMaterialId() const { return textures.empty() ? 0 : textures[0].id; }
+
 private:
     unsigned int VAO, VBO, EBO;
-    void setupMesh();
+    unsigned int instanceVAO = 0;
+    unsigned int instanceSource = 0;
+    void setupMesh(const Vertex* vertexData, size_t vertexCount, const unsigned int* indexData, size_t indexCount);
 };
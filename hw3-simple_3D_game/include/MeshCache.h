@@ -0,0 +1,57 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <string>
+#include <vector>
+#include "Mesh.h"
+
+// Baked binary copy of the meshes processMesh produces for one model file.
+// Written next to the source model on first import and memory-mapped on later
+// runs so vertex/index data goes straight to glBufferData without Assimp.
+//
+// File layout (native endianness, every block 4-byte aligned):
+//   FileHeader
+//   per mesh: MeshHeader (counts + MeshBounds), Vertex[vertexCount], uint32[indexCount],
+//             textureCount x { uint32 typeLen, uint32 pathLen, type, path, pad }
+class MeshCache {
+public:
+    // bump whenever the layout or processMesh output changes
+    static const uint32_t Version = 2;
+
+    struct CachedMesh {
+        const Vertex* vertices;
+        unsigned int vertexCount;
+        const unsigned int* indices;
+        unsigned int indexCount;
+        std::vector<TextureRef> textures;
+        MeshBounds bounds;
+    };
+
+    MeshCache() {}
+    ~MeshCache();
+    MeshCache(const MeshCache&) = delete;
+    MeshCache& operator=(const MeshCache&) = delete;
+
+    static std::string PathFor(const std::string& sourcePath);
+    // hash of the source file contents, the import flags and the format version; 0 if the source can't be read
+    static uint64_t ComputeKey(const std::string& sourcePath, unsigned int importFlags);
+    static bool Write(const std::string& cachePath, uint64_t key, const std::vector<MeshData>& meshes);
+
+    // maps the cache file and checks it against key; Meshes() points into the mapping until Close()
+    bool Open(const std::string& cachePath, uint64_t key);
+    void Close();
+    const std::vector<CachedMesh>& Meshes() const { return meshes; }
+
+private:
+    struct MappedFile {
+        const unsigned char* data = nullptr;
+        size_t size = 0;
+        void* file = nullptr;     // Windows only
+        void* mapping = nullptr;  // Windows only
+    };
+    static bool MapFile(const std::string& path, MappedFile& out);
+    static void UnmapFile(MappedFile& file);
+
+    MappedFile mapped;
+    std::vector<CachedMesh> meshes;
+};
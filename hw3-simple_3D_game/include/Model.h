@@ -2,15 +2,38 @@
 #include <vector>
 #include <string>
 #include "Mesh.h"
+#include "RenderQueue.h"
 #include <glm/glm.hpp>
 
+struct aiScene;
+
+// Serial walks the aiScene one mesh at a time; Parallel converts all meshes on
+// ThreadPool::Shared() into pre-sized buffers, then uploads them on the GL thread.
+enum class LoadMode { Serial, Parallel };
+
 class Model {
 public:
     std::vector<Mesh> meshes;
     std::string directory;
+    // union of every mesh's bounds, for culling whole instances
+    MeshBounds bounds;
+    // Assimp post-processing applied on import; part of the MeshCache key
+    static const unsigned int ImportFlags;
     Model() {}
-    Model(const std::string &path);
+    Model(const std::string &path, LoadMode mode = LoadMode::Parallel);
     void Draw();
+    // queues one draw per mesh with the given model matrix (color.a = 1 overrides the texture)
+    void Submit(RenderQueue& queue, Shader& shader, const glm::mat4& model, const glm::vec4& color = glm::vec4(0.0f));
+    // streams instances into a buffer owned by this model and queues one instanced draw per mesh;
+    // call at most once per model per frame, the buffer is reused on the next call
+    void SubmitInstanced(RenderQueue& queue, Shader& shader, const std::vector<InstanceData>& instances);
+    // CPU half of loading: every mesh reachable from the root node, in node order. No GL calls.
+    static std::vector<MeshData> ConvertScene(const aiScene* scene, LoadMode mode);
     // helper to create a simple cube if no model found
     static Model CreateCube();
+
+private:
+    void computeBounds();
+    unsigned int instanceVBO = 0;
+    size_t instanceCapacity = 0;
 };
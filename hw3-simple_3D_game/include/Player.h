@@ -13,4 +13,6 @@ public:
     void LoadModel(const std::string& path);
     void Update(float dt, bool forward, bool back, bool left, bool right);
     glm::mat4 GetModelMatrix() const;
+    // same transform for an arbitrary (e.g. interpolated) position and yaw
+    static glm::mat4 ModelMatrix(const glm::vec3& position, float yaw);
 };
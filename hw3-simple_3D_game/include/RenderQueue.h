@@ -0,0 +1,64 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include <glm/glm.hpp>
+#include "Mesh.h"
+#include "Shader.h"
+
+// Collects the frame's mesh draws, sorts them by a packed key and submits them
+// skipping program/VAO/texture binds that are already current.
+//
+// Key layout (most significant first):
+//   program id : 8 | material id : 16 | VAO : 16 | depth : 24
+// so draws group by program, then by texture set, then by vertex array, and
+// within a group go front to back for early depth rejection.
+class RenderQueue {
+public:
+    struct Stats {
+        unsigned int items = 0;
+        unsigned int drawCalls = 0;
+        unsigned int programBinds = 0;
+        unsigned int vaoBinds = 0;
+        unsigned int textureBinds = 0;
+        unsigned int skippedBinds = 0; // binds avoided because the state was already current
+        unsigned int StateChanges() const { return programBinds + vaoBinds + textureBinds; }
+    };
+
+    static const unsigned int MaxTextureUnits = 16;
+
+    // clears the queue; depth is measured from cameraPos and quantised over [0, farPlane]
+    void Begin(const glm::vec3& cameraPos, float farPlane);
+    // single draw; model goes to the "model" uniform, color.a = 1 switches to objectColor = color.rgb
+    void Submit(Shader& shader, const Mesh& mesh, const glm::mat4& model, const glm::vec4& color = glm::vec4(0.0f));
+    // instanceCount instances read through vao (see Mesh::InstanceVAO)
+    void SubmitInstanced(Shader& shader, const Mesh& mesh, unsigned int vao, unsigned int instanceCount);
+    // sorts and issues everything submitted since Begin
+    void Flush();
+
+    // counters for the last Flush
+    const Stats& GetStats() const { return stats; }
+
+    static uint64_t MakeKey(unsigned int program, unsigned int material, unsigned int vao, uint32_t depth);
+
+private:
+    struct Item {
+        Shader* shader;
+        const Mesh* mesh;
+        unsigned int vao;
+        unsigned int instanceCount; // 0 = single draw with per-item uniforms
+        glm::mat4 model;
+        glm::vec4 color;
+    };
+    struct SortEntry {
+        uint64_t key;
+        uint32_t item;
+    };
+
+    uint32_t QuantiseDepth(const glm::mat4& model) const;
+
+    glm::vec3 cameraPos = glm::vec3(0.0f);
+    float depthScale = 0.0f;
+    std::vector<Item> items;
+    std::vector<SortEntry> order;
+    Stats stats;
+};
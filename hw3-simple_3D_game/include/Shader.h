@@ -1,16 +1,34 @@
 #pragma once
 #include <string>
+#include <unordered_map>
 #include <glm/glm.hpp>
 
 class Shader {
 public:
+    // GL work issued through Shader since the last ResetFrameStats()
+    struct FrameStats {
+        unsigned int uniformCalls = 0;    // glUniform* calls
+        unsigned int locationQueries = 0; // glGetUniformLocation calls (cache misses)
+    };
+
     unsigned int ID;
     Shader() {}
     Shader(const char* vertexPath, const char* fragmentPath);
     void use();
+    // location resolved once per program; active uniforms are enumerated right after linking
+    int getLocation(const std::string &name) const;
+    // attaches a std140 uniform block of this program to a buffer binding point
+    void bindUniformBlock(const std::string &blockName, unsigned int bindingPoint) const;
     void setBool(const std::string &name, bool value) const;
     void setInt(const std::string &name, int value) const;
     void setFloat(const std::string &name, float value) const;
     void setMat4(const std::string &name, const glm::mat4 &mat) const;
     void setVec3(const std::string &name, const glm::vec3 &vec) const;
+
+    static const FrameStats& GetFrameStats();
+    static void ResetFrameStats();
+
+private:
+    mutable std::unordered_map<std::string, int> uniformLocations;
+    void cacheActiveUniforms();
 };
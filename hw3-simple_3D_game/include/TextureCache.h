@@ -0,0 +1,26 @@
+#pragma once
+#include <cstddef>
+#include <string>
+#include <vector>
+
+// Path-keyed cache of GL textures loaded for model materials. A texture shared by
+// several meshes or models is decoded and uploaded once; later requests return the
+// existing GL id. Misses are decoded with stbi_load on ThreadPool::Shared() and
+// uploaded on the calling thread, which must own the GL context.
+class TextureCache {
+public:
+    struct Stats {
+        unsigned int requests = 0;
+        unsigned int hits = 0;
+        unsigned int decoded = 0;
+        unsigned int failed = 0;
+        double decodeMs = 0.0;   // summed over workers
+        double loadMs = 0.0;     // wall time spent inside Acquire
+        size_t residentBytes = 0; // uploaded texels including the mip chain
+    };
+
+    // GL ids for files (same order), each looked up in assets/textures/ then in directory
+    static std::vector<unsigned int> Acquire(const std::vector<std::string>& files, const std::string& directory);
+    static const Stats& GetStats();
+    static void PrintStats();
+};
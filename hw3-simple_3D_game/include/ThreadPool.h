@@ -0,0 +1,48 @@
+#pragma once
+#include <condition_variable>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+
+// Fixed set of worker threads fed from one FIFO queue. Jobs must not touch GL;
+// results come back through futures and are consumed on the context thread.
+class ThreadPool {
+public:
+    // 0 = one worker per hardware thread
+    explicit ThreadPool(unsigned int threadCount = 0);
+    ~ThreadPool();
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    // process-wide pool shared by the asset loaders
+    static ThreadPool& Shared();
+
+    template <typename F>
+    auto Submit(F&& task) -> std::future<decltype(task())> {
+        using Result = decltype(task());
+        auto packaged = std::make_shared<std::packaged_task<Result()>>(std::forward<F>(task));
+        std::future<Result> result = packaged->get_future();
+        Enqueue([packaged]() { (*packaged)(); });
+        return result;
+    }
+
+    // splits [0, count) into contiguous chunks across the workers and blocks until all finish;
+    // call from outside the pool only
+    void ParallelFor(size_t count, const std::function<void(size_t begin, size_t end)>& body);
+
+    unsigned int Size() const { return (unsigned int)workers.size(); }
+
+private:
+    void Enqueue(std::function<void()> job);
+    void WorkerLoop();
+
+    std::vector<std::thread> workers;
+    std::queue<std::function<void()>> jobs;
+    std::mutex mutex;
+    std::condition_variable wake;
+    bool stopping = false;
+};
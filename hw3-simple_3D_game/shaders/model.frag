@@ -4,29 +4,33 @@ out vec4 FragColor;
 in vec3 FragPos;
 in vec3 Normal;
 in vec2 TexCoords;
+in vec4 ObjectColor; // rgb = override color, a = 1 when it replaces the texture
+
+layout (std140) uniform FrameData {
+    mat4 projection;
+    mat4 view;
+    vec4 viewPos;
+    vec4 lightPos;
+    vec4 lightColor;
+};
 
-uniform vec3 viewPos;
-uniform vec3 lightPos;
-uniform vec3 lightColor;
 uniform sampler2D diffuseTexture;
-uniform vec3 objectColor;
-uniform bool useObjectColor;
 
 void main() {
     vec3 texColor = texture(diffuseTexture, TexCoords).rgb;
 
     // choose base color: texture OR the override color
-    vec3 baseColor = useObjectColor ? objectColor : texColor;
+    vec3 baseColor = mix(texColor, ObjectColor.rgb, ObjectColor.a);
 
-    vec3 ambient = 0.1 * lightColor * baseColor;
+    vec3 ambient = 0.1 * lightColor.rgb * baseColor;
     vec3 norm = normalize(Normal);
-    vec3 lightDir = normalize(lightPos - FragPos);
+    vec3 lightDir = normalize(lightPos.xyz - FragPos);
     float diff = max(dot(norm, lightDir), 0.0);
-    vec3 diffuse = diff * lightColor * baseColor;
-    vec3 viewDir = normalize(viewPos - FragPos);
+    vec3 diffuse = diff * lightColor.rgb * baseColor;
+    vec3 viewDir = normalize(viewPos.xyz - FragPos);
     vec3 halfway = normalize(lightDir + viewDir);
     float spec = pow(max(dot(norm, halfway), 0.0), 32.0);
-    vec3 specular = spec * lightColor * 0.5;
+    vec3 specular = spec * lightColor.rgb * 0.5;
     vec3 color = ambient + diffuse + specular;
     FragColor = vec4(color, 1.0);
 }
\ No newline at end of file
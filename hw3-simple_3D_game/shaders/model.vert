@@ -3,17 +3,27 @@ layout (location = 0) in vec3 aPos;
 layout (location = 1) in vec3 aNormal;
 layout (location = 2) in vec2 aTex;
 
+layout (std140) uniform FrameData {
+    mat4 projection;
+    mat4 view;
+    vec4 viewPos;
+    vec4 lightPos;
+    vec4 lightColor;
+};
+
 uniform mat4 model;
-uniform mat4 view;
-uniform mat4 projection;
+uniform vec3 objectColor;
+uniform bool useObjectColor;
 
 out vec3 FragPos;
 out vec3 Normal;
 out vec2 TexCoords;
+out vec4 ObjectColor;
 
 void main() {
     FragPos = vec3(model * vec4(aPos,1.0));
     Normal = mat3(transpose(inverse(model))) * aNormal;
     TexCoords = aTex;
+    ObjectColor = vec4(objectColor, useObjectColor ? 1.0 : 0.0);
     gl_Position = projection * view * vec4(FragPos, 1.0);
 }
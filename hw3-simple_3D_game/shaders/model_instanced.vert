@@ -0,0 +1,28 @@
+#version 330 core
+layout (location = 0) in vec3 aPos;
+layout (location = 1) in vec3 aNormal;
+layout (location = 2) in vec2 aTex;
+// per-instance (divisor 1), see InstanceData in Mesh.h
+layout (location = 3) in mat4 aModel;
+layout (location = 7) in vec4 aColor;
+
+layout (std140) uniform FrameData {
+    mat4 projection;
+    mat4 view;
+    vec4 viewPos;
+    vec4 lightPos;
+    vec4 lightColor;
+};
+
+out vec3 FragPos;
+out vec3 Normal;
+out vec2 TexCoords;
+out vec4 ObjectColor;
+
+void main() {
+    FragPos = vec3(aModel * vec4(aPos,1.0));
+    Normal = mat3(transpose(inverse(aModel))) * aNormal;
+    TexCoords = aTex;
+    ObjectColor = aColor;
+    gl_Position = projection * view * vec4(FragPos, 1.0);
+}
@@ -0,0 +1,371 @@
+#include "Benchmark.h"
+#include "CollisionWorld.h"
+#include "Culling.h"
+#include "Game.h"
+#include "MeshCache.h"
+#include "Model.h"
+#include "ThreadPool.h"
+#include <glad/glad.h>
+#include <glm/gtc/matrix_transform.hpp>
+#include "imgui.h"
+#include "imgui_impl_opengl3.h"
+#include <assimp/scene.h>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <filesystem>
+#include <random>
+#include <string>
+
+namespace {
+
+double MillisecondsSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+// meshCount separate grid meshes (gridSize x gridSize vertices each) hanging off the root node
+aiScene* BuildSyntheticScene(int meshCount, int gridSize) {
+    aiScene* scene = new aiScene();
+    scene->mNumMaterials = 1;
+    scene->mMaterials = new aiMaterial*[1];
+    scene->mMaterials[0] = new aiMaterial();
+
+    scene->mNumMeshes = meshCount;
+    scene->mMeshes = new aiMesh*[meshCount];
+    scene->mRootNode = new aiNode();
+    scene->mRootNode->mNumMeshes = meshCount;
+    scene->mRootNode->mMeshes = new unsigned int[meshCount];
+
+    const unsigned int quads = (gridSize - 1) * (gridSize - 1);
+    for (int m = 0; m < meshCount; m++) {
+        aiMesh* mesh = new aiMesh();
+        mesh->mMaterialIndex = 0;
+        mesh->mNumVertices = gridSize * gridSize;
+        mesh->mVertices = new aiVector3D[mesh->mNumVertices];
+        mesh->mNormals = new aiVector3D[mesh->mNumVertices];
+        mesh->mTextureCoords[0] = new aiVector3D[mesh->mNumVertices];
+        for (int y = 0; y < gridSize; y++) {
+            for (int x = 0; x < gridSize; x++) {
+                unsigned int v = y * gridSize + x;
+                mesh->mVertices[v] = aiVector3D((float)x, (float)m, (float)y);
+                mesh->mNormals[v] = aiVector3D(0.0f, 1.0f, 0.0f);
+                mesh->mTextureCoords[0][v] = aiVector3D((float)x / gridSize, (float)y / gridSize, 0.0f);
+            }
+        }
+        mesh->mNumFaces = quads * 2;
+        mesh->mFaces = new aiFace[mesh->mNumFaces];
+        unsigned int f = 0;
+        for (int y = 0; y + 1 < gridSize; y++) {
+            for (int x = 0; x + 1 < gridSize; x++) {
+                unsigned int v = y * gridSize + x;
+                unsigned int tris[2][3] = {{v, v + gridSize, v + 1}, {v + 1, v + gridSize, v + gridSize + 1}};
+                for (auto& tri : tris) {
+                    aiFace& face = mesh->mFaces[f++];
+                    face.mNumIndices = 3;
+                    face.mIndices = new unsigned int[3]{tri[0], tri[1], tri[2]};
+                }
+            }
+        }
+        scene->mMeshes[m] = mesh;
+        scene->mRootNode->mMeshes[m] = m;
+    }
+    return scene;
+}
+
+// deterministic walk: forward runs, turns both ways, a back-off and a spin, repeated
+GameInput ScriptedInput(int frame) {
+    GameInput input;
+    int t = frame % 480;
+    input.forward = t < 300;
+    input.left = t >= 90 && t < 150;
+    input.right = (t >= 210 && t < 270) || (t >= 400 && t < 440);
+    input.back = t >= 300 && t < 360;
+    input.spin = t >= 360 && t < 400;
+    return input;
+}
+
+// nearest-rank percentile of an ascending-sorted sample
+double Percentile(const std::vector<double>& sorted, double p) {
+    if (sorted.empty()) return 0.0;
+    size_t rank = (size_t)std::ceil(p / 100.0 * sorted.size());
+    return sorted[std::min(sorted.size(), std::max<size_t>(rank, 1)) - 1];
+}
+
+// text as a JSON string literal, quotes included
+std::string JsonString(const char* text) {
+    std::string json = "\"";
+    for (const char* c = text; *c; ++c) {
+        if (*c == '"' || *c == '\\') {
+            json += '\\';
+            json += *c;
+        } else if ((unsigned char)*c < 0x20) {
+            char escaped[8];
+            std::snprintf(escaped, sizeof(escaped), "\\u%04x", (unsigned char)*c);
+            json += escaped;
+        } else {
+            json += *c;
+        }
+    }
+    return json + "\"";
+}
+
+void WriteSeries(FILE* out, const char* indent, const char* name, std::vector<double> samples, bool last) {
+    std::sort(samples.begin(), samples.end());
+    double sum = 0.0;
+    for (double v : samples) sum += v;
+    std::fprintf(out, "%s\"%s\": {\"mean\": %.4f, \"p50\": %.4f, \"p95\": %.4f, \"p99\": %.4f, \"max\": %.4f}%s\n",
+                 indent, name, samples.empty() ? 0.0 : sum / samples.size(), Percentile(samples, 50), Percentile(samples, 95),
+                 Percentile(samples, 99), samples.empty() ? 0.0 : samples.back(), last ? "" : ",");
+}
+
+}
+
+void Benchmark::MeshConversion(int meshCount, int runs) {
+    const int gridSize = 48;
+    aiScene* scene = BuildSyntheticScene(meshCount, gridSize);
+    std::printf("Mesh conversion benchmark: %d meshes x %d vertices, %d runs, %u workers\n",
+                meshCount, gridSize * gridSize, runs, ThreadPool::Shared().Size());
+
+    double serial = 0.0, parallel = 0.0;
+    for (int run = 0; run < runs; run++) {
+        auto start = std::chrono::steady_clock::now();
+        std::vector<MeshData> a = Model::ConvertScene(scene, LoadMode::Serial);
+        serial += MillisecondsSince(start);
+
+        start = std::chrono::steady_clock::now();
+        std::vector<MeshData> b = Model::ConvertScene(scene, LoadMode::Parallel);
+        parallel += MillisecondsSince(start);
+
+        if (a.size() != b.size() || a.back().indices != b.back().indices)
+            std::printf("warning: serial and parallel output differ\n");
+    }
+    serial /= runs;
+    parallel /= runs;
+    std::printf("serial   %10.2f ms\nparallel %10.2f ms\nspeedup  %10.2fx\n", serial, parallel, parallel > 0.0 ? serial / parallel : 0.0);
+    delete scene;
+}
+
+void Benchmark::ModelLoad(const std::vector<std::string>& modelPaths, int runs) {
+    std::printf("Model load benchmark (%d runs)\n", runs);
+    std::printf("%-32s %12s %12s %9s\n", "model", "cold ms", "warm ms", "speedup");
+
+    double totalCold = 0.0, totalWarm = 0.0;
+    for (const std::string& path : modelPaths) {
+        double cold = 0.0, warm = 0.0;
+        for (int run = 0; run < runs; run++) {
+            std::error_code ec;
+            std::filesystem::remove(MeshCache::PathFor(path), ec);
+
+            auto start = std::chrono::steady_clock::now();
+            Model coldModel(path);
+            cold += MillisecondsSince(start);
+
+            start = std::chrono::steady_clock::now();
+            Model warmModel(path);
+            warm += MillisecondsSince(start);
+        }
+        cold /= runs;
+        warm /= runs;
+        totalCold += cold;
+        totalWarm += warm;
+        std::string name = std::filesystem::path(path).filename().string();
+        std::printf("%-32s %12.2f %12.2f %8.1fx\n", name.c_str(), cold, warm, warm > 0.0 ? cold / warm : 0.0);
+    }
+    std::printf("%-32s %12.2f %12.2f %8.1fx\n", "total", totalCold, totalWarm, totalWarm > 0.0 ? totalCold / totalWarm : 0.0);
+}
+
+void Benchmark::CollisionQueries(int queries) {
+    const int sweepQueries = std::max(1, queries / 4);
+    const glm::vec3 playerHalf(0.5f, 0.4f, 0.8f);
+    std::printf("Collision query benchmark: %d overlap + %d sweep queries per world\n", queries, sweepQueries);
+    std::printf("%10s %10s %14s %14s %10s %14s\n", "boxes", "build ms", "overlap q/s", "sweep q/s", "avg hits", "brute q/s");
+
+    for (int boxCount : {10000, 100000, 1000000}) {
+        // constant density on a flat level: about one box per 4 square units
+        const float extent = std::sqrt((float)boxCount) * 2.0f;
+        std::mt19937 rng(1234);
+        std::uniform_real_distribution<float> coord(-extent * 0.5f, extent * 0.5f);
+        std::uniform_real_distribution<float> height(0.0f, 2.0f);
+        std::uniform_real_distribution<float> half(0.2f, 0.8f);
+        std::uniform_real_distribution<float> step(-1.0f, 1.0f);
+
+        std::vector<AABB> boxes(boxCount);
+        for (AABB& box : boxes)
+            box = Collision::FromPositionSize(glm::vec3(coord(rng), height(rng), coord(rng)), glm::vec3(half(rng), half(rng), half(rng)));
+
+        auto start = std::chrono::steady_clock::now();
+        CollisionWorld world;
+        for (const AABB& box : boxes)
+            world.Insert(box);
+        double buildMs = MillisecondsSince(start);
+
+        std::vector<AABB> probes(queries);
+        for (AABB& probe : probes)
+            probe = Collision::FromPositionSize(glm::vec3(coord(rng), 1.0f, coord(rng)), playerHalf);
+
+        std::vector<CollisionWorld::Handle> hits;
+        size_t totalHits = 0;
+        start = std::chrono::steady_clock::now();
+        for (const AABB& probe : probes) {
+            hits.clear();
+            world.QueryOverlap(probe, 1, hits);
+            totalHits += hits.size();
+        }
+        double overlapMs = MillisecondsSince(start);
+
+        start = std::chrono::steady_clock::now();
+        for (int i = 0; i < sweepQueries; i++) {
+            CollisionWorld::SweepHit hit;
+            world.Sweep(probes[i], glm::vec3(step(rng), 0.0f, step(rng)), 1, hit);
+        }
+        double sweepMs = MillisecondsSince(start);
+
+        // the old per-frame loop, on a small sample so the 1M case finishes
+        const int bruteQueries = std::min(queries, 200);
+        size_t bruteHits = 0;
+        start = std::chrono::steady_clock::now();
+        for (int i = 0; i < bruteQueries; i++)
+            for (const AABB& box : boxes)
+                bruteHits += Collision::TestAABB(probes[i], box) ? 1 : 0;
+        double bruteMs = MillisecondsSince(start);
+
+        size_t gridHits = 0;
+        for (int i = 0; i < bruteQueries; i++) {
+            hits.clear();
+            world.QueryOverlap(probes[i], 1, hits);
+            gridHits += hits.size();
+        }
+        if (gridHits != bruteHits)
+            std::printf("warning: grid and brute force disagree (%zu vs %zu hits)\n", gridHits, bruteHits);
+
+        std::printf("%10d %10.1f %14.0f %14.0f %10.2f %14.0f\n", boxCount, buildMs,
+                    queries / (overlapMs * 1e-3), sweepQueries / (sweepMs * 1e-3),
+                    (double)totalHits / queries, bruteQueries / (bruteMs * 1e-3));
+    }
+}
+
+void Benchmark::FrustumCulling(int count, int runs) {
+    // instances scattered all around a third-person camera, so most of them are culled
+    std::mt19937 rng(99);
+    std::uniform_real_distribution<float> coord(-100.0f, 100.0f);
+    std::uniform_real_distribution<float> angle(0.0f, 6.2831853f);
+    std::uniform_real_distribution<float> scale(0.02f, 0.1f);
+    std::vector<glm::mat4> transforms(count);
+    for (glm::mat4& m : transforms) {
+        m = glm::translate(glm::mat4(1.0f), glm::vec3(coord(rng), 0.0f, coord(rng)));
+        m = glm::rotate(m, angle(rng), glm::vec3(0.0f, 1.0f, 0.0f));
+        m = glm::scale(m, glm::vec3(scale(rng)));
+    }
+    MeshBounds bounds;
+    bounds.min = glm::vec3(-10.0f, 0.0f, -10.0f);
+    bounds.max = glm::vec3(10.0f, 40.0f, 10.0f);
+    bounds.center = glm::vec3(0.0f, 20.0f, 0.0f);
+    bounds.radius = 24.5f;
+
+    glm::mat4 projection = glm::perspective(glm::radians(45.0f), 16.0f / 9.0f, 0.1f, 100.0f);
+    glm::mat4 view = glm::lookAt(glm::vec3(0.0f, 3.0f, 8.0f), glm::vec3(0.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+    Frustum frustum = Frustum::FromViewProjection(projection * view);
+
+    BoundsCuller culler;
+    culler.Reserve(count);
+    double transformMs = 0.0, simdMs = 0.0, scalarMs = 0.0;
+    std::vector<uint8_t> reference(count);
+    for (int run = 0; run < runs; run++) {
+        auto start = std::chrono::steady_clock::now();
+        culler.Clear();
+        for (const glm::mat4& m : transforms)
+            culler.Add(m, bounds);
+        transformMs += MillisecondsSince(start);
+
+        start = std::chrono::steady_clock::now();
+        culler.CullScalar(frustum);
+        scalarMs += MillisecondsSince(start);
+        for (int i = 0; i < count; i++)
+            reference[i] = culler.IsVisible(i) ? 1 : 0;
+
+        start = std::chrono::steady_clock::now();
+        culler.Cull(frustum);
+        simdMs += MillisecondsSince(start);
+        for (int i = 0; i < count; i++) {
+            if (reference[i] != (culler.IsVisible(i) ? 1 : 0)) {
+                std::printf("warning: SIMD and scalar culling disagree at %d\n", i);
+                break;
+            }
+        }
+    }
+    const BoundsCuller::Stats& stats = culler.GetStats();
+    std::printf("Frustum culling benchmark: %d instances, %d runs, %u visible / %u culled (%u by the box test)\n",
+                count, runs, stats.visible, stats.culled, stats.boxCulled);
+    std::printf("transform %8.3f ms\nscalar    %8.3f ms\nsimd      %8.3f ms (%.2f ns/instance)\nspeedup   %8.2fx\n",
+                transformMs / runs, scalarMs / runs, simdMs / runs, simdMs / runs * 1e6 / count,
+                simdMs > 0.0 ? scalarMs / simdMs : 0.0);
+}
+
+bool Benchmark::FrameTimes(Game& game, int frames, int width, int height, const std::string& jsonPath) {
+    const float dt = Game::TickSeconds;
+    const int warmup = std::min(30, frames / 10);
+    std::vector<double> frame, update, collision, draw, cull, ui;
+    unsigned long long drawCalls = 0, stateChanges = 0, ticks = 0, visible = 0, culled = 0;
+
+    ImGuiIO& io = ImGui::GetIO();
+    io.DisplaySize = ImVec2((float)width, (float)height);
+    io.DeltaTime = dt;
+    glViewport(0, 0, width, height);
+
+    for (int i = 0; i < warmup + frames; i++) {
+        auto start = std::chrono::steady_clock::now();
+        game.Update(dt, ScriptedInput(i));
+        game.Render(width, height);
+        ImGui_ImplOpenGL3_NewFrame();
+        game.RenderUi(width);
+        // stands in for SwapBuffers: the frame isn't done until the driver has drawn it
+        glFinish();
+        double frameMs = MillisecondsSince(start);
+        if (i < warmup)
+            continue;
+
+        const Game::PhaseTimes& phases = game.GetPhaseTimes();
+        frame.push_back(frameMs);
+        update.push_back(phases.update);
+        collision.push_back(phases.collision);
+        draw.push_back(phases.draw);
+        cull.push_back(phases.cull);
+        ui.push_back(phases.ui);
+        drawCalls += game.DrawCalls();
+        stateChanges += game.GetRenderStats().StateChanges();
+        ticks += phases.ticks;
+        visible += game.GetCullStats().visible;
+        culled += game.GetCullStats().culled;
+    }
+
+    FILE* out = jsonPath == "-" ? stdout : std::fopen(jsonPath.c_str(), "w");
+    if (!out) {
+        std::fprintf(stderr, "Benchmark: cannot write %s\n", jsonPath.c_str());
+        return false;
+    }
+    const char* renderer = (const char*)glGetString(GL_RENDERER);
+    std::fprintf(out, "{\n");
+    std::fprintf(out, "  \"renderer\": %s,\n", JsonString(renderer ? renderer : "unknown").c_str());
+    std::fprintf(out, "  \"width\": %d,\n  \"height\": %d,\n", width, height);
+    std::fprintf(out, "  \"frames\": %d,\n  \"warmup_frames\": %d,\n  \"dt\": %.6f,\n", frames, warmup, dt);
+    WriteSeries(out, "  ", "frame_ms", frame, false);
+    std::fprintf(out, "  \"phases_ms\": {\n");
+    WriteSeries(out, "    ", "update", update, false);
+    WriteSeries(out, "    ", "collision", collision, false);
+    WriteSeries(out, "    ", "draw", draw, false);
+    WriteSeries(out, "    ", "cull", cull, false);
+    WriteSeries(out, "    ", "ui", ui, true);
+    std::fprintf(out, "  },\n");
+    std::fprintf(out, "  \"draw_calls_total\": %llu,\n  \"draw_calls_per_frame\": %.2f,\n", drawCalls, frames ? (double)drawCalls / frames : 0.0);
+    std::fprintf(out, "  \"state_changes_total\": %llu,\n", stateChanges);
+    std::fprintf(out, "  \"sim_ticks_total\": %llu,\n", ticks);
+    std::fprintf(out, "  \"visible_total\": %llu,\n  \"culled_total\": %llu,\n", visible, culled);
+    std::fprintf(out, "  \"bones_collected\": %d\n", game.CollectedCount());
+    std::fprintf(out, "}\n");
+    if (out != stdout) {
+        std::fclose(out);
+        std::printf("Frame benchmark written to %s\n", jsonPath.c_str());
+    }
+    return true;
+}
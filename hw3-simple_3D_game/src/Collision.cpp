@@ -13,3 +13,34 @@ bool Collision::TestAABB(const AABB& a, const AABB& b){
     if (a.max.z < b.min.z || a.min.z > b.max.z) return false;
     return true;
 }
+
+bool Collision::SweepAABB(const AABB& moving, const glm::vec3& delta, const AABB& target, float& time, glm::vec3& normal){
+    float entry = -1e30f, exit = 1e30f;
+    int entryAxis = -1;
+    for (int axis = 0; axis < 3; ++axis) {
+        float axisEntry, axisExit;
+        if (delta[axis] > 0.0f) {
+            axisEntry = (target.min[axis] - moving.max[axis]) / delta[axis];
+            axisExit = (target.max[axis] - moving.min[axis]) / delta[axis];
+        } else if (delta[axis] < 0.0f) {
+            axisEntry = (target.max[axis] - moving.min[axis]) / delta[axis];
+            axisExit = (target.min[axis] - moving.max[axis]) / delta[axis];
+        } else {
+            // not moving on this axis: must already overlap on it
+            if (moving.max[axis] < target.min[axis] || moving.min[axis] > target.max[axis]) return false;
+            continue;
+        }
+        if (axisEntry > entry) { entry = axisEntry; entryAxis = axis; }
+        if (axisExit < exit) exit = axisExit;
+    }
+    if (entry > exit || exit < 0.0f || entry > 1.0f) return false;
+
+    normal = glm::vec3(0.0f);
+    if (entry < 0.0f || entryAxis < 0) {
+        time = 0.0f;
+        return true;
+    }
+    time = entry;
+    normal[entryAxis] = delta[entryAxis] > 0.0f ? -1.0f : 1.0f;
+    return true;
+}
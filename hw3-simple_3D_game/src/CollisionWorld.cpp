@@ -0,0 +1,204 @@
+#include "CollisionWorld.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+// gap left between a swept box and what it hits, so the next sweep starts outside it
+const float ContactSkin = 1e-3f;
+
+}
+
+CollisionWorld::CollisionWorld(float cellSize)
+    : cellSize(cellSize), invCellSize(1.0f / cellSize) {}
+
+CollisionWorld::CellRange CollisionWorld::RangeFor(const AABB& box) const {
+    CellRange range;
+    for (int axis = 0; axis < 3; ++axis) {
+        range.min[axis] = (int)std::floor(box.min[axis] * invCellSize);
+        range.max[axis] = (int)std::floor(box.max[axis] * invCellSize);
+    }
+    return range;
+}
+
+long long CollisionWorld::CellCount(const CellRange& range) {
+    return (long long)(range.max[0] - range.min[0] + 1) *
+           (range.max[1] - range.min[1] + 1) *
+           (range.max[2] - range.min[2] + 1);
+}
+
+uint64_t CollisionWorld::CellKey(int x, int y, int z) {
+    // 21 bits per axis is +-1M cells, far beyond any level we build
+    const uint64_t mask = (1u << 21) - 1;
+    return ((uint64_t)x & mask) | (((uint64_t)y & mask) << 21) | (((uint64_t)z & mask) << 42);
+}
+
+CollisionWorld::Handle CollisionWorld::Insert(const AABB& box, uint32_t layer, uint32_t userData) {
+    Handle handle;
+    if (!freeList.empty()) {
+        handle = freeList.back();
+        freeList.pop_back();
+    } else {
+        handle = (Handle)proxies.size();
+        proxies.emplace_back();
+        visited.push_back(0);
+    }
+    Proxy& proxy = proxies[handle];
+    proxy.box = box;
+    proxy.layer = layer;
+    proxy.userData = userData;
+    proxy.alive = true;
+    Link(handle);
+    return handle;
+}
+
+void CollisionWorld::Remove(Handle handle) {
+    if (handle >= proxies.size() || !proxies[handle].alive) return;
+    Unlink(handle);
+    proxies[handle].alive = false;
+    freeList.push_back(handle);
+}
+
+void CollisionWorld::Move(Handle handle, const AABB& box) {
+    if (handle >= proxies.size() || !proxies[handle].alive) return;
+    Proxy& proxy = proxies[handle];
+    CellRange range = RangeFor(box);
+    bool oversized = CellCount(range) > MaxCellsPerBox;
+    bool sameCells = !oversized && !proxy.oversized &&
+                     std::equal(range.min, range.min + 3, proxy.cells.min) &&
+                     std::equal(range.max, range.max + 3, proxy.cells.max);
+    if (sameCells) {
+        // most frames a moving box stays in the cells it already occupies
+        proxy.box = box;
+        return;
+    }
+    Unlink(handle);
+    proxy.box = box;
+    Link(handle);
+}
+
+void CollisionWorld::Link(Handle handle) {
+    Proxy& proxy = proxies[handle];
+    proxy.cells = RangeFor(proxy.box);
+    proxy.oversized = CellCount(proxy.cells) > MaxCellsPerBox;
+    if (proxy.oversized) {
+        oversized.push_back(handle);
+        return;
+    }
+    const CellRange& r = proxy.cells;
+    for (int z = r.min[2]; z <= r.max[2]; ++z)
+        for (int y = r.min[1]; y <= r.max[1]; ++y)
+            for (int x = r.min[0]; x <= r.max[0]; ++x)
+                cells[CellKey(x, y, z)].push_back(handle);
+}
+
+void CollisionWorld::Unlink(Handle handle) {
+    Proxy& proxy = proxies[handle];
+    if (proxy.oversized) {
+        oversized.erase(std::find(oversized.begin(), oversized.end(), handle));
+        return;
+    }
+    const CellRange& r = proxy.cells;
+    for (int z = r.min[2]; z <= r.max[2]; ++z) {
+        for (int y = r.min[1]; y <= r.max[1]; ++y) {
+            for (int x = r.min[0]; x <= r.max[0]; ++x) {
+                auto it = cells.find(CellKey(x, y, z));
+                if (it == cells.end()) continue;
+                std::vector<Handle>& list = it->second;
+                auto pos = std::find(list.begin(), list.end(), handle);
+                if (pos != list.end()) {
+                    *pos = list.back();
+                    list.pop_back();
+                }
+                if (list.empty()) cells.erase(it);
+            }
+        }
+    }
+}
+
+template <typename Fn>
+void CollisionWorld::ForEachCandidate(const CellRange& range, uint32_t layerMask, Fn fn) const {
+    // a box spanning several cells is listed in each; stamp it so it is reported once
+    if (++visitStamp == 0) {
+        std::fill(visited.begin(), visited.end(), 0);
+        visitStamp = 1;
+    }
+    auto visit = [&](Handle handle) {
+        if (visited[handle] == visitStamp) return;
+        visited[handle] = visitStamp;
+        const Proxy& proxy = proxies[handle];
+        if (proxy.layer & layerMask) fn(handle, proxy);
+    };
+
+    for (Handle handle : oversized)
+        visit(handle);
+
+    if (CellCount(range) > (long long)cells.size()) {
+        // query covers more cells than are occupied: walk the occupied ones instead
+        for (const auto& cell : cells)
+            for (Handle handle : cell.second)
+                visit(handle);
+        return;
+    }
+    for (int z = range.min[2]; z <= range.max[2]; ++z) {
+        for (int y = range.min[1]; y <= range.max[1]; ++y) {
+            for (int x = range.min[0]; x <= range.max[0]; ++x) {
+                auto it = cells.find(CellKey(x, y, z));
+                if (it == cells.end()) continue;
+                for (Handle handle : it->second)
+                    visit(handle);
+            }
+        }
+    }
+}
+
+void CollisionWorld::QueryOverlap(const AABB& box, uint32_t layerMask, std::vector<Handle>& out) const {
+    ForEachCandidate(RangeFor(box), layerMask, [&](Handle handle, const Proxy& proxy) {
+        if (Collision::TestAABB(box, proxy.box))
+            out.push_back(handle);
+    });
+}
+
+bool CollisionWorld::Sweep(const AABB& box, const glm::vec3& delta, uint32_t layerMask, SweepHit& hit, bool skipOverlaps) const {
+    AABB swept;
+    swept.min = glm::min(box.min, box.min + delta);
+    swept.max = glm::max(box.max, box.max + delta);
+
+    hit = SweepHit();
+    ForEachCandidate(RangeFor(swept), layerMask, [&](Handle handle, const Proxy& proxy) {
+        if (!Collision::TestAABB(swept, proxy.box)) return;
+        float time;
+        glm::vec3 normal;
+        if (!Collision::SweepAABB(box, delta, proxy.box, time, normal)) return;
+        // a zero normal means overlapping at the start
+        if (skipOverlaps && normal == glm::vec3(0.0f)) return;
+        if (time < hit.time) {
+            hit.handle = handle;
+            hit.time = time;
+            hit.normal = normal;
+        }
+    });
+    return hit.handle != InvalidHandle;
+}
+
+glm::vec3 CollisionWorld::SlideMove(const AABB& box, const glm::vec3& delta, uint32_t layerMask, int maxIterations) const {
+    glm::vec3 moved(0.0f);
+    glm::vec3 remaining = delta;
+    for (int i = 0; i < maxIterations; ++i) {
+        float length = glm::length(remaining);
+        if (length < 1e-6f) break;
+
+        AABB current = {box.min + moved, box.max + moved};
+        SweepHit hit;
+        // started inside something: don't trap the mover, let it walk out of that box,
+        // but still stop it at every other one
+        if (!Sweep(current, remaining, layerMask, hit, true))
+            return moved + remaining;
+
+        float time = std::max(0.0f, hit.time - ContactSkin / length);
+        moved += remaining * time;
+        remaining *= 1.0f - time;
+        remaining -= hit.normal * glm::dot(remaining, hit.normal);
+    }
+    return moved;
+}
@@ -0,0 +1,163 @@
+#include "Culling.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#define CULLING_SSE 1
+#include <xmmintrin.h>
+#endif
+
+namespace {
+
+// movemask nibble -> four 0/1 flag bytes (little-endian) and its population count
+const uint32_t MaskBytes[16] = {
+    0x00000000, 0x00000001, 0x00000100, 0x00000101, 0x00010000, 0x00010001, 0x00010100, 0x00010101,
+    0x01000000, 0x01000001, 0x01000100, 0x01000101, 0x01010000, 0x01010001, 0x01010100, 0x01010101};
+const uint8_t MaskBits[16] = {0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4};
+
+}
+
+Frustum Frustum::FromViewProjection(const glm::mat4& m) {
+    // Gribb/Hartmann: planes are sums/differences of the matrix rows (glm is column-major)
+    glm::vec4 row[4];
+    for (int i = 0; i < 4; i++)
+        row[i] = glm::vec4(m[0][i], m[1][i], m[2][i], m[3][i]);
+
+    Frustum f;
+    f.planes[0] = row[3] + row[0]; // left
+    f.planes[1] = row[3] - row[0]; // right
+    f.planes[2] = row[3] + row[1]; // bottom
+    f.planes[3] = row[3] - row[1]; // top
+    f.planes[4] = row[3] + row[2]; // near
+    f.planes[5] = row[3] - row[2]; // far
+    for (glm::vec4& plane : f.planes)
+        plane /= glm::length(glm::vec3(plane));
+    return f;
+}
+
+void BoundsCuller::Clear() {
+    x.clear();
+    y.clear();
+    z.clear();
+    r.clear();
+    ex.clear();
+    ey.clear();
+    ez.clear();
+}
+
+void BoundsCuller::Reserve(size_t count) {
+    x.reserve(count);
+    y.reserve(count);
+    z.reserve(count);
+    r.reserve(count);
+    ex.reserve(count);
+    ey.reserve(count);
+    ez.reserve(count);
+}
+
+uint32_t BoundsCuller::Add(const glm::vec3& center, float radius) {
+    x.push_back(center.x);
+    y.push_back(center.y);
+    z.push_back(center.z);
+    r.push_back(radius);
+    ex.push_back(radius);
+    ey.push_back(radius);
+    ez.push_back(radius);
+    return (uint32_t)(x.size() - 1);
+}
+
+uint32_t BoundsCuller::Add(const glm::mat4& transform, const MeshBounds& bounds) {
+    glm::vec3 center = glm::vec3(transform * glm::vec4(bounds.center, 1.0f));
+    float scale2 = std::max(glm::dot(glm::vec3(transform[0]), glm::vec3(transform[0])),
+                   std::max(glm::dot(glm::vec3(transform[1]), glm::vec3(transform[1])),
+                            glm::dot(glm::vec3(transform[2]), glm::vec3(transform[2]))));
+    uint32_t index = Add(center, bounds.radius * std::sqrt(scale2));
+    // Arvo: each world extent sums the local extents through |upper 3x3|
+    glm::vec3 half = (bounds.max - bounds.min) * 0.5f;
+    glm::vec3 extent = glm::abs(glm::vec3(transform[0])) * half.x + glm::abs(glm::vec3(transform[1])) * half.y +
+                       glm::abs(glm::vec3(transform[2])) * half.z;
+    ex[index] = extent.x;
+    ey[index] = extent.y;
+    ez[index] = extent.z;
+    return index;
+}
+
+size_t BoundsCuller::CullRange(const Frustum& frustum, size_t begin, size_t end, unsigned int& boxCulled) {
+    size_t count = 0;
+    for (size_t i = begin; i < end; i++) {
+        bool sphereInside = true, inside = true;
+        for (const glm::vec4& p : frustum.planes) {
+            float d = p.x * x[i] + p.y * y[i] + p.z * z[i] + p.w;
+            float boxRadius = std::fabs(p.x) * ex[i] + std::fabs(p.y) * ey[i] + std::fabs(p.z) * ez[i];
+            sphereInside = sphereInside && d >= -r[i];
+            inside = inside && d >= -std::min(r[i], boxRadius);
+        }
+        visible[i] = inside ? 1 : 0;
+        count += inside ? 1 : 0;
+        boxCulled += sphereInside && !inside ? 1 : 0;
+    }
+    return count;
+}
+
+void BoundsCuller::CullScalar(const Frustum& frustum) {
+    visible.resize(x.size());
+    stats.tested = (unsigned int)x.size();
+    stats.boxCulled = 0;
+    stats.visible = (unsigned int)CullRange(frustum, 0, x.size(), stats.boxCulled);
+    stats.culled = stats.tested - stats.visible;
+}
+
+void BoundsCuller::Cull(const Frustum& frustum) {
+#ifdef CULLING_SSE
+    const size_t n = x.size();
+    visible.resize(n);
+
+    __m128 px[6], py[6], pz[6], pw[6], ax[6], ay[6], az[6];
+    for (int p = 0; p < 6; p++) {
+        px[p] = _mm_set1_ps(frustum.planes[p].x);
+        py[p] = _mm_set1_ps(frustum.planes[p].y);
+        pz[p] = _mm_set1_ps(frustum.planes[p].z);
+        pw[p] = _mm_set1_ps(frustum.planes[p].w);
+        ax[p] = _mm_set1_ps(std::fabs(frustum.planes[p].x));
+        ay[p] = _mm_set1_ps(std::fabs(frustum.planes[p].y));
+        az[p] = _mm_set1_ps(std::fabs(frustum.planes[p].z));
+    }
+    const __m128 zero = _mm_setzero_ps();
+
+    size_t count = 0, i = 0;
+    unsigned int boxCulled = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m128 cx = _mm_loadu_ps(&x[i]);
+        __m128 cy = _mm_loadu_ps(&y[i]);
+        __m128 cz = _mm_loadu_ps(&z[i]);
+        __m128 radius = _mm_loadu_ps(&r[i]);
+        __m128 hx = _mm_loadu_ps(&ex[i]);
+        __m128 hy = _mm_loadu_ps(&ey[i]);
+        __m128 hz = _mm_loadu_ps(&ez[i]);
+        // signed distance to each plane must be >= -radius for the sphere and >= -(box
+        // extent along the normal) for the box; AND the six results together
+        __m128 sphereInside = _mm_cmpeq_ps(zero, zero);
+        __m128 inside = sphereInside;
+        for (int p = 0; p < 6; p++) {
+            __m128 d = _mm_add_ps(_mm_add_ps(_mm_mul_ps(px[p], cx), _mm_mul_ps(py[p], cy)),
+                                  _mm_add_ps(_mm_mul_ps(pz[p], cz), pw[p]));
+            __m128 boxRadius = _mm_add_ps(_mm_add_ps(_mm_mul_ps(ax[p], hx), _mm_mul_ps(ay[p], hy)), _mm_mul_ps(az[p], hz));
+            sphereInside = _mm_and_ps(sphereInside, _mm_cmpge_ps(d, _mm_sub_ps(zero, radius)));
+            inside = _mm_and_ps(inside, _mm_cmpge_ps(d, _mm_sub_ps(zero, _mm_min_ps(radius, boxRadius))));
+        }
+        int mask = _mm_movemask_ps(inside);
+        std::memcpy(&visible[i], &MaskBytes[mask], 4);
+        count += MaskBits[mask];
+        boxCulled += MaskBits[_mm_movemask_ps(sphereInside) & ~mask];
+    }
+    count += CullRange(frustum, i, n, boxCulled);
+
+    stats.tested = (unsigned int)n;
+    stats.visible = (unsigned int)count;
+    stats.culled = stats.tested - stats.visible;
+    stats.boxCulled = boxCulled;
+#else
+    CullScalar(frustum);
+#endif
+}
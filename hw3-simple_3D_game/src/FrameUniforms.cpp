@@ -0,0 +1,18 @@
+#include "FrameUniforms.h"
+#include <glad/glad.h>
+
+static_assert(sizeof(FrameData) == 2 * 64 + 3 * 16, "FrameData must match the std140 layout in the shaders");
+
+void FrameUniforms::Init() {
+    glGenBuffers(1, &UBO);
+    glBindBuffer(GL_UNIFORM_BUFFER, UBO);
+    glBufferData(GL_UNIFORM_BUFFER, sizeof(FrameData), nullptr, GL_DYNAMIC_DRAW);
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+    glBindBufferBase(GL_UNIFORM_BUFFER, BindingPoint, UBO);
+}
+
+void FrameUniforms::Update(const FrameData& data) {
+    glBindBuffer(GL_UNIFORM_BUFFER, UBO);
+    glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(FrameData), &data);
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+}
@@ -0,0 +1,347 @@
+#include "Game.h"
+#include <glad/glad.h>
+#include <glm/gtc/matrix_transform.hpp>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include "imgui.h"
+#include "imgui_impl_opengl3.h"
+#include "stb_image.h"
+#include "TextureCache.h"
+
+namespace {
+
+const uint32_t BoneLayer = 1 << 0;
+const uint32_t ObstacleLayer = 1 << 1;
+const glm::vec3 DogHalfSize(0.5f, 0.4f, 0.8f);
+
+double MillisecondsSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+unsigned int LoadCubemap(const std::vector<std::string> &faces)
+{
+    unsigned int textureID;
+    glGenTextures(1, &textureID);
+    glBindTexture(GL_TEXTURE_CUBE_MAP, textureID);
+
+    int width, height, nrChannels;
+    for (unsigned int i = 0; i < faces.size(); ++i)
+    {
+        unsigned char *data = stbi_load(faces[i].c_str(), &width, &height, &nrChannels, 0);
+        if (data)
+        {
+            GLenum format = nrChannels == 3 ? GL_RGB : GL_RGBA;
+            glTexImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X + i, 0, format, width, height, 0, format, GL_UNSIGNED_BYTE, data);
+            stbi_image_free(data);
+        }
+        else
+        {
+            std::cerr << "Cubemap load failed: " << faces[i] << std::endl;
+        }
+    }
+
+    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
+
+    return textureID;
+}
+
+const float SkyVertices[] = {
+    -1.0f, 1.0f, -1.0f, -1.0f, -1.0f, -1.0f, 1.0f, -1.0f, -1.0f,
+    1.0f, -1.0f, -1.0f, 1.0f, 1.0f, -1.0f, -1.0f, 1.0f, -1.0f,
+    -1.0f, -1.0f, 1.0f, -1.0f, -1.0f, -1.0f, -1.0f, 1.0f, -1.0f,
+    -1.0f, 1.0f, -1.0f, -1.0f, 1.0f, 1.0f, -1.0f, -1.0f, 1.0f,
+    1.0f, -1.0f, -1.0f, 1.0f, -1.0f, 1.0f, 1.0f, 1.0f, 1.0f,
+    1.0f, 1.0f, 1.0f, 1.0f, 1.0f, -1.0f, 1.0f, -1.0f, -1.0f,
+    -1.0f, -1.0f, 1.0f, -1.0f, 1.0f, 1.0f, 1.0f, 1.0f, 1.0f,
+    1.0f, 1.0f, 1.0f, 1.0f, -1.0f, 1.0f, -1.0f, -1.0f, 1.0f,
+    -1.0f, 1.0f, -1.0f, 1.0f, 1.0f, -1.0f, 1.0f, 1.0f, 1.0f,
+    1.0f, 1.0f, 1.0f, -1.0f, 1.0f, 1.0f, -1.0f, 1.0f, -1.0f,
+    -1.0f, -1.0f, -1.0f, -1.0f, -1.0f, 1.0f, 1.0f, -1.0f, -1.0f,
+    1.0f, -1.0f, -1.0f, -1.0f, -1.0f, 1.0f, 1.0f, -1.0f, 1.0f};
+
+}
+
+Game::Game() : camera(glm::vec3(0.0f, 5.0f, 15.0f)) {
+    bonePositions = {
+        {2.0f, 0.2f, -4.0f}, {-3.0f, 0.2f, 2.0f}, {6.0f, 0.2f, -1.0f}, {-1.0f, 0.2f, -6.0f}, {4.0f, 0.2f, 4.0f},
+        {-6.0f, 0.2f, -3.0f}, {1.0f, 0.2f, 7.0f}, {-4.0f, 0.2f, 5.0f}, {7.0f, 0.2f, 1.0f}, {-2.0f, 0.2f, -8.0f}
+    };
+    bonesCollected.assign(BoneCount, false);
+    trashPositions = {
+        {5.0f, 0.0f, -3.0f}, {-2.0f, 0.0f, 4.0f}, {3.0f, 0.0f, 2.0f}, {-5.0f, 0.0f, -1.0f}
+    };
+    previous = current = Snapshot();
+}
+
+void Game::Init(const std::function<std::string(const std::string&)>& resolve) {
+    // --- Load shaders ---
+    modelShader = Shader(resolve("shaders/model.vert").c_str(), resolve("shaders/model.frag").c_str());
+    instancedShader = Shader(resolve("shaders/model_instanced.vert").c_str(), resolve("shaders/model.frag").c_str());
+    skyShader = Shader(resolve("shaders/skybox.vert").c_str(), resolve("shaders/skybox.frag").c_str());
+
+    // per-frame camera/light values live in one uniform buffer shared by all programs
+    frameUniforms.Init();
+    modelShader.bindUniformBlock("FrameData", FrameUniforms::BindingPoint);
+    instancedShader.bindUniformBlock("FrameData", FrameUniforms::BindingPoint);
+    skyShader.bindUniformBlock("FrameData", FrameUniforms::BindingPoint);
+
+    // --- Load models ---
+    player.LoadModel(resolve("assets/models/Dog.fbx"));
+    sceneModel = Model(resolve("assets/models/Trash.fbx"));
+    itemModel = Model(resolve("assets/models/bone.fbx"));
+    TextureCache::PrintStats();
+
+    // --- Setup skybox ---
+    glGenVertexArrays(1, &skyVAO);
+    glGenBuffers(1, &skyVBO);
+    glBindVertexArray(skyVAO);
+    glBindBuffer(GL_ARRAY_BUFFER, skyVBO);
+    glBufferData(GL_ARRAY_BUFFER, sizeof(SkyVertices), SkyVertices, GL_STATIC_DRAW);
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(float), (void *)0);
+    glBindVertexArray(0);
+
+    std::vector<std::string> faces;
+    for (const char *face : {"right", "left", "top", "bottom", "front", "back"})
+        faces.push_back(resolve(std::string("assets/cubemap/") + face + ".png"));
+    cubemapTex = LoadCubemap(faces);
+
+    skyShader.use();
+    skyShader.setInt("skybox", 0);
+
+    // trash cans never move: build their instance data once
+    for (const glm::vec3 &pos : trashPositions)
+    {
+        glm::mat4 sceneM(1.0f);
+        sceneM = glm::translate(sceneM, pos);
+        sceneM = glm::scale(sceneM, glm::vec3(0.025f));
+        trashInstances.push_back({sceneM, glm::vec4(0.25f, 0.25f, 0.27f, 1.0f)});
+    }
+    boneInstances.reserve(bonePositions.size());
+
+    for (size_t i = 0; i < bonePositions.size(); ++i)
+        collisionWorld.Insert(Collision::FromPositionSize(bonePositions[i], glm::vec3(0.3f)), BoneLayer, (uint32_t)i);
+    for (size_t i = 0; i < trashPositions.size(); ++i)
+        collisionWorld.Insert(Collision::FromPositionSize(trashPositions[i], glm::vec3(0.6f, 1.0f, 0.6f)), ObstacleLayer, (uint32_t)i);
+}
+
+void Game::Update(float frameDt, const GameInput& input) {
+    phaseTimes.update = 0.0;
+    phaseTimes.collision = 0.0;
+    phaseTimes.ticks = 0;
+
+    // after a stall this runs several ticks back to back to catch up
+    accumulator += std::min(std::max(frameDt, 0.0f), MaxFrameSeconds);
+    while (accumulator >= TickSeconds) {
+        Tick(input);
+        accumulator -= TickSeconds;
+    }
+    alpha = accumulator / TickSeconds;
+}
+
+void Game::Tick(const GameInput& input) {
+    previous = current;
+
+    auto start = std::chrono::steady_clock::now();
+    glm::vec3 prevPos = player.position;
+    MovePlayer(TickSeconds, input);
+    phaseTimes.update += MillisecondsSince(start);
+
+    start = std::chrono::steady_clock::now();
+    ResolveCollisions(prevPos);
+    phaseTimes.collision += MillisecondsSince(start);
+
+    current = Snapshot();
+    phaseTimes.ticks++;
+}
+
+void Game::MovePlayer(float dt, const GameInput& input) {
+    time += dt;
+    player.Update(dt, input.forward, input.back, input.left, input.right);
+
+    // rotate only while holding R
+    const float rotationSpeedDegPerSec = 240.0f;
+    if (input.spin) {
+        spinAngle += glm::radians(rotationSpeedDegPerSec) * dt;
+        spinAngle = std::fmod(spinAngle, glm::two_pi<float>());
+    }
+}
+
+void Game::ResolveCollisions(const glm::vec3& prevPos) {
+    // Sweep the move against obstacles so the dog slides along them instead of stopping dead
+    glm::vec3 move = player.position - prevPos;
+    player.position = prevPos + collisionWorld.SlideMove(Collision::FromPositionSize(prevPos, DogHalfSize), move, ObstacleLayer);
+
+    // Collect bones the dog touches
+    AABB dogBox = Collision::FromPositionSize(player.position, DogHalfSize);
+    contacts.clear();
+    collisionWorld.QueryOverlap(dogBox, BoneLayer, contacts);
+    for (CollisionWorld::Handle handle : contacts)
+    {
+        bonesCollected[collisionWorld.GetUserData(handle)] = true;
+        collisionWorld.Remove(handle);
+    }
+}
+
+Game::SimState Game::Snapshot() const {
+    return {player.position, player.yaw, spinAngle, time};
+}
+
+Game::SimState Game::Interpolate(const SimState& a, const SimState& b, float alpha) {
+    // spinAngle wraps at 2*pi; blend towards the unwrapped value so it never spins backwards
+    float spinB = b.spinAngle < a.spinAngle ? b.spinAngle + glm::two_pi<float>() : b.spinAngle;
+    SimState out;
+    out.position = glm::mix(a.position, b.position, alpha);
+    out.yaw = glm::mix(a.yaw, b.yaw, alpha);
+    out.spinAngle = glm::mix(a.spinAngle, spinB, alpha);
+    out.time = glm::mix(a.time, b.time, alpha);
+    return out;
+}
+
+void Game::FollowCamera(const SimState& state) {
+    // third-person follow, behind and above the player
+    float rad = glm::radians(state.yaw);
+    glm::vec3 front = glm::vec3(std::cos(rad), 0.0f, std::sin(rad));
+    glm::vec3 camOffset = -front * 8.0f + glm::vec3(0.0f, 3.0f, 0.0f);
+    camera.Position = state.position + camOffset;
+    camera.Front = glm::normalize(state.position - camera.Position);
+}
+
+void Game::Render(int width, int height) {
+    auto start = std::chrono::steady_clock::now();
+    lastShaderStats = Shader::GetFrameStats();
+    Shader::ResetFrameStats();
+
+    // draw where the simulation is between its last two ticks
+    SimState shown = Interpolate(previous, current, alpha);
+    FollowCamera(shown);
+
+    glClearColor(0.1f, 0.1f, 0.12f, 1.0f);
+    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+    glm::mat4 projection = glm::perspective(glm::radians(45.0f),
+                                            (float)width / height, 0.1f, 100.0f);
+    glm::mat4 view = camera.GetViewMatrix();
+
+    FrameData frameData;
+    frameData.projection = projection;
+    frameData.view = view;
+    frameData.viewPos = glm::vec4(camera.Position, 1.0f);
+    frameData.lightPos = glm::vec4(10.0f, 10.0f, 10.0f, 1.0f);
+    frameData.lightColor = glm::vec4(1.0f);
+    frameUniforms.Update(frameData);
+
+    glm::mat4 dogM = Player::ModelMatrix(shown.position, shown.yaw);
+    dogM = glm::rotate(dogM, shown.spinAngle, glm::vec3(0.0f, 1.0f, 0.0f));
+
+    boneInstances.clear();
+    float boneAngle = shown.time * 2.0f;
+    glm::vec3 boneBaseColor = glm::vec3(0.94f, 0.88f, 0.72f);
+    float pulse = (std::sin(shown.time * 2.0f) * 0.5f + 0.5f) * 0.04f;
+    glm::vec4 boneColor = glm::vec4(glm::clamp(boneBaseColor + glm::vec3(pulse), 0.0f, 1.0f), 1.0f);
+    for (int i = 0; i < BoneCount; ++i)
+    {
+        if (!bonesCollected[i])
+        {
+            glm::mat4 itemM(1.0f);
+            itemM = glm::translate(itemM, bonePositions[i]);
+            itemM = glm::scale(itemM, glm::vec3(0.05f));
+            itemM = glm::rotate(itemM, boneAngle, glm::vec3(0, 1, 0));
+            boneInstances.push_back({itemM, boneColor});
+        }
+    }
+
+    // Frustum culling: the dog per mesh, trash cans and bones per instance (whole-model bounds),
+    // all in one SIMD pass; indices follow the Add order below
+    auto cullStart = std::chrono::steady_clock::now();
+    culler.Clear();
+    for (const Mesh &mesh : player.model.meshes)
+        culler.Add(dogM, mesh.bounds);
+    for (const InstanceData &instance : trashInstances)
+        culler.Add(instance.model, sceneModel.bounds);
+    for (const InstanceData &instance : boneInstances)
+        culler.Add(instance.model, itemModel.bounds);
+    culler.Cull(Frustum::FromViewProjection(projection * view));
+    phaseTimes.cull = MillisecondsSince(cullStart);
+
+    // Queue what survived; the queue sorts it and skips redundant program/VAO/texture binds
+    renderQueue.Begin(camera.Position, 100.0f);
+    uint32_t next = 0;
+    for (const Mesh &mesh : player.model.meshes)
+        if (culler.IsVisible(next++))
+            renderQueue.Submit(modelShader, mesh, dogM);
+    visibleInstances.clear();
+    for (const InstanceData &instance : trashInstances)
+        if (culler.IsVisible(next++))
+            visibleInstances.push_back(instance);
+    sceneModel.SubmitInstanced(renderQueue, instancedShader, visibleInstances);
+    visibleInstances.clear();
+    for (const InstanceData &instance : boneInstances)
+        if (culler.IsVisible(next++))
+            visibleInstances.push_back(instance);
+    itemModel.SubmitInstanced(renderQueue, instancedShader, visibleInstances);
+    renderQueue.Flush();
+
+    // Draw skybox
+    glDepthFunc(GL_LEQUAL);
+    skyShader.use();
+    glBindVertexArray(skyVAO);
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_CUBE_MAP, cubemapTex);
+    glDrawArrays(GL_TRIANGLES, 0, 36);
+    glDepthFunc(GL_LESS);
+    phaseTimes.draw = MillisecondsSince(start);
+}
+
+void Game::RenderUi(int width) {
+    auto start = std::chrono::steady_clock::now();
+    ImGui::NewFrame();
+
+    int collectedCount = CollectedCount();
+    ImGui::SetNextWindowPos(ImVec2(width - 200, 10), ImGuiCond_Always);
+    ImGui::SetNextWindowSize(ImVec2(180, 80), ImGuiCond_Always);
+    ImGui::Begin("Score", nullptr, ImGuiWindowFlags_NoResize | ImGuiWindowFlags_NoMove | ImGuiWindowFlags_NoCollapse);
+    ImGui::Text("Bones: %d/%d", collectedCount, BoneCount);
+    if (collectedCount == BoneCount) {
+        ImGui::TextColored(ImVec4(0,1,0,1), "YOU WIN!");
+    }
+    ImGui::End();
+
+    ImGui::SetNextWindowPos(ImVec2(10, 10), ImGuiCond_Always);
+    ImGui::Begin("Stats", nullptr, ImGuiWindowFlags_AlwaysAutoResize | ImGuiWindowFlags_NoMove | ImGuiWindowFlags_NoCollapse);
+    const RenderQueue::Stats &queueStats = renderQueue.GetStats();
+    // the UI's own draws are those of the previous frame; this one's are not built yet
+    ImGui::Text("Draw calls: %u (scene %u, skybox %u, UI %u)", DrawCalls(), queueStats.drawCalls, SkyboxDrawCalls, uiDrawCalls);
+    ImGui::Text("State changes: %u (skipped %u)", queueStats.StateChanges(), queueStats.skippedBinds);
+    ImGui::Text("  program %u, VAO %u, texture %u", queueStats.programBinds, queueStats.vaoBinds, queueStats.textureBinds);
+    ImGui::Text("Uniform calls: %u", lastShaderStats.uniformCalls);
+    ImGui::Text("Location lookups: %u", lastShaderStats.locationQueries);
+    ImGui::Text("Ticks %d, interpolation %.2f", phaseTimes.ticks, alpha);
+    ImGui::Text("Update %.3f ms, collision %.3f ms", phaseTimes.update, phaseTimes.collision);
+    ImGui::Text("Draw %.3f ms (cull %.3f), UI %.3f ms", phaseTimes.draw, phaseTimes.cull, phaseTimes.ui);
+    ImGui::Text("Culling: %u visible, %u culled (%u by box)", culler.GetStats().visible, culler.GetStats().culled, culler.GetStats().boxCulled);
+    ImGui::End();
+
+    ImGui::Render();
+    ImDrawData* drawData = ImGui::GetDrawData();
+    ImGui_ImplOpenGL3_RenderDrawData(drawData);
+    uiDrawCalls = 0;
+    for (int i = 0; i < drawData->CmdListsCount; i++) {
+        uiDrawCalls += (unsigned int)drawData->CmdLists[i]->CmdBuffer.Size;
+    }
+    phaseTimes.ui = MillisecondsSince(start);
+}
+
+int Game::CollectedCount() const {
+    int collectedCount = 0;
+    for (bool collected : bonesCollected) {
+        if (collected) collectedCount++;
+    }
+    return collectedCount;
+}
@@ -0,0 +1,119 @@
+#include "HeadlessContext.h"
+#include <iostream>
+
+#ifdef SIMPLE3D_HAS_EGL
+// keep Xlib (and its None/Status macros) out of this file
+#define EGL_NO_X11
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+#include <cstring>
+
+namespace {
+
+// the default display needs X11/Wayland on some drivers; Mesa's surfaceless platform needs nothing
+EGLDisplay OpenDisplay() {
+    EGLDisplay display = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+    if (display != EGL_NO_DISPLAY && eglInitialize(display, nullptr, nullptr))
+        return display;
+
+    const char* extensions = eglQueryString(EGL_NO_DISPLAY, EGL_EXTENSIONS);
+    if (!extensions || !std::strstr(extensions, "EGL_MESA_platform_surfaceless"))
+        return EGL_NO_DISPLAY;
+    auto getPlatformDisplay = (PFNEGLGETPLATFORMDISPLAYEXTPROC)eglGetProcAddress("eglGetPlatformDisplayEXT");
+    if (!getPlatformDisplay)
+        return EGL_NO_DISPLAY;
+    display = getPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, nullptr);
+    if (display != EGL_NO_DISPLAY && eglInitialize(display, nullptr, nullptr))
+        return display;
+    return EGL_NO_DISPLAY;
+}
+
+}
+
+HeadlessContext::~HeadlessContext() {
+    Destroy();
+}
+
+bool HeadlessContext::Create(int width, int height) {
+    EGLDisplay dpy = OpenDisplay();
+    if (dpy == EGL_NO_DISPLAY) {
+        std::cerr << "HeadlessContext: no EGL display" << std::endl;
+        return false;
+    }
+    display = dpy;
+
+    const EGLint configAttribs[] = {
+        EGL_SURFACE_TYPE, EGL_PBUFFER_BIT,
+        EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT,
+        EGL_RED_SIZE, 8, EGL_GREEN_SIZE, 8, EGL_BLUE_SIZE, 8, EGL_ALPHA_SIZE, 8,
+        EGL_DEPTH_SIZE, 24,
+        EGL_NONE};
+    EGLConfig config;
+    EGLint configCount = 0;
+    if (!eglChooseConfig(dpy, configAttribs, &config, 1, &configCount) || configCount == 0) {
+        std::cerr << "HeadlessContext: no pbuffer-capable OpenGL config" << std::endl;
+        Destroy();
+        return false;
+    }
+
+    const EGLint surfaceAttribs[] = {EGL_WIDTH, width, EGL_HEIGHT, height, EGL_NONE};
+    EGLSurface pbuffer = eglCreatePbufferSurface(dpy, config, surfaceAttribs);
+    if (pbuffer == EGL_NO_SURFACE) {
+        std::cerr << "HeadlessContext: eglCreatePbufferSurface failed" << std::endl;
+        Destroy();
+        return false;
+    }
+    surface = pbuffer;
+
+    eglBindAPI(EGL_OPENGL_API);
+    const EGLint contextAttribs[] = {
+        EGL_CONTEXT_MAJOR_VERSION, 3,
+        EGL_CONTEXT_MINOR_VERSION, 3,
+        EGL_CONTEXT_OPENGL_PROFILE_MASK, EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT,
+        EGL_NONE};
+    EGLContext ctx = eglCreateContext(dpy, config, EGL_NO_CONTEXT, contextAttribs);
+    if (ctx == EGL_NO_CONTEXT) {
+        std::cerr << "HeadlessContext: cannot create an OpenGL 3.3 core context" << std::endl;
+        Destroy();
+        return false;
+    }
+    context = ctx;
+
+    if (!eglMakeCurrent(dpy, pbuffer, pbuffer, ctx)) {
+        std::cerr << "HeadlessContext: eglMakeCurrent failed" << std::endl;
+        Destroy();
+        return false;
+    }
+    return true;
+}
+
+void HeadlessContext::Destroy() {
+    if (!display)
+        return;
+    eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+    if (context) eglDestroyContext(display, context);
+    if (surface) eglDestroySurface(display, surface);
+    eglTerminate(display);
+    display = surface = context = nullptr;
+}
+
+void* HeadlessContext::GetProcAddress(const char* name) {
+    return (void*)eglGetProcAddress(name);
+}
+
+#else
+
+HeadlessContext::~HeadlessContext() {}
+
+bool HeadlessContext::Create(int, int) {
+    std::cerr << "HeadlessContext: built without EGL" << std::endl;
+    return false;
+}
+
+void HeadlessContext::Destroy() {}
+
+void* HeadlessContext::GetProcAddress(const char*) {
+    return nullptr;
+}
+
+#endif
@@ -1,21 +1,61 @@
 #include "Mesh.h"
 #include <glad/glad.h>
+#include <algorithm>
+#include <cmath>
+#include <utility>
 
-Mesh::Mesh(std::vector<Vertex> vertices, std::vector<unsigned int> indices, std::vector<Texture> textures)
-    : vertices(vertices), indices(indices), textures(textures) {
-    setupMesh();
+MeshBounds MeshBounds::FromVertices(const Vertex* vertices, size_t count) {
+    MeshBounds b;
+    if (count == 0)
+        return b;
+    b.min = b.max = vertices[0].Position;
+    for (size_t i = 1; i < count; i++) {
+        b.min = glm::min(b.min, vertices[i].Position);
+        b.max = glm::max(b.max, vertices[i].Position);
+    }
+    b.center = (b.min + b.max) * 0.5f;
+    float radius2 = 0.0f;
+    for (size_t i = 0; i < count; i++) {
+        glm::vec3 d = vertices[i].Position - b.center;
+        radius2 = std::max(radius2, glm::dot(d, d));
+    }
+    b.radius = std::sqrt(radius2);
+    return b;
 }
 
-void Mesh::setupMesh() {
+MeshBounds MeshBounds::Merge(const MeshBounds& a, const MeshBounds& b) {
+    MeshBounds m;
+    m.min = glm::min(a.min, b.min);
+    m.max = glm::max(a.max, b.max);
+    m.center = (m.min + m.max) * 0.5f;
+    m.radius = std::max(glm::length(a.center - m.center) + a.radius, glm::length(b.center - m.center) + b.radius);
+    return m;
+}
+
+Mesh::Mesh(std::vector<Vertex> vertices, std::vector<unsigned int> indices, std::vector<Texture> textures, const MeshBounds* bounds)
+    : vertices(std::move(vertices)), indices(std::move(indices)), textures(std::move(textures)) {
+    this->bounds = bounds ? *bounds : MeshBounds::FromVertices(this->vertices.data(), this->vertices.size());
+    setupMesh(this->vertices.data(), this->vertices.size(), this->indices.data(), this->indices.size());
+}
+
+Mesh::Mesh(const Vertex* vertexData, size_t vertexCount, const unsigned int* indexData, size_t indexCount, std::vector<Texture> textures, const MeshBounds* bounds)
+    : textures(std::move(textures)) {
+    this->bounds = bounds ? *bounds : MeshBounds::FromVertices(vertexData, vertexCount);
+    setupMesh(vertexData, vertexCount, indexData, indexCount);
+}
+
+void Mesh::setupMesh(const Vertex* vertexData, size_t vertexCount, const unsigned int* indexData, size_t indexCount) {
+    this->indexCount = static_cast<unsigned int>(indexCount);
+
     glGenVertexArrays(1, &VAO);
     glGenBuffers(1, &VBO);
     glGenBuffers(1, &EBO);
 
     glBindVertexArray(VAO);
     glBindBuffer(GL_ARRAY_BUFFER, VBO);
-    glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(Vertex), &vertices[0], GL_STATIC_DRAW);
+    glBufferData(GL_ARRAY_BUFFER, vertexCount * sizeof(Vertex), vertexData, GL_STATIC_DRAW);
     glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(unsigned int), &indices[0], GL_STATIC_DRAW);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, indexCount * sizeof(unsigned int), indexData, GL_STATIC_DRAW);
 
     glEnableVertexAttribArray(0);
     glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)0);
@@ -28,21 +68,44 @@ void Mesh::setupMesh() {
 }
 
 void Mesh::Draw() {
-    unsigned int diffuseNr = 1;
-    unsigned int specularNr = 1;
-
     for (unsigned int i = 0; i < textures.size(); i++) {
         glActiveTexture(GL_TEXTURE0 + i);
-        std::string name = textures[i].type;
-        if (name == "texture_diffuse")
-            name += std::to_string(diffuseNr++);
-        else if (name == "texture_specular")
-            name += std::to_string(specularNr++);
         glBindTexture(GL_TEXTURE_2D, textures[i].id);
     }
-
     glBindVertexArray(VAO);
-    glDrawElements(GL_TRIANGLES, static_cast<unsigned int>(indices.size()), GL_UNSIGNED_INT, 0);
+    glDrawElements(GL_TRIANGLES, indexCount, GL_UNSIGNED_INT, 0);
+}
+
+unsigned int Mesh::InstanceVAO(unsigned int instanceVBO) {
+    if (instanceVAO != 0 && instanceSource == instanceVBO)
+        return instanceVAO;
+
+    if (instanceVAO == 0) {
+        glGenVertexArrays(1, &instanceVAO);
+        glBindVertexArray(instanceVAO);
+        glBindBuffer(GL_ARRAY_BUFFER, VBO);
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
+        glEnableVertexAttribArray(0);
+        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)0);
+        glEnableVertexAttribArray(1);
+        glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, Normal));
+        glEnableVertexAttribArray(2);
+        glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, TexCoords));
+    } else {
+        glBindVertexArray(instanceVAO);
+    }
+
+    glBindBuffer(GL_ARRAY_BUFFER, instanceVBO);
+    for (unsigned int column = 0; column < 4; column++) {
+        glEnableVertexAttribArray(3 + column);
+        glVertexAttribPointer(3 + column, 4, GL_FLOAT, GL_FALSE, sizeof(InstanceData), (void*)(offsetof(InstanceData, model) + column * sizeof(glm::vec4)));
+        glVertexAttribDivisor(3 + column, 1);
+    }
+    glEnableVertexAttribArray(7);
+    glVertexAttribPointer(7, 4, GL_FLOAT, GL_FALSE, sizeof(InstanceData), (void*)offsetof(InstanceData, color));
+    glVertexAttribDivisor(7, 1);
+    instanceSource = instanceVBO;
+
     glBindVertexArray(0);
-    glActiveTexture(GL_TEXTURE0);
+    return instanceVAO;
 }
@@ -0,0 +1,267 @@
+#include "MeshCache.h"
+#include <cstring>
+#include <fstream>
+#include <filesystem>
+#include <iostream>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+struct FileHeader {
+    char magic[4];
+    uint32_t version;
+    uint64_t key;
+    uint32_t meshCount;
+    uint32_t vertexSize;
+};
+
+struct MeshHeader {
+    uint32_t vertexCount;
+    uint32_t indexCount;
+    uint32_t textureCount;
+    float boundsMin[3];
+    float boundsMax[3];
+    float sphere[4]; // center xyz, radius
+};
+
+const char Magic[4] = {'S', '3', 'D', 'M'};
+
+uint64_t Fnv1a(const unsigned char* data, size_t size, uint64_t hash = 14695981039346656037ull) {
+    for (size_t i = 0; i < size; i++) {
+        hash ^= data[i];
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+size_t Padding(size_t size) {
+    return (4 - (size & 3)) & 3;
+}
+
+// bounds-checked cursor over the mapped file
+struct Reader {
+    const unsigned char* pos;
+    const unsigned char* end;
+
+    const unsigned char* Take(size_t size) {
+        if (size > (size_t)(end - pos)) return nullptr;
+        const unsigned char* p = pos;
+        pos += size;
+        return p;
+    }
+    template <typename T>
+    bool Read(T& out) {
+        const unsigned char* p = Take(sizeof(T));
+        if (!p) return false;
+        std::memcpy(&out, p, sizeof(T));
+        return true;
+    }
+};
+
+}
+
+MeshCache::~MeshCache() {
+    Close();
+}
+
+std::string MeshCache::PathFor(const std::string& sourcePath) {
+    return sourcePath + ".meshcache";
+}
+
+uint64_t MeshCache::ComputeKey(const std::string& sourcePath, unsigned int importFlags) {
+    MappedFile source;
+    if (!MapFile(sourcePath, source))
+        return 0;
+    uint64_t hash = Fnv1a(source.data, source.size);
+    UnmapFile(source);
+
+    uint32_t salt[2] = {importFlags, Version};
+    hash = Fnv1a(reinterpret_cast<const unsigned char*>(salt), sizeof(salt), hash);
+    return hash ? hash : 1;
+}
+
+bool MeshCache::Write(const std::string& cachePath, uint64_t key, const std::vector<MeshData>& meshes) {
+    // write to a temp file and rename so a crash never leaves a truncated cache behind
+    std::string tmpPath = cachePath + ".tmp";
+    {
+        std::ofstream out(tmpPath, std::ios::binary | std::ios::trunc);
+        if (!out) {
+            std::cerr << "MeshCache: cannot write " << tmpPath << std::endl;
+            return false;
+        }
+
+        FileHeader header;
+        std::memcpy(header.magic, Magic, sizeof(Magic));
+        header.version = Version;
+        header.key = key;
+        header.meshCount = (uint32_t)meshes.size();
+        header.vertexSize = (uint32_t)sizeof(Vertex);
+        out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+        const char zeros[4] = {0, 0, 0, 0};
+        for (const MeshData& mesh : meshes) {
+            MeshHeader mh;
+            mh.vertexCount = (uint32_t)mesh.vertices.size();
+            mh.indexCount = (uint32_t)mesh.indices.size();
+            mh.textureCount = (uint32_t)mesh.textures.size();
+            for (int axis = 0; axis < 3; axis++) {
+                mh.boundsMin[axis] = mesh.bounds.min[axis];
+                mh.boundsMax[axis] = mesh.bounds.max[axis];
+                mh.sphere[axis] = mesh.bounds.center[axis];
+            }
+            mh.sphere[3] = mesh.bounds.radius;
+            out.write(reinterpret_cast<const char*>(&mh), sizeof(mh));
+            out.write(reinterpret_cast<const char*>(mesh.vertices.data()), mesh.vertices.size() * sizeof(Vertex));
+            out.write(reinterpret_cast<const char*>(mesh.indices.data()), mesh.indices.size() * sizeof(unsigned int));
+            for (const TextureRef& tex : mesh.textures) {
+                uint32_t lengths[2] = {(uint32_t)tex.type.size(), (uint32_t)tex.path.size()};
+                out.write(reinterpret_cast<const char*>(lengths), sizeof(lengths));
+                out.write(tex.type.data(), tex.type.size());
+                out.write(tex.path.data(), tex.path.size());
+                out.write(zeros, Padding(tex.type.size() + tex.path.size()));
+            }
+        }
+        if (!out) {
+            std::cerr << "MeshCache: failed writing " << tmpPath << std::endl;
+            return false;
+        }
+    }
+
+    std::error_code ec;
+    std::filesystem::rename(tmpPath, cachePath, ec);
+    if (ec) {
+        std::cerr << "MeshCache: cannot move " << tmpPath << " to " << cachePath << ": " << ec.message() << std::endl;
+        std::filesystem::remove(tmpPath, ec);
+        return false;
+    }
+    return true;
+}
+
+bool MeshCache::Open(const std::string& cachePath, uint64_t key) {
+    Close();
+    if (!MapFile(cachePath, mapped))
+        return false;
+
+    Reader reader = {mapped.data, mapped.data + mapped.size};
+    FileHeader header;
+    if (!reader.Read(header) || std::memcmp(header.magic, Magic, sizeof(Magic)) != 0 ||
+        header.version != Version || header.key != key || header.vertexSize != sizeof(Vertex)) {
+        Close();
+        return false;
+    }
+
+    meshes.reserve(header.meshCount);
+    for (uint32_t m = 0; m < header.meshCount; m++) {
+        MeshHeader mh;
+        if (!reader.Read(mh)) break;
+
+        CachedMesh mesh;
+        mesh.vertexCount = mh.vertexCount;
+        mesh.indexCount = mh.indexCount;
+        mesh.bounds.min = glm::vec3(mh.boundsMin[0], mh.boundsMin[1], mh.boundsMin[2]);
+        mesh.bounds.max = glm::vec3(mh.boundsMax[0], mh.boundsMax[1], mh.boundsMax[2]);
+        mesh.bounds.center = glm::vec3(mh.sphere[0], mh.sphere[1], mh.sphere[2]);
+        mesh.bounds.radius = mh.sphere[3];
+        mesh.vertices = reinterpret_cast<const Vertex*>(reader.Take((size_t)mh.vertexCount * sizeof(Vertex)));
+        mesh.indices = reinterpret_cast<const unsigned int*>(reader.Take((size_t)mh.indexCount * sizeof(unsigned int)));
+        if ((mh.vertexCount && !mesh.vertices) || (mh.indexCount && !mesh.indices)) break;
+
+        bool ok = true;
+        for (uint32_t t = 0; t < mh.textureCount && ok; t++) {
+            uint32_t lengths[2];
+            const unsigned char* chars = nullptr;
+            ok = reader.Read(lengths) &&
+                 (chars = reader.Take((size_t)lengths[0] + lengths[1])) != nullptr &&
+                 reader.Take(Padding((size_t)lengths[0] + lengths[1])) != nullptr;
+            if (ok) {
+                const char* text = reinterpret_cast<const char*>(chars);
+                mesh.textures.push_back({std::string(text, lengths[0]), std::string(text + lengths[0], lengths[1])});
+            }
+        }
+        if (!ok) break;
+        meshes.push_back(std::move(mesh));
+    }
+
+    if (meshes.size() != header.meshCount) {
+        std::cerr << "MeshCache: " << cachePath << " is truncated, ignoring it" << std::endl;
+        Close();
+        return false;
+    }
+    return true;
+}
+
+void MeshCache::Close() {
+    meshes.clear();
+    UnmapFile(mapped);
+}
+
+#ifdef _WIN32
+
+bool MeshCache::MapFile(const std::string& path, MappedFile& out) {
+    HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (file == INVALID_HANDLE_VALUE)
+        return false;
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(file, &size) || size.QuadPart == 0) {
+        CloseHandle(file);
+        return false;
+    }
+    HANDLE mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+    if (!mapping) {
+        CloseHandle(file);
+        return false;
+    }
+    void* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    if (!view) {
+        CloseHandle(mapping);
+        CloseHandle(file);
+        return false;
+    }
+    out.data = static_cast<const unsigned char*>(view);
+    out.size = (size_t)size.QuadPart;
+    out.file = file;
+    out.mapping = mapping;
+    return true;
+}
+
+void MeshCache::UnmapFile(MappedFile& file) {
+    if (file.data) UnmapViewOfFile(file.data);
+    if (file.mapping) CloseHandle(file.mapping);
+    if (file.file) CloseHandle(file.file);
+    file = MappedFile();
+}
+
+#else
+
+bool MeshCache::MapFile(const std::string& path, MappedFile& out) {
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+        return false;
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size == 0) {
+        close(fd);
+        return false;
+    }
+    void* view = mmap(nullptr, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (view == MAP_FAILED)
+        return false;
+    out.data = static_cast<const unsigned char*>(view);
+    out.size = (size_t)st.st_size;
+    return true;
+}
+
+void MeshCache::UnmapFile(MappedFile& file) {
+    if (file.data) munmap(const_cast<unsigned char*>(file.data), file.size);
+    file = MappedFile();
+}
+
+#endif
@@ -1,80 +1,35 @@
 #include "Model.h"
+#include "MeshCache.h"
+#include "TextureCache.h"
+#include "ThreadPool.h"
 #include <assimp/Importer.hpp>
 #include <assimp/scene.h>
 #include <assimp/postprocess.h>
-#include "stb_image.h"
 #include <iostream>
 
-// --- internal struct ---
-struct TextureData {
-    unsigned int id;
-    std::string type;
-    std::string path;
-};
-
-// --- helper to load texture ---
-unsigned int TextureFromFile(const char* path, const std::string& directory) {
-    std::string filename = std::string(path);
-    std::string fullPath = "assets/textures/" + filename;
-
-    unsigned int textureID;
-    glGenTextures(1, &textureID);
-
-    int width, height, nrComponents;
-    unsigned char* data = stbi_load(fullPath.c_str(), &width, &height, &nrComponents, 0);
-    if (data) {
-        GLenum format = GL_RGB;
-        if (nrComponents == 1)
-            format = GL_RED;
-        else if (nrComponents == 3)
-            format = GL_RGB;
-        else if (nrComponents == 4)
-            format = GL_RGBA;
-
-        glBindTexture(GL_TEXTURE_2D, textureID);
-        glTexImage2D(GL_TEXTURE_2D, 0, format, width, height, 0, format, GL_UNSIGNED_BYTE, data);
-        glGenerateMipmap(GL_TEXTURE_2D);
-
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-
-        stbi_image_free(data);
-    } else {
-        // Try fallback: model directory + filename
-        std::string fallbackPath = directory + "/" + filename;
-        data = stbi_load(fallbackPath.c_str(), &width, &height, &nrComponents, 0);
-        if (data) {
-            GLenum format = GL_RGB;
-            if (nrComponents == 1) format = GL_RED;
-            else if (nrComponents == 3) format = GL_RGB;
-            else if (nrComponents == 4) format = GL_RGBA;
-
-            glBindTexture(GL_TEXTURE_2D, textureID);
-            glTexImage2D(GL_TEXTURE_2D, 0, format, width, height, 0, format, GL_UNSIGNED_BYTE, data);
-            glGenerateMipmap(GL_TEXTURE_2D);
-            
-            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
-            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-            
-            stbi_image_free(data);
-        } else {
-            std::cerr << "Texture failed to load at both paths: " << fullPath << " and " << fallbackPath << std::endl;
-            stbi_image_free(data);
-        }
-    }
+const unsigned int Model::ImportFlags = aiProcess_Triangulate | aiProcess_FlipUVs | aiProcess_GenNormals;
 
-    return textureID;
+// texture references (diffuse first, then specular); GL textures are created later
+void collectTextureRefs(const aiMesh* mesh, const aiScene* scene, std::vector<TextureRef>& textures) {
+    if (mesh->mMaterialIndex >= 0) {
+        aiMaterial* material = scene->mMaterials[mesh->mMaterialIndex];
+        auto collectTextures = [&](aiTextureType type, const std::string& typeName) {
+            for (unsigned int i = 0; i < material->GetTextureCount(type); i++) {
+                aiString str;
+                material->GetTexture(type, i, &str);
+                textures.push_back({typeName, str.C_Str()});
+            }
+        };
+        collectTextures(aiTextureType_DIFFUSE, "texture_diffuse");
+        collectTextures(aiTextureType_SPECULAR, "texture_specular");
+    }
 }
 
 // --- process mesh ---
-Mesh processMesh(aiMesh* mesh, const aiScene* scene, const std::string& directory) {
-    std::vector<Vertex> vertices;
-    std::vector<unsigned int> indices;
-    std::vector<TextureData> textures;
+MeshData processMesh(aiMesh* mesh, const aiScene* scene) {
+    MeshData data;
+    std::vector<Vertex>& vertices = data.vertices;
+    std::vector<unsigned int>& indices = data.indices;
 
     // vertices
     for (unsigned int i = 0; i < mesh->mNumVertices; i++) {
@@ -95,67 +50,175 @@ Mesh processMesh(aiMesh* mesh, const aiScene* scene, const std::string& director
             indices.push_back(face.mIndices[j]);
     }
 
-    // textures
-    if (mesh->mMaterialIndex >= 0) {
-        aiMaterial* material = scene->mMaterials[mesh->mMaterialIndex];
-        std::vector<TextureData> diffuseMaps;
-        std::vector<TextureData> specularMaps;
-
-        auto loadMaterialTextures = [&](aiTextureType type, const std::string& typeName) {
-            std::vector<TextureData> mats;
-            for (unsigned int i = 0; i < material->GetTextureCount(type); i++) {
-                aiString str;
-                material->GetTexture(type, i, &str);
-                TextureData tex;
-                tex.id = TextureFromFile(str.C_Str(), directory);
-                tex.type = typeName;
-                tex.path = str.C_Str();
-                mats.push_back(tex);
-            }
-            return mats;
-        };
-
-        diffuseMaps = loadMaterialTextures(aiTextureType_DIFFUSE, "texture_diffuse");
-        specularMaps = loadMaterialTextures(aiTextureType_SPECULAR, "texture_specular");
+    data.bounds = MeshBounds::FromVertices(vertices.data(), vertices.size());
+    collectTextureRefs(mesh, scene, data.textures);
+    return data;
+}
 
-        textures.insert(textures.end(), diffuseMaps.begin(), diffuseMaps.end());
-        textures.insert(textures.end(), specularMaps.begin(), specularMaps.end());
+// --- process node ---
+void processNode(aiNode* node, const aiScene* scene, std::vector<MeshData>& meshes) {
+    for (unsigned int i = 0; i < node->mNumMeshes; i++) {
+        aiMesh* mesh = scene->mMeshes[node->mMeshes[i]];
+        meshes.push_back(processMesh(mesh, scene));
     }
+    for (unsigned int i = 0; i < node->mNumChildren; i++) {
+        processNode(node->mChildren[i], scene, meshes);
+    }
+}
 
-    // convert TextureData -> Mesh::Texture
-    std::vector<Mesh::Texture> meshTextures;
-    for (auto& t : textures) {
-        meshTextures.push_back({t.id, t.type});
+// --- parallel conversion ---
+// same output as processMesh, but written into buffers sized up front; safe to run on a worker
+void processMeshInto(const aiMesh* mesh, const aiScene* scene, MeshData& data) {
+    const unsigned int vertexCount = mesh->mNumVertices;
+    data.vertices.resize(vertexCount);
+    Vertex* vertices = data.vertices.data();
+    const aiVector3D* texCoords = mesh->mTextureCoords[0];
+    for (unsigned int i = 0; i < vertexCount; i++) {
+        const aiVector3D& p = mesh->mVertices[i];
+        vertices[i].Position = glm::vec3(p.x, p.y, p.z);
+    }
+    if (mesh->HasNormals()) {
+        for (unsigned int i = 0; i < vertexCount; i++) {
+            const aiVector3D& n = mesh->mNormals[i];
+            vertices[i].Normal = glm::vec3(n.x, n.y, n.z);
+        }
+    } else {
+        for (unsigned int i = 0; i < vertexCount; i++)
+            vertices[i].Normal = glm::vec3(0);
+    }
+    for (unsigned int i = 0; i < vertexCount; i++)
+        vertices[i].TexCoords = texCoords ? glm::vec2(texCoords[i].x, texCoords[i].y) : glm::vec2(0.0f, 0.0f);
+
+    size_t indexCount = 0;
+    for (unsigned int i = 0; i < mesh->mNumFaces; i++)
+        indexCount += mesh->mFaces[i].mNumIndices;
+    data.indices.resize(indexCount);
+    unsigned int* indices = data.indices.data();
+    for (unsigned int i = 0; i < mesh->mNumFaces; i++) {
+        const aiFace& face = mesh->mFaces[i];
+        for (unsigned int j = 0; j < face.mNumIndices; j++)
+            *indices++ = face.mIndices[j];
     }
 
-    return Mesh(vertices, indices, meshTextures);
+    data.bounds = MeshBounds::FromVertices(vertices, vertexCount);
+    collectTextureRefs(mesh, scene, data.textures);
 }
 
-// --- process node ---
-void processNode(aiNode* node, const aiScene* scene, std::vector<Mesh>& meshes, const std::string& directory) {
-    for (unsigned int i = 0; i < node->mNumMeshes; i++) {
-        aiMesh* mesh = scene->mMeshes[node->mMeshes[i]];
-        meshes.push_back(processMesh(mesh, scene, directory));
+// flattens the node walk so every mesh gets a fixed output slot in processNode order
+void gatherMeshes(const aiNode* node, const aiScene* scene, std::vector<const aiMesh*>& out) {
+    for (unsigned int i = 0; i < node->mNumMeshes; i++)
+        out.push_back(scene->mMeshes[node->mMeshes[i]]);
+    for (unsigned int i = 0; i < node->mNumChildren; i++)
+        gatherMeshes(node->mChildren[i], scene, out);
+}
+
+std::vector<MeshData> Model::ConvertScene(const aiScene* scene, LoadMode mode) {
+    std::vector<MeshData> data;
+    if (mode == LoadMode::Serial) {
+        processNode(scene->mRootNode, scene, data);
+        return data;
     }
-    for (unsigned int i = 0; i < node->mNumChildren; i++) {
-        processNode(node->mChildren[i], scene, meshes, directory);
+
+    std::vector<const aiMesh*> sceneMeshes;
+    gatherMeshes(scene->mRootNode, scene, sceneMeshes);
+    data.resize(sceneMeshes.size());
+    ThreadPool::Shared().ParallelFor(sceneMeshes.size(), [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++)
+            processMeshInto(sceneMeshes[i], scene, data[i]);
+    });
+    return data;
+}
+
+// resolve the texture references of every mesh in one TextureCache batch so decodes run in parallel
+template <typename MeshList>
+std::vector<std::vector<Mesh::Texture>> loadTextures(const MeshList& meshList, const std::string& directory) {
+    std::vector<std::string> files;
+    for (const auto& mesh : meshList)
+        for (const TextureRef& ref : mesh.textures)
+            files.push_back(ref.path);
+    std::vector<unsigned int> ids = TextureCache::Acquire(files, directory);
+
+    std::vector<std::vector<Mesh::Texture>> textures;
+    size_t next = 0;
+    for (const auto& mesh : meshList) {
+        textures.emplace_back();
+        for (const TextureRef& ref : mesh.textures)
+            textures.back().push_back({ids[next++], ref.type});
     }
+    return textures;
 }
 
 // --- constructor ---
-Model::Model(const std::string& path) {
+Model::Model(const std::string& path, LoadMode mode) {
+    directory = path.substr(0, path.find_last_of('/'));
+
+    // warm path: baked cache is still valid for this file + flags, skip Assimp entirely
+    std::string cachePath = MeshCache::PathFor(path);
+    uint64_t cacheKey = MeshCache::ComputeKey(path, ImportFlags);
+    MeshCache cache;
+    if (cacheKey != 0 && cache.Open(cachePath, cacheKey)) {
+        std::vector<std::vector<Mesh::Texture>> textures = loadTextures(cache.Meshes(), directory);
+        for (size_t i = 0; i < cache.Meshes().size(); i++) {
+            const auto& m = cache.Meshes()[i];
+            meshes.emplace_back(m.vertices, m.vertexCount, m.indices, m.indexCount, std::move(textures[i]), &m.bounds);
+        }
+        computeBounds();
+        return;
+    }
+
     Assimp::Importer importer;
-    const aiScene* scene = importer.ReadFile(path, aiProcess_Triangulate | aiProcess_FlipUVs | aiProcess_GenNormals);
+    const aiScene* scene = importer.ReadFile(path, ImportFlags);
     if (!scene || !scene->mRootNode) {
         std::cerr << "ERROR::ASSIMP::" << importer.GetErrorString() << std::endl;
         return;
     }
 
-    directory = path.substr(0, path.find_last_of('/'));
-    processNode(scene->mRootNode, scene, meshes, directory);
+    // CPU conversion (possibly on workers) fills the upload queue; GL objects are created below on this thread
+    std::vector<MeshData> data = ConvertScene(scene, mode);
+    if (cacheKey != 0)
+        MeshCache::Write(cachePath, cacheKey, data);
+
+    std::vector<std::vector<Mesh::Texture>> textures = loadTextures(data, directory);
+    for (size_t i = 0; i < data.size(); i++)
+        meshes.emplace_back(std::move(data[i].vertices), std::move(data[i].indices), std::move(textures[i]), &data[i].bounds);
+    computeBounds();
+}
+
+void Model::computeBounds() {
+    if (meshes.empty())
+        return;
+    bounds = meshes[0].bounds;
+    for (size_t i = 1; i < meshes.size(); i++)
+        bounds = MeshBounds::Merge(bounds, meshes[i].bounds);
 }
 
 void Model::Draw() {
     for (auto& mesh : meshes)
         mesh.Draw();
 }
+
+void Model::Submit(RenderQueue& queue, Shader& shader, const glm::mat4& model, const glm::vec4& color) {
+    for (const auto& mesh : meshes)
+        queue.Submit(shader, mesh, model, color);
+}
+
+void Model::SubmitInstanced(RenderQueue& queue, Shader& shader, const std::vector<InstanceData>& instances) {
+    if (instances.empty())
+        return;
+
+    if (instanceVBO == 0)
+        glGenBuffers(1, &instanceVBO);
+    glBindBuffer(GL_ARRAY_BUFFER, instanceVBO);
+    if (instances.size() > instanceCapacity) {
+        instanceCapacity = instances.size();
+        glBufferData(GL_ARRAY_BUFFER, instanceCapacity * sizeof(InstanceData), instances.data(), GL_STREAM_DRAW);
+    } else {
+        // orphan last frame's storage so the driver doesn't stall on in-flight draws
+        glBufferData(GL_ARRAY_BUFFER, instanceCapacity * sizeof(InstanceData), nullptr, GL_STREAM_DRAW);
+        glBufferSubData(GL_ARRAY_BUFFER, 0, instances.size() * sizeof(InstanceData), instances.data());
+    }
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    for (auto& mesh : meshes)
+        queue.SubmitInstanced(shader, mesh, mesh.InstanceVAO(instanceVBO), (unsigned int)instances.size());
+}
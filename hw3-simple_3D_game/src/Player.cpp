@@ -33,6 +33,10 @@ void Player::Update(float dt, bool forward, bool back, bool left, bool right) {
 }
 
 glm::mat4 Player::GetModelMatrix() const {
+    return ModelMatrix(position, yaw);
+}
+
+glm::mat4 Player::ModelMatrix(const glm::vec3& position, float yaw) {
     glm::mat4 m(1.0f);
     m = glm::translate(m, position);
     m = glm::rotate(m, glm::radians(-yaw-90.0f), glm::vec3(0,1,0)); // orientation fix
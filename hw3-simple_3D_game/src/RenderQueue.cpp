@@ -0,0 +1,117 @@
+#include "RenderQueue.h"
+#include <glad/glad.h>
+#include <algorithm>
+
+namespace {
+
+const uint32_t MaxDepth = (1u << 24) - 1;
+
+}
+
+uint64_t RenderQueue::MakeKey(unsigned int program, unsigned int material, unsigned int vao, uint32_t depth) {
+    // GL names are small integers in practice; masking only affects grouping, never correctness
+    return ((uint64_t)(program & 0xFF) << 56) |
+           ((uint64_t)(material & 0xFFFF) << 40) |
+           ((uint64_t)(vao & 0xFFFF) << 24) |
+           (uint64_t)(depth & MaxDepth);
+}
+
+void RenderQueue::Begin(const glm::vec3& cameraPos, float farPlane) {
+    this->cameraPos = cameraPos;
+    depthScale = farPlane > 0.0f ? (float)MaxDepth / farPlane : 0.0f;
+    items.clear();
+    order.clear();
+}
+
+uint32_t RenderQueue::QuantiseDepth(const glm::mat4& model) const {
+    float depth = glm::length(glm::vec3(model[3]) - cameraPos) * depthScale;
+    return depth >= (float)MaxDepth ? MaxDepth : (uint32_t)depth;
+}
+
+void RenderQueue::Submit(Shader& shader, const Mesh& mesh, const glm::mat4& model, const glm::vec4& color) {
+    order.push_back({MakeKey(shader.ID, mesh.GetMaterialId(), mesh.GetVAO(), QuantiseDepth(model)), (uint32_t)items.size()});
+    items.push_back({&shader, &mesh, mesh.GetVAO(), 0, model, color});
+}
+
+void RenderQueue::SubmitInstanced(Shader& shader, const Mesh& mesh, unsigned int vao, unsigned int instanceCount) {
+    if (instanceCount == 0)
+        return;
+    order.push_back({MakeKey(shader.ID, mesh.GetMaterialId(), vao, 0), (uint32_t)items.size()});
+    items.push_back({&shader, &mesh, vao, instanceCount, glm::mat4(1.0f), glm::vec4(0.0f)});
+}
+
+void RenderQueue::Flush() {
+    stats = Stats();
+    stats.items = (unsigned int)items.size();
+    std::sort(order.begin(), order.end(), [](const SortEntry& a, const SortEntry& b) { return a.key < b.key; });
+
+    // nothing is assumed about the state left by code outside the queue
+    Shader* currentShader = nullptr;
+    unsigned int currentVAO = ~0u;
+    unsigned int activeUnit = ~0u;
+    unsigned int boundTextures[MaxTextureUnits];
+    std::fill(boundTextures, boundTextures + MaxTextureUnits, ~0u);
+    // object color uniforms of the current program; -1 / false = not known yet
+    int currentUseColor = -1;
+    bool colorKnown = false;
+    glm::vec3 currentColor(0.0f);
+
+    for (const SortEntry& entry : order) {
+        const Item& item = items[entry.item];
+
+        if (item.shader != currentShader) {
+            item.shader->use();
+            currentShader = item.shader;
+            currentUseColor = -1;
+            colorKnown = false;
+            stats.programBinds++;
+        } else {
+            stats.skippedBinds++;
+        }
+
+        if (item.vao != currentVAO) {
+            glBindVertexArray(item.vao);
+            currentVAO = item.vao;
+            stats.vaoBinds++;
+        } else {
+            stats.skippedBinds++;
+        }
+
+        const std::vector<Mesh::Texture>& textures = item.mesh->textures;
+        for (unsigned int unit = 0; unit < textures.size() && unit < MaxTextureUnits; unit++) {
+            if (boundTextures[unit] == textures[unit].id) {
+                stats.skippedBinds++;
+                continue;
+            }
+            if (activeUnit != unit) {
+                glActiveTexture(GL_TEXTURE0 + unit);
+                activeUnit = unit;
+            }
+            glBindTexture(GL_TEXTURE_2D, textures[unit].id);
+            boundTextures[unit] = textures[unit].id;
+            stats.textureBinds++;
+        }
+
+        if (item.instanceCount > 0) {
+            glDrawElementsInstanced(GL_TRIANGLES, item.mesh->indexCount, GL_UNSIGNED_INT, 0, item.instanceCount);
+        } else {
+            currentShader->setMat4("model", item.model);
+            int useColor = item.color.a > 0.0f ? 1 : 0;
+            if (useColor != currentUseColor) {
+                currentShader->setInt("useObjectColor", useColor);
+                currentUseColor = useColor;
+            }
+            if (useColor && (!colorKnown || glm::vec3(item.color) != currentColor)) {
+                currentColor = glm::vec3(item.color);
+                currentShader->setVec3("objectColor", currentColor);
+                colorKnown = true;
+            }
+            glDrawElements(GL_TRIANGLES, item.mesh->indexCount, GL_UNSIGNED_INT, 0);
+        }
+        stats.drawCalls++;
+    }
+
+    glBindVertexArray(0);
+    if (activeUnit != 0 && activeUnit != ~0u)
+        glActiveTexture(GL_TEXTURE0);
+}
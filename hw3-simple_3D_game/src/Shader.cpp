@@ -51,11 +51,58 @@ Shader::Shader(const char* vertexPath, const char* fragmentPath) {
     }
     glDeleteShader(vertex);
     glDeleteShader(fragment);
+    cacheActiveUniforms();
 }
 
+namespace {
+Shader::FrameStats frameStats;
+}
+
+void Shader::cacheActiveUniforms(){
+    int count = 0, maxLength = 0;
+    glGetProgramiv(ID, GL_ACTIVE_UNIFORMS, &count);
+    glGetProgramiv(ID, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxLength);
+    std::string name(maxLength > 0 ? maxLength : 1, '\0');
+    for(int i = 0; i < count; i++){
+        int length = 0, size = 0;
+        GLenum type;
+        glGetActiveUniform(ID, (GLuint)i, maxLength, &length, &size, &type, &name[0]);
+        std::string uniformName = name.substr(0, length);
+        int location = glGetUniformLocation(ID, uniformName.c_str());
+        if(location < 0) continue; // lives in a uniform block
+        uniformLocations[uniformName] = location;
+        // arrays are reported as "name[0]"; make the bare name resolve too
+        size_t bracket = uniformName.find('[');
+        if(bracket != std::string::npos)
+            uniformLocations[uniformName.substr(0, bracket)] = location;
+    }
+}
+
+int Shader::getLocation(const std::string &name) const {
+    auto it = uniformLocations.find(name);
+    if(it != uniformLocations.end()) return it->second;
+    // e.g. "lights[3]" or a name the linker optimised away; remember the answer either way
+    frameStats.locationQueries++;
+    int location = glGetUniformLocation(ID, name.c_str());
+    uniformLocations[name] = location;
+    return location;
+}
+
+void Shader::bindUniformBlock(const std::string &blockName, unsigned int bindingPoint) const {
+    unsigned int index = glGetUniformBlockIndex(ID, blockName.c_str());
+    if(index == GL_INVALID_INDEX){
+        std::cerr<<"Uniform block "<<blockName<<" not found in program "<<ID<<"\n";
+        return;
+    }
+    glUniformBlockBinding(ID, index, bindingPoint);
+}
+
+const Shader::FrameStats& Shader::GetFrameStats(){ return frameStats; }
+void Shader::ResetFrameStats(){ frameStats = FrameStats(); }
+
 void Shader::use(){ glUseProgram(ID); }
-void Shader::setBool(const std::string &name, bool value) const { glUniform1i(glGetUniformLocation(ID, name.c_str()), (int)value); }
-void Shader::setInt(const std::string &name, int value) const { glUniform1i(glGetUniformLocation(ID, name.c_str()), value); }
-void Shader::setFloat(const std::string &name, float value) const { glUniform1f(glGetUniformLocation(ID, name.c_str()), value); }
-void Shader::setMat4(const std::string &name, const glm::mat4 &mat) const { glUniformMatrix4fv(glGetUniformLocation(ID, name.c_str()), 1, GL_FALSE, &mat[0][0]); }
-void Shader::setVec3(const std::string &name, const glm::vec3 &vec) const { glUniform3fv(glGetUniformLocation(ID, name.c_str()), 1, &vec[0]); }
+void Shader::setBool(const std::string &name, bool value) const { frameStats.uniformCalls++; glUniform1i(getLocation(name), (int)value); }
+void Shader::setInt(const std::string &name, int value) const { frameStats.uniformCalls++; glUniform1i(getLocation(name), value); }
+void Shader::setFloat(const std::string &name, float value) const { frameStats.uniformCalls++; glUniform1f(getLocation(name), value); }
+void Shader::setMat4(const std::string &name, const glm::mat4 &mat) const { frameStats.uniformCalls++; glUniformMatrix4fv(getLocation(name), 1, GL_FALSE, &mat[0][0]); }
+void Shader::setVec3(const std::string &name, const glm::vec3 &vec) const { frameStats.uniformCalls++; glUniform3fv(getLocation(name), 1, &vec[0]); }
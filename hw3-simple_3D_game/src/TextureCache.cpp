@@ -0,0 +1,149 @@
+#include "TextureCache.h"
+#include "ThreadPool.h"
+#include <glad/glad.h>
+#include "stb_image.h"
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+#include <unordered_map>
+
+namespace {
+
+struct Decoded {
+    std::string resolvedPath;
+    unsigned char* pixels = nullptr;
+    int width = 0, height = 0, channels = 0;
+    double ms = 0.0;
+};
+
+std::unordered_map<std::string, unsigned int> byRequest;      // directory + '|' + file
+std::unordered_map<std::string, unsigned int> byResolvedPath; // same image reached from another directory
+TextureCache::Stats stats;
+
+double MillisecondsSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+// runs on a worker: probe the shared texture folder first, then the model's own directory
+Decoded Decode(const std::string& file, const std::string& directory) {
+    auto start = std::chrono::steady_clock::now();
+    Decoded result;
+    const std::string candidates[2] = {"assets/textures/" + file, directory + "/" + file};
+    for (const std::string& path : candidates) {
+        result.pixels = stbi_load(path.c_str(), &result.width, &result.height, &result.channels, 0);
+        if (result.pixels) {
+            result.resolvedPath = path;
+            break;
+        }
+    }
+    if (!result.pixels)
+        std::cerr << "Texture failed to load at both paths: " << candidates[0] << " and " << candidates[1] << std::endl;
+    result.ms = MillisecondsSince(start);
+    return result;
+}
+
+// GL thread only
+unsigned int Upload(const Decoded& image) {
+    unsigned int textureID;
+    glGenTextures(1, &textureID);
+    if (!image.pixels)
+        return textureID;
+
+    GLenum format = GL_RGB;
+    if (image.channels == 1)
+        format = GL_RED;
+    else if (image.channels == 3)
+        format = GL_RGB;
+    else if (image.channels == 4)
+        format = GL_RGBA;
+
+    glBindTexture(GL_TEXTURE_2D, textureID);
+    glTexImage2D(GL_TEXTURE_2D, 0, format, image.width, image.height, 0, format, GL_UNSIGNED_BYTE, image.pixels);
+    glGenerateMipmap(GL_TEXTURE_2D);
+
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+
+    // a full mip chain adds roughly a third on top of the base level
+    size_t baseBytes = (size_t)image.width * image.height * image.channels;
+    stats.residentBytes += baseBytes + baseBytes / 3;
+    return textureID;
+}
+
+}
+
+std::vector<unsigned int> TextureCache::Acquire(const std::vector<std::string>& files, const std::string& directory) {
+    auto start = std::chrono::steady_clock::now();
+    std::vector<unsigned int> ids(files.size(), 0);
+
+    // fan out one decode job per distinct missing file
+    struct Pending {
+        std::string key;
+        std::future<Decoded> image;
+        std::vector<size_t> slots;
+    };
+    std::vector<Pending> pending;
+    std::unordered_map<std::string, size_t> pendingByKey;
+
+    for (size_t i = 0; i < files.size(); i++) {
+        stats.requests++;
+        std::string key = directory + "|" + files[i];
+        auto cached = byRequest.find(key);
+        if (cached != byRequest.end()) {
+            stats.hits++;
+            ids[i] = cached->second;
+            continue;
+        }
+        auto inFlight = pendingByKey.find(key);
+        if (inFlight != pendingByKey.end()) {
+            stats.hits++;
+            pending[inFlight->second].slots.push_back(i);
+            continue;
+        }
+        pendingByKey[key] = pending.size();
+        std::string file = files[i];
+        pending.push_back({key, ThreadPool::Shared().Submit([file, directory]() { return Decode(file, directory); }), {i}});
+    }
+
+    // upload in submission order as decodes finish; later decodes keep running meanwhile
+    for (Pending& p : pending) {
+        Decoded image = p.image.get();
+        stats.decodeMs += image.ms;
+
+        unsigned int id;
+        auto sameImage = image.pixels ? byResolvedPath.find(image.resolvedPath) : byResolvedPath.end();
+        if (sameImage != byResolvedPath.end()) {
+            stats.hits++;
+            id = sameImage->second;
+        } else {
+            id = Upload(image);
+            if (image.pixels) {
+                stats.decoded++;
+                byResolvedPath[image.resolvedPath] = id;
+            } else {
+                stats.failed++;
+            }
+        }
+        if (image.pixels)
+            stbi_image_free(image.pixels);
+
+        byRequest[p.key] = id;
+        for (size_t slot : p.slots)
+            ids[slot] = id;
+    }
+
+    stats.loadMs += MillisecondsSince(start);
+    return ids;
+}
+
+const TextureCache::Stats& TextureCache::GetStats() {
+    return stats;
+}
+
+void TextureCache::PrintStats() {
+    std::printf("Textures: %u requests, %u cache hits, %u decoded, %u failed | decode %.1f ms (workers), load %.1f ms (wall) | %.2f MiB resident\n",
+                stats.requests, stats.hits, stats.decoded, stats.failed,
+                stats.decodeMs, stats.loadMs, stats.residentBytes / (1024.0 * 1024.0));
+}
@@ -0,0 +1,65 @@
+#include "ThreadPool.h"
+#include <algorithm>
+
+ThreadPool::ThreadPool(unsigned int threadCount) {
+    if (threadCount == 0)
+        threadCount = std::thread::hardware_concurrency();
+    if (threadCount == 0)
+        threadCount = 4;
+    for (unsigned int i = 0; i < threadCount; i++)
+        workers.emplace_back(&ThreadPool::WorkerLoop, this);
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wake.notify_all();
+    for (auto& worker : workers)
+        worker.join();
+}
+
+ThreadPool& ThreadPool::Shared() {
+    static ThreadPool pool;
+    return pool;
+}
+
+void ThreadPool::ParallelFor(size_t count, const std::function<void(size_t, size_t)>& body) {
+    if (count == 0)
+        return;
+    // a few chunks per worker so uneven meshes still balance
+    size_t chunks = std::min(count, (size_t)Size() * 4);
+    size_t chunkSize = (count + chunks - 1) / chunks;
+    std::vector<std::future<void>> pending;
+    pending.reserve(chunks);
+    for (size_t begin = 0; begin < count; begin += chunkSize) {
+        size_t end = std::min(count, begin + chunkSize);
+        pending.push_back(Submit([&body, begin, end]() { body(begin, end); }));
+    }
+    for (auto& job : pending)
+        job.get();
+}
+
+void ThreadPool::Enqueue(std::function<void()> job) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        jobs.push(std::move(job));
+    }
+    wake.notify_one();
+}
+
+void ThreadPool::WorkerLoop() {
+    for (;;) {
+        std::function<void()> job;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            wake.wait(lock, [this] { return stopping || !jobs.empty(); });
+            if (stopping && jobs.empty())
+                return;
+            job = std::move(jobs.front());
+            jobs.pop();
+        }
+        job();
+    }
+}
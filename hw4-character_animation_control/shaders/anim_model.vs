@@ -14,13 +14,22 @@ uniform mat4 model;
 
 const int MAX_BONES = 100;
 const int MAX_BONE_INFLUENCE = 4;
-uniform mat4 finalBonesMatrices[MAX_BONES];
+// one character's bones; the application binds its range of the palette UBO per draw
+layout(std140) uniform BonePalette
+{
+    mat4 finalBonesMatrices[MAX_BONES];
+};
 
 out vec2 TexCoords;
+out vec3 Normal;
+// model-space skinning result; captured with transform feedback to check src/cpu_skinning.h
+out vec3 SkinnedPosition;
+out vec3 SkinnedNormal;
 
 void main()
 {
     vec4 totalPosition = vec4(0.0f);
+    vec3 totalNormal = vec3(0.0f);
     for(int i = 0 ; i < MAX_BONE_INFLUENCE ; i++)
     {
         if(boneIds[i] == -1) 
@@ -28,14 +37,20 @@ void main()
         if(boneIds[i] >=MAX_BONES) 
         {
             totalPosition = vec4(pos,1.0f);
+            totalNormal = norm;
             break;
         }
         vec4 localPosition = finalBonesMatrices[boneIds[i]] * vec4(pos,1.0f);
         totalPosition += localPosition * weights[i];
         vec3 localNormal = mat3(finalBonesMatrices[boneIds[i]]) * norm;
+        totalNormal += localNormal * weights[i];
    }
+    SkinnedPosition = totalPosition.xyz;
+    SkinnedNormal = totalNormal;
 	
     mat4 viewModel = view * model;
     gl_Position =  projection * viewModel * totalPosition;
+    // left unnormalised; the fragment shader normalises after interpolation
+    Normal = mat3(model) * totalNormal;
 	TexCoords = tex;
 }
@@ -0,0 +1,21 @@
+#version 330 core
+
+// Vertices already skinned on the CPU (src/cpu_skinning.h): model-space position and
+// unnormalised normal, streamed every frame. Same outputs as anim_model.vs.
+layout(location = 0) in vec3 pos;
+layout(location = 1) in vec3 norm;
+layout(location = 2) in vec2 tex;
+
+uniform mat4 projection;
+uniform mat4 view;
+uniform mat4 model;
+
+out vec2 TexCoords;
+out vec3 Normal;
+
+void main()
+{
+    gl_Position = projection * view * model * vec4(pos, 1.0f);
+    Normal = mat3(model) * norm;
+    TexCoords = tex;
+}
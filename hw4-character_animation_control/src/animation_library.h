@@ -0,0 +1,275 @@
+#ifndef ANIMATION_LIBRARY_H
+#define ANIMATION_LIBRARY_H
+
+#include <glad/glad.h>
+
+#include <assimp/Importer.hpp>
+#include <assimp/scene.h>
+#include <assimp/postprocess.h>
+
+#include <learnopengl/mesh.h>
+#include <learnopengl/shader.h>
+#include <learnopengl/model_animation.h>
+
+#include "baked_clip.h"
+#include "bone_weights.h"
+#include "job_system.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+// One character: its skinned meshes, its skeleton and every clip baked against it.
+//
+// All the doozy files share one skeleton, yet a Model plus one Animation per clip
+// imports the model file twice and every clip file with full mesh post-processing.
+// The library imports the model file once (meshes, skeleton and its own clip) and
+// the other files with no post-processing, reading only their animation channels.
+// The imports, then the bakes, run in parallel on the job system; the GL meshes are
+// built afterwards on the calling thread, which owns the context.
+class AnimationLibrary
+{
+public:
+    struct LoadTimes
+    {
+        double importMs = 0.0;  // every file, in parallel
+        double bakeMs = 0.0;    // skeleton, then every clip in parallel
+        double meshMs = 0.0;    // vertices, bone weights, GL buffers and textures
+        double totalMs = 0.0;
+    };
+
+    AnimationLibrary() = default;
+    AnimationLibrary(const AnimationLibrary &) = delete;
+    AnimationLibrary &operator=(const AnimationLibrary &) = delete;
+
+    // Loads modelPath's meshes and skeleton and bakes the first animation of each clip
+    // path; a clip path may name the model file itself. Clips keep the order of clipPaths.
+    // Returns false (after printing why) if a file fails to import or has no animation.
+    bool Load(const std::string &modelPath, const std::vector<std::string> &clipPaths, JobSystem &jobs)
+    {
+        auto start = Clock::now();
+        // one import per distinct file, the model file first
+        std::vector<std::string> files(1, modelPath);
+        std::vector<int> clipFiles;
+        for (const std::string &path : clipPaths)
+        {
+            auto it = std::find(files.begin(), files.end(), path);
+            clipFiles.push_back((int)(it - files.begin()));
+            if (it == files.end())
+                files.push_back(path);
+        }
+
+        std::vector<std::unique_ptr<Assimp::Importer>> importers(files.size());
+        std::vector<const aiScene *> scenes(files.size(), nullptr);
+        jobs.ParallelFor((int)files.size(), 1, [&](int begin, int end, int)
+        {
+            for (int i = begin; i < end; i++)
+            {
+                // one importer per file: Assimp is thread safe as long as importers are not shared
+                importers[i].reset(new Assimp::Importer());
+                unsigned int flags = i == 0 ? MeshFlags : 0;
+                scenes[i] = importers[i]->ReadFile(files[i], flags);
+            }
+        });
+        times.importMs = Ms(start);
+
+        for (size_t i = 0; i < files.size(); i++)
+        {
+            // a clip file only has to carry a node tree; the mesh file must be complete
+            const aiScene *scene = scenes[i];
+            if (!scene || !scene->mRootNode || (i == 0 && (scene->mFlags & AI_SCENE_FLAGS_INCOMPLETE)))
+            {
+                std::cout << "ERROR::ASSIMP:: " << files[i] << ": " << importers[i]->GetErrorString() << std::endl;
+                return false;
+            }
+        }
+        for (size_t c = 0; c < clipFiles.size(); c++)
+        {
+            if (scenes[clipFiles[c]]->mNumAnimations == 0)
+            {
+                std::cout << "ERROR::ANIMATION_LIBRARY:: no animation in " << clipPaths[c] << std::endl;
+                return false;
+            }
+        }
+
+        auto bakeStart = Clock::now();
+        const aiScene *model = scenes[0];
+        ReadBones(model);
+        skeleton = Skeleton::FromScene(model->mRootNode, boneInfo);
+        clips.clear();
+        clips.resize(clipPaths.size());
+        jobs.ParallelFor((int)clips.size(), 1, [&](int begin, int end, int)
+        {
+            for (int c = begin; c < end; c++)
+                clips[c] = BakedClip::Bake(scenes[clipFiles[c]]->mAnimations[0], skeleton);
+        });
+        times.bakeMs = Ms(bakeStart);
+        // clip files are done with; free them before the mesh upload
+        for (size_t i = 1; i < importers.size(); i++)
+            importers[i].reset();
+
+        auto meshStart = Clock::now();
+        size_t slashPos = modelPath.find_last_of("/\\");
+        directory = slashPos != std::string::npos ? modelPath.substr(0, slashPos) : ".";
+        meshes.clear();
+        ProcessNode(model->mRootNode, model);
+        times.meshMs = Ms(meshStart);
+        times.totalMs = Ms(start);
+        return true;
+    }
+
+    // BakedClip::Compress on every clip, in parallel; returns the time taken
+    double CompressClips(const ClipCompression &settings, JobSystem &jobs)
+    {
+        auto start = Clock::now();
+        jobs.ParallelFor((int)clips.size(), 1, [&](int begin, int end, int)
+        {
+            for (int c = begin; c < end; c++)
+                clips[c].Compress(settings);
+        });
+        return Ms(start);
+    }
+
+    void Draw(Shader &shader)
+    {
+        for (Mesh &mesh : meshes)
+            mesh.Draw(shader);
+    }
+
+    const std::vector<Mesh> &GetMeshes() const { return meshes; }
+    const Skeleton &GetSkeleton() const { return skeleton; }
+    int ClipCount() const { return (int)clips.size(); }
+    const BakedClip &GetClip(int i) const { return clips[i]; }
+    const std::map<std::string, BoneInfo> &GetBoneInfoMap() const { return boneInfo; }
+    const LoadTimes &GetLoadTimes() const { return times; }
+
+private:
+    typedef std::chrono::steady_clock Clock;
+
+    // what Model (learnopengl/model_animation.h) imports its file with: no aiProcess_FlipUVs,
+    // main flips the textures instead (stbi_set_flip_vertically_on_load)
+    static const unsigned int MeshFlags = aiProcess_Triangulate | aiProcess_GenSmoothNormals | aiProcess_CalcTangentSpace;
+
+    static double Ms(Clock::time_point start)
+    {
+        return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+    }
+
+    // Bone ids in the order Model hands them out (nodes depth first, then each node's
+    // meshes and their aiBones), so palettes match the Model/Animation path.
+    void ReadBones(const aiScene *scene)
+    {
+        boneInfo.clear();
+        meshBoneIds.assign(scene->mNumMeshes, std::vector<int>());
+        int boneCounter = 0;
+        std::vector<const aiNode *> stack(1, scene->mRootNode);
+        while (!stack.empty())
+        {
+            const aiNode *node = stack.back();
+            stack.pop_back();
+            for (unsigned int m = 0; m < node->mNumMeshes; m++)
+            {
+                const aiMesh *mesh = scene->mMeshes[node->mMeshes[m]];
+                std::vector<int> &ids = meshBoneIds[node->mMeshes[m]];
+                if (!ids.empty())
+                    continue;
+                for (unsigned int b = 0; b < mesh->mNumBones; b++)
+                {
+                    std::string name = mesh->mBones[b]->mName.C_Str();
+                    auto it = boneInfo.find(name);
+                    if (it == boneInfo.end())
+                    {
+                        BoneInfo info;
+                        info.id = boneCounter++;
+                        info.offset = AssimpGLMHelpers::ConvertMatrixToGLMFormat(mesh->mBones[b]->mOffsetMatrix);
+                        it = boneInfo.emplace(name, info).first;
+                    }
+                    ids.push_back(it->second.id);
+                }
+            }
+            // reversed so children pop in order, like Model's recursion
+            for (unsigned int c = node->mNumChildren; c > 0; c--)
+                stack.push_back(node->mChildren[c - 1]);
+        }
+    }
+
+    void ProcessNode(const aiNode *node, const aiScene *scene)
+    {
+        for (unsigned int i = 0; i < node->mNumMeshes; i++)
+            meshes.push_back(ProcessMesh(node->mMeshes[i], scene));
+        for (unsigned int i = 0; i < node->mNumChildren; i++)
+            ProcessNode(node->mChildren[i], scene);
+    }
+
+    Mesh ProcessMesh(unsigned int meshIndex, const aiScene *scene)
+    {
+        const aiMesh *mesh = scene->mMeshes[meshIndex];
+        std::vector<Vertex> vertices(mesh->mNumVertices);
+        for (unsigned int i = 0; i < mesh->mNumVertices; i++)
+        {
+            Vertex &vertex = vertices[i];
+            vertex.Position = AssimpGLMHelpers::GetGLMVec(mesh->mVertices[i]);
+            vertex.Normal = mesh->HasNormals() ? AssimpGLMHelpers::GetGLMVec(mesh->mNormals[i]) : glm::vec3(0.0f);
+            vertex.TexCoords = mesh->mTextureCoords[0] ? glm::vec2(mesh->mTextureCoords[0][i].x, mesh->mTextureCoords[0][i].y) : glm::vec2(0.0f);
+            if (mesh->HasTangentsAndBitangents())
+            {
+                vertex.Tangent = AssimpGLMHelpers::GetGLMVec(mesh->mTangents[i]);
+                vertex.Bitangent = AssimpGLMHelpers::GetGLMVec(mesh->mBitangents[i]);
+            }
+        }
+        AssignBoneWeights(mesh, vertices, &meshBoneIds[meshIndex]);
+
+        std::vector<unsigned int> indices;
+        indices.reserve(mesh->mNumFaces * 3);
+        for (unsigned int i = 0; i < mesh->mNumFaces; i++)
+            indices.insert(indices.end(), mesh->mFaces[i].mIndices, mesh->mFaces[i].mIndices + mesh->mFaces[i].mNumIndices);
+
+        // same sampler naming as Model: texture_diffuseN, texture_specularN, texture_normalN, texture_heightN
+        const aiMaterial *material = scene->mMaterials[mesh->mMaterialIndex];
+        std::vector<Texture> textures;
+        LoadMaterialTextures(material, aiTextureType_DIFFUSE, "texture_diffuse", textures);
+        LoadMaterialTextures(material, aiTextureType_SPECULAR, "texture_specular", textures);
+        LoadMaterialTextures(material, aiTextureType_HEIGHT, "texture_normal", textures);
+        LoadMaterialTextures(material, aiTextureType_AMBIENT, "texture_height", textures);
+        return Mesh(vertices, indices, textures);
+    }
+
+    // each texture file is loaded once and shared between meshes
+    void LoadMaterialTextures(const aiMaterial *material, aiTextureType type, const std::string &typeName, std::vector<Texture> &textures)
+    {
+        for (unsigned int i = 0; i < material->GetTextureCount(type); i++)
+        {
+            aiString path;
+            material->GetTexture(type, i, &path);
+            auto loaded = std::find_if(texturesLoaded.begin(), texturesLoaded.end(),
+                                       [&](const Texture &texture) { return std::strcmp(texture.path.data(), path.C_Str()) == 0; });
+            if (loaded != texturesLoaded.end())
+            {
+                textures.push_back(*loaded);
+                continue;
+            }
+            Texture texture;
+            texture.id = TextureFromFile(path.C_Str(), directory);
+            texture.type = typeName;
+            texture.path = path.C_Str();
+            textures.push_back(texture);
+            texturesLoaded.push_back(texture);
+        }
+    }
+
+    Skeleton skeleton;  // clips point at it, hence no copies or moves
+    std::vector<BakedClip> clips;
+    std::map<std::string, BoneInfo> boneInfo;
+    std::vector<std::vector<int>> meshBoneIds;  // per aiMesh: aiBone index -> bone id
+    std::vector<Mesh> meshes;
+    std::vector<Texture> texturesLoaded;
+    std::string directory;
+    LoadTimes times;
+};
+
+#endif
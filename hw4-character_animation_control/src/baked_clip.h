@@ -0,0 +1,608 @@
+#ifndef BAKED_CLIP_H
+#define BAKED_CLIP_H
+
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+#include <learnopengl/animation.h>
+
+#include "bone_palette.h"
+#include "clip_compression.h"
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <map>
+#include <string>
+#include <vector>
+
+// Pre-sampled animation clips.
+//
+// The LearnOpenGL Animator walks the AssimpNodeData tree every update, looks each
+// node up by name in the Animation's bone list, and each Bone scans its key vectors
+// for the current key. Baking does all of that once at load time: the hierarchy is
+// flattened into arrays (Skeleton) and every node's local transform is resampled at a
+// fixed rate into frame-major structure-of-arrays tracks (BakedClip). Sampling a pose
+// is then an index computation plus a lerp/nlerp between two contiguous frames.
+
+// node-local transform split into parts that can be interpolated
+struct LocalPose
+{
+    std::vector<glm::vec3> translations;
+    std::vector<glm::quat> rotations;
+    std::vector<glm::vec3> scales;
+
+    void Resize(int nodeCount)
+    {
+        translations.resize(nodeCount);
+        rotations.resize(nodeCount);
+        scales.resize(nodeCount);
+    }
+};
+
+// An Animation's node hierarchy in depth-first order, so every parent precedes its children.
+struct Skeleton
+{
+    std::vector<std::string> names;
+    std::vector<int> parents;          // -1 for the root
+    std::vector<int> boneIds;          // slot in the final matrix palette, -1 for helper nodes
+    std::vector<glm::mat4> offsets;    // BoneInfo::offset (mesh space -> bone space) where boneIds >= 0
+    std::vector<glm::mat4> bindLocal;  // node transform used when a clip has no channel for the node
+    int boneCount = 0;                 // palette entries used: highest bone id + 1
+
+    static Skeleton FromAnimation(Animation &animation)
+    {
+        Skeleton skeleton;
+        const std::map<std::string, BoneInfo> &boneInfo = animation.GetBoneIDMap();
+        std::function<void(const AssimpNodeData &, int)> visit = [&](const AssimpNodeData &node, int parent)
+        {
+            int index = skeleton.AddNode(node.name, node.transformation, parent, boneInfo);
+            for (const AssimpNodeData &child : node.children)
+                visit(child, index);
+        };
+        visit(animation.GetRootNode(), -1);
+        return skeleton;
+    }
+
+    // the same, straight from an imported scene's node tree (no Animation needed)
+    static Skeleton FromScene(const aiNode *root, const std::map<std::string, BoneInfo> &boneInfo)
+    {
+        Skeleton skeleton;
+        std::function<void(const aiNode *, int)> visit = [&](const aiNode *node, int parent)
+        {
+            int index = skeleton.AddNode(node->mName.data, AssimpGLMHelpers::ConvertMatrixToGLMFormat(node->mTransformation), parent, boneInfo);
+            for (unsigned int i = 0; i < node->mNumChildren; i++)
+                visit(node->mChildren[i], index);
+        };
+        visit(root, -1);
+        return skeleton;
+    }
+
+    int NodeCount() const { return (int)parents.size(); }
+
+    std::vector<glm::mat4> BindGlobals() const
+    {
+        std::vector<glm::mat4> globals(NodeCount());
+        for (int n = 0; n < NodeCount(); n++)
+            globals[n] = parents[n] < 0 ? bindLocal[n] : globals[parents[n]] * bindLocal[n];
+        return globals;
+    }
+
+    // largest extent of the bind-pose joints along any axis: the character's size
+    float BindHeight() const
+    {
+        std::vector<glm::mat4> globals = BindGlobals();
+        if (globals.empty())
+            return 0.0f;
+        glm::vec3 low(globals[0][3]), high(globals[0][3]);
+        for (const glm::mat4 &global : globals)
+        {
+            low = glm::min(low, glm::vec3(global[3]));
+            high = glm::max(high, glm::vec3(global[3]));
+        }
+        glm::vec3 extent = high - low;
+        return std::max(std::max(extent.x, extent.y), extent.z);
+    }
+
+    int FindNode(const std::string &name) const
+    {
+        auto it = std::find(names.begin(), names.end(), name);
+        return it == names.end() ? -1 : (int)(it - names.begin());
+    }
+
+    int AddNode(const std::string &name, const glm::mat4 &transform, int parent, const std::map<std::string, BoneInfo> &boneInfo)
+    {
+        int index = (int)parents.size();
+        names.push_back(name);
+        parents.push_back(parent);
+        bindLocal.push_back(transform);
+        auto it = boneInfo.find(name);
+        if (it != boneInfo.end())
+        {
+            boneIds.push_back(it->second.id);
+            offsets.push_back(it->second.offset);
+            boneCount = std::max(boneCount, it->second.id + 1);
+        }
+        else
+        {
+            boneIds.push_back(-1);
+            offsets.push_back(glm::mat4(1.0f));
+        }
+        return index;
+    }
+
+    // local pose -> final palette matrices (global * offset), the same result Animator::CalculateBoneTransform produces.
+    // globals is scratch with NodeCount() entries; finals must already be sized for the palette.
+    void ComputeFinalMatrices(const LocalPose &pose, std::vector<glm::mat4> &globals, std::vector<glm::mat4> &finals) const
+    {
+        const int nodeCount = NodeCount();
+        globals.resize(nodeCount);
+        for (int i = 0; i < nodeCount; i++)
+        {
+            glm::mat4 local = ComposeTransform(pose.translations[i], pose.rotations[i], pose.scales[i]);
+            globals[i] = parents[i] < 0 ? local : globals[parents[i]] * local;
+            int id = boneIds[i];
+            if (id >= 0 && id < (int)finals.size())
+                finals[id] = globals[i] * offsets[i];
+        }
+    }
+
+    static glm::mat4 ComposeTransform(const glm::vec3 &t, const glm::quat &r, const glm::vec3 &s)
+    {
+        glm::mat4 m = glm::mat4_cast(r);
+        m[0] *= s.x;
+        m[1] *= s.y;
+        m[2] *= s.z;
+        m[3] = glm::vec4(t, 1.0f);
+        return m;
+    }
+
+    // inverse of ComposeTransform for matrices without shear
+    static void DecomposeTransform(const glm::mat4 &m, glm::vec3 &t, glm::quat &r, glm::vec3 &s)
+    {
+        t = glm::vec3(m[3]);
+        s = glm::vec3(glm::length(glm::vec3(m[0])), glm::length(glm::vec3(m[1])), glm::length(glm::vec3(m[2])));
+        glm::mat3 rotation(glm::vec3(m[0]) / s.x, glm::vec3(m[1]) / s.y, glm::vec3(m[2]) / s.z);
+        r = glm::normalize(glm::quat_cast(rotation));
+    }
+};
+
+class BakedClip
+{
+public:
+    static constexpr float DefaultSampleRate = 30.0f;
+
+    // Resamples every skeleton node's local transform at sampleRate (frames per second,
+    // rounded so frames evenly cover the clip). Nodes the animation has no channel for
+    // keep the skeleton's bind transform. The animation's own hierarchy is not used, so
+    // clips from different files bake against one shared skeleton as long as node names match.
+    static BakedClip Bake(Animation &animation, const Skeleton &skeleton, float sampleRate = DefaultSampleRate)
+    {
+        std::vector<Bone *> channels(skeleton.NodeCount());
+        for (int n = 0; n < skeleton.NodeCount(); n++)
+            channels[n] = animation.FindBone(skeleton.names[n]);
+        return BakeChannels(channels, animation.GetDuration(), animation.GetTicksPerSecond(), skeleton, sampleRate);
+    }
+
+    // Same, reading the channels of an imported aiAnimation directly, so a clip file needs
+    // neither an Animation nor a Model of its own. Channels for nodes the skeleton lacks are ignored.
+    static BakedClip Bake(const aiAnimation *animation, const Skeleton &skeleton, float sampleRate = DefaultSampleRate)
+    {
+        std::vector<Bone> bones;
+        bones.reserve(animation->mNumChannels);  // channels point into bones
+        std::vector<Bone *> channels(skeleton.NodeCount(), nullptr);
+        for (unsigned int i = 0; i < animation->mNumChannels; i++)
+        {
+            const aiNodeAnim *channel = animation->mChannels[i];
+            int node = skeleton.FindNode(channel->mNodeName.data);
+            if (node < 0)
+                continue;
+            bones.emplace_back(channel->mNodeName.data, skeleton.boneIds[node], channel);
+            channels[node] = &bones.back();
+        }
+        return BakeChannels(channels, (float)animation->mDuration, (float)animation->mTicksPerSecond, skeleton, sampleRate);
+    }
+
+    // Replaces the float frames with CompressedTracks: keys linear interpolation rebuilds
+    // are dropped and the rest quantised to 48 bits. A rotation error of e radians moves
+    // joints below the node by about e times their distance, so each node's tolerances
+    // are the budget over its reach in the bind pose. Errors still add up along a chain;
+    // the result is judged by the largest model-space joint position error over every
+    // frame, and the tolerances are halved until that is within budget (budget =
+    // settings.tolerance * bind height). Returns that error.
+    float Compress(const ClipCompression &settings = ClipCompression())
+    {
+        if (IsCompressed() || nodeCount == 0)
+            return compressionError;
+        const float height = skeleton->BindHeight();
+        const float budget = settings.tolerance * height;
+
+        // farthest bind-pose joint at or below each node; at least a little so that
+        // leaves still carry their skin
+        std::vector<glm::mat4> bind = skeleton->BindGlobals();
+        std::vector<float> reach(nodeCount, 0.05f * height);
+        for (int n = 0; n < nodeCount; n++)
+            for (int a = skeleton->parents[n]; a >= 0; a = skeleton->parents[a])
+                reach[a] = std::max(reach[a], glm::length(glm::vec3(bind[n][3]) - glm::vec3(bind[a][3])));
+
+        std::vector<glm::vec3> sourceJoints((size_t)frameCount * nodeCount);
+        LocalPose pose;
+        pose.Resize(nodeCount);
+        for (int f = 0; f < frameCount; f++)
+        {
+            const size_t first = (size_t)f * nodeCount;
+            std::copy(&translations[first], &translations[first] + nodeCount, pose.translations.begin());
+            std::copy(&rotations[first], &rotations[first] + nodeCount, pose.rotations.begin());
+            std::copy(&scales[first], &scales[first] + nodeCount, pose.scales.begin());
+            JointPositions(pose, &sourceJoints[first]);
+        }
+
+        CompressedTracks tracks;
+        std::vector<CompressedTracks::Tolerance> tolerances(nodeCount);
+        std::vector<glm::vec3> joints(nodeCount);
+        float scale = 1.0f, error = 0.0f;
+        for (int attempt = 0;; attempt++)
+        {
+            for (int n = 0; n < nodeCount; n++)
+                tolerances[n] = {budget * scale, budget * scale / reach[n], budget * scale / reach[n]};
+            tracks.Build(translations.data(), rotations.data(), scales.data(), frameCount, nodeCount, tolerances);
+
+            error = 0.0f;
+            for (int f = 0; f < frameCount; f++)
+            {
+                for (int n = 0; n < nodeCount; n++)
+                    tracks.Decode(n, (float)f, pose.translations[n], pose.rotations[n], pose.scales[n]);
+                JointPositions(pose, joints.data());
+                for (int n = 0; n < nodeCount; n++)
+                    error = std::max(error, glm::length(joints[n] - sourceJoints[(size_t)f * nodeCount + n]));
+            }
+            if (error <= budget || attempt >= settings.maxRefinements)
+                break;
+            scale *= 0.5f;
+        }
+
+        compressed = std::move(tracks);
+        compressionError = error;
+        std::vector<glm::vec3>().swap(translations);
+        std::vector<glm::quat>().swap(rotations);
+        std::vector<glm::vec3>().swap(scales);
+        return error;
+    }
+
+    // Local pose at the given time, wrapping around the clip. Two frame indices from the
+    // time, then one pass over both frames' contiguous keys. With a node list only those
+    // nodes are written (animation LOD skips detail bones that way).
+    void Sample(float seconds, LocalPose &pose, const std::vector<int> *nodes = nullptr) const
+    {
+        pose.Resize(nodeCount);
+        int f0;
+        float alpha;
+        Locate(seconds, f0, alpha);
+        if (IsCompressed())
+        {
+            const int count = nodes ? (int)nodes->size() : nodeCount;
+            for (int i = 0; i < count; i++)
+            {
+                const int n = nodes ? (*nodes)[i] : i;
+                compressed.Decode(n, f0 + alpha, pose.translations[n], pose.rotations[n], pose.scales[n]);
+            }
+            return;
+        }
+
+        const glm::vec3 *t0 = &translations[(size_t)f0 * nodeCount], *t1 = t0 + nodeCount;
+        const glm::quat *r0 = &rotations[(size_t)f0 * nodeCount], *r1 = r0 + nodeCount;
+        const glm::vec3 *s0 = &scales[(size_t)f0 * nodeCount], *s1 = s0 + nodeCount;
+        const int count = nodes ? (int)nodes->size() : nodeCount;
+        for (int i = 0; i < count; i++)
+        {
+            const int n = nodes ? (*nodes)[i] : i;
+            pose.translations[n] = glm::mix(t0[n], t1[n], alpha);
+            // frames are 1/sampleRate apart, close enough that nlerp matches slerp
+            pose.rotations[n] = glm::normalize(r0[n] * (1.0f - alpha) + r1[n] * alpha);
+            pose.scales[n] = glm::mix(s0[n], s1[n], alpha);
+        }
+    }
+
+    // Samples at the given time and mixes the result into an existing pose of the same
+    // skeleton: weight 0 leaves pose unchanged, 1 replaces it. Blending in place means a
+    // multi-clip blend needs no pose buffer per clip.
+    void BlendInto(float seconds, float weight, LocalPose &pose, const std::vector<int> *nodes = nullptr) const
+    {
+        int f0;
+        float alpha;
+        Locate(seconds, f0, alpha);
+        if (IsCompressed())
+        {
+            const int count = nodes ? (int)nodes->size() : nodeCount;
+            for (int i = 0; i < count; i++)
+            {
+                const int n = nodes ? (*nodes)[i] : i;
+                glm::vec3 t, s;
+                glm::quat r;
+                compressed.Decode(n, f0 + alpha, t, r, s);
+                pose.translations[n] = glm::mix(pose.translations[n], t, weight);
+                float w = glm::dot(pose.rotations[n], r) < 0.0f ? -weight : weight;
+                pose.rotations[n] = glm::normalize(pose.rotations[n] * (1.0f - weight) + r * w);
+                pose.scales[n] = glm::mix(pose.scales[n], s, weight);
+            }
+            return;
+        }
+
+        const glm::vec3 *t0 = &translations[(size_t)f0 * nodeCount], *t1 = t0 + nodeCount;
+        const glm::quat *r0 = &rotations[(size_t)f0 * nodeCount], *r1 = r0 + nodeCount;
+        const glm::vec3 *s0 = &scales[(size_t)f0 * nodeCount], *s1 = s0 + nodeCount;
+        const int count = nodes ? (int)nodes->size() : nodeCount;
+        for (int i = 0; i < count; i++)
+        {
+            const int n = nodes ? (*nodes)[i] : i;
+            pose.translations[n] = glm::mix(pose.translations[n], glm::mix(t0[n], t1[n], alpha), weight);
+            glm::quat r = r0[n] * (1.0f - alpha) + r1[n] * alpha;
+            // another clip's rotation may sit in the opposite hemisphere
+            float w = glm::dot(pose.rotations[n], r) < 0.0f ? -weight : weight;
+            pose.rotations[n] = glm::normalize(pose.rotations[n] * (1.0f - weight) + r * w);
+            pose.scales[n] = glm::mix(pose.scales[n], glm::mix(s0[n], s1[n], alpha), weight);
+        }
+    }
+
+    const Skeleton &GetSkeleton() const { return *skeleton; }
+    float GetDuration() const { return duration; }
+    int GetFrameCount() const { return frameCount; }
+    size_t GetMemoryBytes() const
+    {
+        return translations.size() * sizeof(glm::vec3) + rotations.size() * sizeof(glm::quat) + scales.size() * sizeof(glm::vec3) +
+               compressed.GetMemoryBytes();
+    }
+    bool IsCompressed() const { return !compressed.Empty(); }
+    // keys kept by Compress(), out of frames * nodes * 3
+    int GetKeyCount() const { return IsCompressed() ? compressed.KeyCount() : frameCount * nodeCount * 3; }
+    // largest joint position error Compress() measured against the float frames
+    float GetCompressionError() const { return compressionError; }
+
+private:
+    // channels[n] drives skeleton node n, or is null to hold its bind transform
+    static BakedClip BakeChannels(const std::vector<Bone *> &channels, float durationTicks, float ticksPerSecond, const Skeleton &skeleton, float sampleRate)
+    {
+        BakedClip clip;
+        clip.skeleton = &skeleton;
+        clip.nodeCount = skeleton.NodeCount();
+
+        if (ticksPerSecond <= 0.0f)
+            ticksPerSecond = 25.0f;
+        clip.duration = durationTicks / ticksPerSecond;
+        clip.frameCount = std::max(2, (int)std::ceil(clip.duration * sampleRate) + 1);
+        clip.frameSeconds = clip.duration / (clip.frameCount - 1);
+
+        const size_t keyCount = (size_t)clip.frameCount * clip.nodeCount;
+        clip.translations.resize(keyCount);
+        clip.rotations.resize(keyCount);
+        clip.scales.resize(keyCount);
+        for (int f = 0; f < clip.frameCount; f++)
+        {
+            // Bone's key search has no key past the last one, so stay just inside the clip
+            float ticks = std::min(f * clip.frameSeconds * ticksPerSecond, std::nextafter(durationTicks, 0.0f));
+            ticks = std::max(ticks, 0.0f);
+            for (int n = 0; n < clip.nodeCount; n++)
+            {
+                glm::mat4 local = skeleton.bindLocal[n];
+                if (channels[n])
+                {
+                    channels[n]->Update(ticks);
+                    local = channels[n]->GetLocalTransform();
+                }
+                size_t k = (size_t)f * clip.nodeCount + n;
+                Skeleton::DecomposeTransform(local, clip.translations[k], clip.rotations[k], clip.scales[k]);
+                // keep neighbouring frames in the same hemisphere so Sample() can nlerp without a sign test
+                if (f > 0 && glm::dot(clip.rotations[k], clip.rotations[k - clip.nodeCount]) < 0.0f)
+                    clip.rotations[k] = -clip.rotations[k];
+            }
+        }
+        return clip;
+    }
+
+    // model-space position of every node
+    void JointPositions(const LocalPose &pose, glm::vec3 *joints) const
+    {
+        std::vector<glm::mat4> globals(nodeCount);
+        for (int n = 0; n < nodeCount; n++)
+        {
+            glm::mat4 local = Skeleton::ComposeTransform(pose.translations[n], pose.rotations[n], pose.scales[n]);
+            const int parent = skeleton->parents[n];
+            globals[n] = parent < 0 ? local : globals[parent] * local;
+            joints[n] = glm::vec3(globals[n][3]);
+        }
+    }
+
+    // first of the two frames around a time (wrapped into the clip) and the blend between them
+    void Locate(float seconds, int &f0, float &alpha) const
+    {
+        float t = duration > 0.0f ? std::fmod(seconds, duration) : 0.0f;
+        if (t < 0.0f)
+            t += duration;
+        float frame = frameSeconds > 0.0f ? t / frameSeconds : 0.0f;
+        f0 = std::min((int)frame, frameCount - 2);
+        alpha = std::min(frame - (float)f0, 1.0f);
+    }
+
+    const Skeleton *skeleton = nullptr;
+    int nodeCount = 0;
+    int frameCount = 0;
+    float duration = 0.0f;      // seconds
+    float frameSeconds = 0.0f;  // time between baked frames
+    // frame-major: key k of frame f is at [f * nodeCount + k]
+    std::vector<glm::vec3> translations;
+    std::vector<glm::quat> rotations;
+    std::vector<glm::vec3> scales;
+    CompressedTracks compressed;  // replaces the three above once Compress() has run
+    float compressionError = 0.0f;
+};
+
+// The clips one character is playing: up to MaxLayers at once, weights summing to 1.
+// CrossFade() brings a clip in over a given time while every other layer fades out in
+// proportion to its current weight, so a fade can interrupt another without a pop.
+// Layers live in fixed storage; nothing here touches the heap.
+class BlendState
+{
+public:
+    static const int MaxLayers = 3;
+
+    struct Layer
+    {
+        const BakedClip *clip;
+        float time;      // seconds into the clip
+        float weight;
+        float fadeFrom;  // weight when the current fade started
+    };
+
+    // hard cut to one clip
+    void Play(const BakedClip *clip, float time = 0.0f)
+    {
+        layers[0] = {clip, time, 1.0f, 1.0f};
+        count = clip ? 1 : 0;
+        fadeSeconds = fadeElapsed = 0.0f;
+    }
+
+    void CrossFade(const BakedClip *clip, float seconds)
+    {
+        if (count > 0 && layers[count - 1].clip == clip)
+            return;
+        if (count == 0 || seconds <= 0.0f)
+        {
+            Play(clip);
+            return;
+        }
+
+        // a clip still fading out comes back from where it is instead of restarting
+        Layer incoming = {clip, 0.0f, 0.0f, 0.0f};
+        for (int i = 0; i < count; i++)
+        {
+            if (layers[i].clip == clip)
+            {
+                incoming = layers[i];
+                Remove(i);
+                break;
+            }
+        }
+        if (count == MaxLayers)
+        {
+            // the new clip needs a slot: drop the faintest layer and renormalise the others
+            int faintest = 0;
+            for (int i = 1; i < count; i++)
+                if (layers[i].weight < layers[faintest].weight)
+                    faintest = i;
+            float kept = 1.0f - layers[faintest].weight - incoming.weight;
+            Remove(faintest);
+            float scale = kept > 0.0f ? (1.0f - incoming.weight) / kept : 0.0f;
+            for (int i = 0; i < count; i++)
+                layers[i].weight *= scale;
+        }
+        for (int i = 0; i < count; i++)
+            layers[i].fadeFrom = layers[i].weight;
+        incoming.fadeFrom = incoming.weight;
+        layers[count++] = incoming;
+        fadeSeconds = seconds;
+        fadeElapsed = 0.0f;
+    }
+
+    void Advance(float dt)
+    {
+        for (int i = 0; i < count; i++)
+            layers[i].time = std::fmod(layers[i].time + dt, std::max(layers[i].clip->GetDuration(), 1e-6f));
+        if (fadeSeconds <= 0.0f)
+            return;
+
+        fadeElapsed += dt;
+        float a = std::min(fadeElapsed / fadeSeconds, 1.0f);
+        if (a >= 1.0f)
+        {
+            layers[0] = layers[count - 1];
+            layers[0].weight = 1.0f;
+            count = 1;
+            fadeSeconds = fadeElapsed = 0.0f;
+            return;
+        }
+        for (int i = 0; i < count - 1; i++)
+            layers[i].weight = layers[i].fadeFrom * (1.0f - a);
+        Layer &target = layers[count - 1];
+        target.weight = target.fadeFrom + (1.0f - target.fadeFrom) * a;
+    }
+
+    // First layer is sampled straight into pose, each further one blended in with its
+    // share of the weight so far (a running weighted average).
+    // nodes limits the evaluation to a subset, as in BakedClip::Sample
+    void Evaluate(LocalPose &pose, const std::vector<int> *nodes = nullptr) const
+    {
+        if (count == 0)
+            return;
+        layers[0].clip->Sample(layers[0].time, pose, nodes);
+        float total = layers[0].weight;
+        for (int i = 1; i < count; i++)
+        {
+            total += layers[i].weight;
+            if (total > 0.0f)
+                layers[i].clip->BlendInto(layers[i].time, layers[i].weight / total, pose, nodes);
+        }
+    }
+
+    const BakedClip *GetTarget() const { return count > 0 ? layers[count - 1].clip : nullptr; }
+    int LayerCount() const { return count; }
+    const Layer &GetLayer(int i) const { return layers[i]; }
+
+private:
+    void Remove(int index)
+    {
+        for (int i = index; i < count - 1; i++)
+            layers[i] = layers[i + 1];
+        count--;
+    }
+
+    Layer layers[MaxLayers];
+    int count = 0;
+    float fadeSeconds = 0.0f;
+    float fadeElapsed = 0.0f;
+};
+
+// Animator counterpart for baked clips, with crossfades. All buffers are sized on the
+// first update, so later updates do not allocate.
+class BakedAnimator
+{
+public:
+    BakedAnimator(const BakedClip *clip)
+    {
+        finalBoneMatrices.assign(BonePalette::MaxBones, glm::mat4(1.0f));
+        PlayAnimation(clip);
+    }
+
+    void UpdateAnimation(float dt)
+    {
+        const BakedClip *clip = state.GetTarget();
+        if (!clip)
+            return;
+        state.Advance(dt);
+        state.Evaluate(pose);
+        clip->GetSkeleton().ComputeFinalMatrices(pose, globals, finalBoneMatrices);
+    }
+
+    // hard switch, restarting the clip
+    void PlayAnimation(const BakedClip *clip)
+    {
+        state.Play(clip);
+    }
+
+    // blend from whatever is playing to clip over the given time
+    void CrossFade(const BakedClip *clip, float seconds)
+    {
+        state.CrossFade(clip, seconds);
+    }
+
+    const std::vector<glm::mat4> &GetFinalBoneMatrices() const { return finalBoneMatrices; }
+    const BakedClip *GetCurrentClip() const { return state.GetTarget(); }
+    const BlendState &GetBlendState() const { return state; }
+
+private:
+    BlendState state;
+    LocalPose pose;
+    std::vector<glm::mat4> globals;
+    std::vector<glm::mat4> finalBoneMatrices;
+};
+
+#endif
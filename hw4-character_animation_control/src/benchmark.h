@@ -0,0 +1,835 @@
+#ifndef BENCHMARK_H
+#define BENCHMARK_H
+
+#include <assimp/Importer.hpp>
+#include <assimp/scene.h>
+#include <assimp/postprocess.h>
+
+#include <learnopengl/mesh.h>
+#include <learnopengl/animator.h>
+#include <learnopengl/model_animation.h>
+
+#include "bone_weights.h"
+#include "baked_clip.h"
+#include "crowd.h"
+#include "animation_library.h"
+#include "cpu_skinning.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <memory>
+#include <set>
+#include <string>
+#include <vector>
+
+// Command-line benchmarks (--bench-*). Ones that load a Model need a current GL
+// context for its textures; main creates a hidden window for those.
+class Benchmark
+{
+public:
+    // Bone weight assignment on each file: the old per-vertex scan over every bone's
+    // weights against the single-pass inversion in bone_weights.h. Assimp import time
+    // is reported separately since both passes start from the same aiScene.
+    static int BoneWeights(const std::vector<std::string> &paths)
+    {
+        std::cout << "bone weight assignment (MAX_BONE_INFLUENCE = " << MAX_BONE_INFLUENCE << ")\n";
+        int failures = 0;
+        for (const std::string &path : paths)
+        {
+            Assimp::Importer importer;
+            auto t0 = Clock::now();
+            // same flags as model_custom.h
+            const aiScene *scene = importer.ReadFile(path, aiProcess_Triangulate | aiProcess_GenSmoothNormals | aiProcess_FlipUVs | aiProcess_CalcTangentSpace);
+            double importMs = Ms(t0);
+            if (!scene || !scene->mRootNode)
+            {
+                std::cout << "  " << path << ": " << importer.GetErrorString() << "\n";
+                failures++;
+                continue;
+            }
+
+            unsigned int vertexCount = 0, weightCount = 0, trimmed = 0, mismatches = 0;
+            double scanMs = 0.0, linearMs = 0.0;
+            for (unsigned int m = 0; m < scene->mNumMeshes; m++)
+            {
+                const aiMesh *mesh = scene->mMeshes[m];
+                vertexCount += mesh->mNumVertices;
+                // influences per vertex, zero weights included; only vertices with at most
+                // MAX_BONE_INFLUENCE are comparable since the scan keeps the lowest bone indices
+                std::vector<unsigned int> influences(mesh->mNumVertices, 0);
+                for (unsigned int b = 0; b < mesh->mNumBones; b++)
+                {
+                    weightCount += mesh->mBones[b]->mNumWeights;
+                    for (unsigned int w = 0; w < mesh->mBones[b]->mNumWeights; w++)
+                        influences[mesh->mBones[b]->mWeights[w].mVertexId]++;
+                }
+
+                std::vector<Vertex> scanned(mesh->mNumVertices), linear(mesh->mNumVertices);
+                t0 = Clock::now();
+                AssignBoneWeightsScan(mesh, scanned);
+                scanMs += Ms(t0);
+                t0 = Clock::now();
+                trimmed += AssignBoneWeights(mesh, linear);
+                linearMs += Ms(t0);
+
+                for (size_t v = 0; v < linear.size(); v++)
+                    if (influences[v] <= MAX_BONE_INFLUENCE && !SameInfluences(scanned[v], linear[v]))
+                        mismatches++;
+            }
+
+            std::cout << "  " << path << "\n"
+                      << "    " << scene->mNumMeshes << " meshes, " << vertexCount << " vertices, " << weightCount << " weights\n"
+                      << "    import " << importMs << " ms\n"
+                      << "    per-vertex scan " << scanMs << " ms\n"
+                      << "    single pass     " << linearMs << " ms (" << (linearMs > 0.0 ? scanMs / linearMs : 0.0) << "x)\n"
+                      << "    " << trimmed << " vertices trimmed to " << MAX_BONE_INFLUENCE << " influences, "
+                      << mismatches << " mismatches on untrimmed vertices\n";
+            if (mismatches > 0)
+                failures++;
+        }
+        return failures == 0 ? 0 : 1;
+    }
+
+    // Character load time: Model plus one Animation per clip (the model file imported twice,
+    // every clip file with full mesh post-processing) and a serial bake, against
+    // AnimationLibrary::Load. Best of runs each; the paths take turns going first, so
+    // neither always pays for a cold file cache. Also checks that both paths bake the same
+    // bone matrices and build the same vertices (texture coordinates and bone weights).
+    static int Startup(const std::string &modelPath, const std::vector<std::string> &clipPaths, int runs)
+    {
+        JobSystem jobs;
+        std::cout << "startup: " << clipPaths.size() << " clips, " << jobs.WorkerCount() << " workers, best of " << runs << "\n";
+        double legacyMs = 1e30, libraryMs = 1e30;
+        AnimationLibrary::LoadTimes best;
+        float maxError = 0.0f;
+        VertexDifferences vertexDifferences;
+        for (int run = 0; run < std::max(runs, 1); run++)
+        {
+            std::unique_ptr<Model> model;
+            std::vector<BakedClip> clips;
+            auto loadLegacy = [&]()
+            {
+                auto t0 = Clock::now();
+                model.reset(new Model(modelPath));
+                std::vector<std::unique_ptr<Animation>> animations;
+                for (const std::string &path : clipPaths)
+                    animations.emplace_back(new Animation(path, model.get()));
+                Skeleton skeleton = Skeleton::FromAnimation(*animations[0]);
+                for (auto &animation : animations)
+                    clips.push_back(BakedClip::Bake(*animation, skeleton));
+                legacyMs = std::min(legacyMs, Ms(t0));
+            };
+
+            if (run % 2 == 0)
+                loadLegacy();
+            AnimationLibrary library;
+            if (!library.Load(modelPath, clipPaths, jobs))
+                return 1;
+            if (run % 2 == 1)
+                loadLegacy();
+            if (library.GetLoadTimes().totalMs < libraryMs)
+            {
+                libraryMs = library.GetLoadTimes().totalMs;
+                best = library.GetLoadTimes();
+            }
+            if (run == 0)
+            {
+                maxError = CompareClips(clips, library);
+                vertexDifferences = CompareVertices(*model, library);
+            }
+        }
+
+        std::cout << "  Model + Animation per clip " << legacyMs << " ms\n"
+                  << "  AnimationLibrary           " << libraryMs << " ms (" << (libraryMs > 0.0 ? legacyMs / libraryMs : 0.0) << "x): import "
+                  << best.importMs << ", bake " << best.bakeMs << ", meshes " << best.meshMs << "\n"
+                  << "  max matrix difference " << maxError << "\n"
+                  << "  " << vertexDifferences.vertices << " vertices, max texture coordinate difference " << vertexDifferences.maxTexCoordError
+                  << ", " << vertexDifferences.weightMismatches << " with different bone weights ("
+                  << vertexDifferences.trimmed << " more using all " << MAX_BONE_INFLUENCE << " slots, trimmed differently)\n";
+        if (!vertexDifferences.sameLayout)
+            std::cout << "  the meshes differ in count or vertex count\n";
+        return vertexDifferences.sameLayout && vertexDifferences.weightMismatches == 0 && vertexDifferences.maxTexCoordError <= 1e-6f ? 0 : 1;
+    }
+
+    // CPU skinning throughput: the shader-literal reference, the SIMD kernel on one thread
+    // and on every worker. Then parity: the kernel against the reference, and the vertex
+    // shader's own output, captured with transform feedback, against the kernel. Fails if
+    // either differs by more than SkinningTolerance (relative).
+    static int Skinning(const std::string &modelPath, const std::vector<std::string> &clipPaths, const std::string &vsPath, const std::string &fsPath)
+    {
+        JobSystem jobs;
+        AnimationLibrary library;
+        if (!library.Load(modelPath, clipPaths, jobs))
+            return 1;
+        const std::vector<Mesh> &meshes = library.GetMeshes();
+        std::vector<CpuSkinning> kernels;
+        std::vector<std::vector<SkinnedVertex>> reference(meshes.size()), skinned(meshes.size());
+        long long vertexCount = 0;
+        for (size_t m = 0; m < meshes.size(); m++)
+        {
+            kernels.emplace_back(meshes[m].vertices);
+            reference[m].resize(meshes[m].vertices.size());
+            skinned[m].resize(meshes[m].vertices.size());
+            vertexCount += meshes[m].vertices.size();
+        }
+
+        // a pose partway through the last clip, so most bones are away from bind pose
+        const BakedClip &clip = library.GetClip(library.ClipCount() - 1);
+        BakedAnimator animator(&clip);
+        animator.UpdateAnimation(clip.GetDuration() * 0.37f);
+        const std::vector<glm::mat4> &bones = animator.GetFinalBoneMatrices();
+        std::vector<float> palette;
+        CpuSkinning::BuildPalette(bones.data(), bones.size(), palette);
+
+        const int repeats = (int)std::max(1LL, 4000000LL / std::max(vertexCount, 1LL));
+        std::cout << "skinning: " << meshes.size() << " meshes, " << vertexCount << " vertices, " << repeats << " repeats, "
+                  << crowd_lanes::LaneWidth << " lanes, " << jobs.WorkerCount() << " workers\n";
+        auto t0 = Clock::now();
+        for (int r = 0; r < repeats; r++)
+            for (size_t m = 0; m < meshes.size(); m++)
+                for (size_t v = 0; v < meshes[m].vertices.size(); v++)
+                    reference[m][v] = CpuSkinning::SkinReference(meshes[m].vertices[v], bones.data());
+        double referenceMs = Ms(t0);
+        t0 = Clock::now();
+        for (int r = 0; r < repeats; r++)
+            for (size_t m = 0; m < meshes.size(); m++)
+                kernels[m].Skin(palette, skinned[m].data());
+        double kernelMs = Ms(t0);
+        t0 = Clock::now();
+        for (int r = 0; r < repeats; r++)
+            for (size_t m = 0; m < meshes.size(); m++)
+                kernels[m].Skin(palette, skinned[m].data(), &jobs);
+        double jobsMs = Ms(t0);
+
+        const double vertices = (double)vertexCount * repeats;
+        std::cout << "  reference     " << vertices / referenceMs / 1000.0 << " M vertices/s\n"
+                  << "  SIMD          " << vertices / kernelMs / 1000.0 << " M vertices/s (" << referenceMs / kernelMs << "x)\n"
+                  << "  SIMD + jobs   " << vertices / jobsMs / 1000.0 << " M vertices/s (" << referenceMs / jobsMs << "x)\n";
+
+        float cpuError = 0.0f;
+        for (size_t m = 0; m < meshes.size(); m++)
+            cpuError = std::max(cpuError, SkinningError(reference[m], skinned[m]));
+        std::cout << "  SIMD vs reference          max relative difference " << cpuError << "\n";
+
+        std::vector<std::vector<SkinnedVertex>> captured(meshes.size());
+        if (!CaptureShaderSkinning(vsPath, fsPath, meshes, bones, captured))
+            return 1;
+        float gpuError = 0.0f;
+        for (size_t m = 0; m < meshes.size(); m++)
+            gpuError = std::max(gpuError, SkinningError(skinned[m], captured[m]));
+        std::cout << "  anim_model.vs vs SIMD      max relative difference " << gpuError << "\n";
+
+        bool pass = cpuError <= SkinningTolerance && gpuError <= SkinningTolerance;
+        std::cout << (pass ? "  parity ok\n" : "  PARITY FAILED\n");
+        return pass ? 0 : 1;
+    }
+
+    // Pose evaluation per character and clip: LearnOpenGL Animator::UpdateAnimation
+    // against BakedAnimator (BakedClip::Sample + Skeleton::ComputeFinalMatrices), both
+    // stepped at 60 Hz. Also reports bake cost and the largest difference between
+    // the two sets of final bone matrices across the clip.
+    static int PoseEvaluation(const std::string &modelPath, const std::vector<std::string> &clipPaths, int updates)
+    {
+        std::vector<std::unique_ptr<Animation>> animations;
+        Skeleton skeleton;
+        std::vector<BakedClip> clips;
+        std::vector<double> bakeMs;
+        if (!LoadBakedClips(modelPath, clipPaths, animations, skeleton, clips, &bakeMs))
+            return 1;
+
+        const float dt = 1.0f / 60.0f;
+        std::cout << "pose evaluation: " << skeleton.NodeCount() << " nodes, " << skeleton.boneCount << " bones, "
+                  << updates << " updates per clip\n";
+        for (size_t c = 0; c < animations.size(); c++)
+        {
+            const BakedClip &clip = clips[c];
+            Animator animator(animations[c].get());
+            BakedAnimator baked(&clip);
+            auto t0 = Clock::now();
+            for (int i = 0; i < updates; i++)
+                animator.UpdateAnimation(dt);
+            double animatorMs = Ms(t0);
+            t0 = Clock::now();
+            for (int i = 0; i < updates; i++)
+                baked.UpdateAnimation(dt);
+            double bakedMs = Ms(t0);
+
+            // Accumulated time drifts differently in ticks and seconds, so compare at exact
+            // times instead: restart both and advance each by t in a single update.
+            float maxError = 0.0f;
+            const int checks = 240;
+            for (int i = 0; i < checks; i++)
+            {
+                float t = clip.GetDuration() * i / checks;
+                animator.PlayAnimation(animations[c].get());
+                animator.UpdateAnimation(t);
+                baked.PlayAnimation(&clip);
+                baked.UpdateAnimation(t);
+                std::vector<glm::mat4> reference = animator.GetFinalBoneMatrices();
+                const std::vector<glm::mat4> &result = baked.GetFinalBoneMatrices();
+                for (int b = 0; b < skeleton.boneCount && b < (int)reference.size(); b++)
+                    for (int col = 0; col < 4; col++)
+                        for (int row = 0; row < 4; row++)
+                            maxError = std::max(maxError, std::fabs(reference[b][col][row] - result[b][col][row]));
+            }
+
+            std::cout << "  " << clipPaths[c] << "\n"
+                      << "    baked " << clip.GetFrameCount() << " frames (" << clip.GetMemoryBytes() / 1024 << " KiB) in " << bakeMs[c] << " ms\n"
+                      << "    Animator      " << 1000.0 * animatorMs / updates << " us/pose\n"
+                      << "    BakedAnimator " << 1000.0 * bakedMs / updates << " us/pose ("
+                      << (bakedMs > 0.0 ? animatorMs / bakedMs : 0.0) << "x)\n"
+                      << "    max matrix difference " << maxError << "\n";
+        }
+        return 0;
+    }
+
+    // BakedClip::Compress with the default ClipCompression on each clip: size against the
+    // float frames, keys kept, compression time, cost per pose sample, and the largest
+    // joint position error against the float frames and against the source Animation
+    // (the LearnOpenGL Animator's bones, compared at exact times as in PoseEvaluation).
+    static int Compression(const std::string &modelPath, const std::vector<std::string> &clipPaths, int updates)
+    {
+        std::vector<std::unique_ptr<Animation>> animations;
+        Skeleton skeleton;
+        std::vector<BakedClip> clips;
+        if (!LoadBakedClips(modelPath, clipPaths, animations, skeleton, clips))
+            return 1;
+        // final matrix * inverse offset = the bone's model-space transform
+        std::vector<glm::mat4> inverseOffsets(skeleton.boneCount, glm::mat4(1.0f));
+        for (int n = 0; n < skeleton.NodeCount(); n++)
+            if (skeleton.boneIds[n] >= 0)
+                inverseOffsets[skeleton.boneIds[n]] = glm::inverse(skeleton.offsets[n]);
+
+        ClipCompression settings;
+        const float budget = settings.tolerance * skeleton.BindHeight();
+        const float dt = 1.0f / 60.0f;
+        std::cout << "clip compression: tolerance " << settings.tolerance << " of bind height " << skeleton.BindHeight()
+                  << " = " << budget << ", " << updates << " samples per clip\n";
+        for (size_t c = 0; c < animations.size(); c++)
+        {
+            const BakedClip &raw = clips[c];
+            BakedClip packed = raw;
+            auto t0 = Clock::now();
+            float error = packed.Compress(settings);
+            double compressMs = Ms(t0);
+
+            LocalPose pose;
+            t0 = Clock::now();
+            for (int i = 0; i < updates; i++)
+                raw.Sample(i * dt, pose);
+            double rawMs = Ms(t0);
+            t0 = Clock::now();
+            for (int i = 0; i < updates; i++)
+                packed.Sample(i * dt, pose);
+            double packedMs = Ms(t0);
+
+            Animator animator(animations[c].get());
+            BakedAnimator baked(&packed);
+            float sourceError = 0.0f;
+            const int checks = 240;
+            for (int i = 0; i < checks; i++)
+            {
+                float t = packed.GetDuration() * i / checks;
+                animator.PlayAnimation(animations[c].get());
+                animator.UpdateAnimation(t);
+                baked.PlayAnimation(&packed);
+                baked.UpdateAnimation(t);
+                std::vector<glm::mat4> reference = animator.GetFinalBoneMatrices();
+                const std::vector<glm::mat4> &result = baked.GetFinalBoneMatrices();
+                for (int b = 0; b < skeleton.boneCount && b < (int)reference.size(); b++)
+                {
+                    glm::vec3 expected(reference[b] * inverseOffsets[b][3]), actual(result[b] * inverseOffsets[b][3]);
+                    sourceError = std::max(sourceError, glm::length(expected - actual));
+                }
+            }
+
+            const int rawKeys = raw.GetKeyCount();
+            std::cout << "  " << clipPaths[c] << "\n"
+                      << "    " << raw.GetMemoryBytes() / 1024 << " KiB -> " << packed.GetMemoryBytes() / 1024 << " KiB ("
+                      << (packed.GetMemoryBytes() > 0 ? (double)raw.GetMemoryBytes() / packed.GetMemoryBytes() : 0.0) << "x), "
+                      << packed.GetKeyCount() << " of " << rawKeys << " keys, compressed in " << compressMs << " ms\n"
+                      << "    sample " << 1000.0 * rawMs / updates << " us -> " << 1000.0 * packedMs / updates << " us\n"
+                      << "    max joint error " << error << " against the float frames" << (error <= budget ? "" : " (over budget)")
+                      << ", " << sourceError << " against the source\n";
+        }
+        return 0;
+    }
+
+    // One character's update (advance, sample/blend, final matrices) with 1, 2 and 3 clips blended.
+    // Fails if any blend costs twice a single clip's update or more.
+    static int BlendEvaluation(const std::string &modelPath, const std::vector<std::string> &clipPaths, int updates)
+    {
+        std::vector<std::unique_ptr<Animation>> animations;
+        Skeleton skeleton;
+        std::vector<BakedClip> clips;
+        if (!LoadBakedClips(modelPath, clipPaths, animations, skeleton, clips))
+            return 1;
+
+        std::cout << "blend evaluation: " << skeleton.NodeCount() << " nodes, " << updates << " updates\n";
+        const float dt = 1.0f / 60.0f;
+        const float endless = 1e9f;
+        // a blend must cost less than this many single-clip updates
+        const double maxCost = 2.0;
+        double singleMs = 0.0;
+        bool pass = true;
+        const int layerCounts = std::min((int)clips.size(), (int)BlendState::MaxLayers);
+        for (int layers = 1; layers <= layerCounts; layers++)
+        {
+            BakedAnimator animator(&clips[0]);
+            animator.UpdateAnimation(dt);
+            // fades that never finish keep every layer in the blend (each one is sampled and
+            // mixed whatever its weight, so the cost is that of a real mid-fade frame)
+            for (int c = 1; c < layers; c++)
+                animator.CrossFade(&clips[c], endless);
+
+            auto t0 = Clock::now();
+            for (int i = 0; i < updates; i++)
+                animator.UpdateAnimation(dt);
+            double ms = Ms(t0);
+            if (layers == 1)
+                singleMs = ms;
+            const double ratio = singleMs > 0.0 ? ms / singleMs : 0.0;
+            pass = pass && ratio < maxCost;
+            std::cout << "  " << animator.GetBlendState().LayerCount() << " clip(s): " << 1000.0 * ms / updates << " us/update ("
+                      << ratio << "x single clip)" << (ratio < maxCost ? "\n" : " FAILED\n");
+        }
+        return pass ? 0 : 1;
+    }
+
+    // Crowd update throughput (characters per millisecond) at each instance count:
+    // Crowd::Update (SIMD, crowd_lanes::LaneWidth characters per pass) against UpdateScalar.
+    // Instances cycle through the clips with staggered start times. Fails if the two
+    // crowds' bone matrices differ by more than MatrixTolerance (relative).
+    static int CrowdUpdate(const std::string &modelPath, const std::vector<std::string> &clipPaths, const std::vector<int> &counts)
+    {
+        std::vector<std::unique_ptr<Animation>> animations;
+        Skeleton skeleton;
+        std::vector<BakedClip> clips;
+        if (!LoadBakedClips(modelPath, clipPaths, animations, skeleton, clips))
+            return 1;
+
+        std::cout << "crowd update: " << skeleton.NodeCount() << " nodes, " << crowd_lanes::LaneWidth << " characters per SIMD pass\n";
+        const float dt = 1.0f / 60.0f;
+        bool pass = true;
+        for (int count : counts)
+        {
+            Crowd simd(skeleton), scalar(skeleton);
+            for (int i = 0; i < count; i++)
+            {
+                const BakedClip *clip = &clips[i % clips.size()];
+                float start = std::fmod(i * 0.618f * clip->GetDuration(), clip->GetDuration());
+                simd.AddInstance(clip, start);
+                scalar.AddInstance(clip, start);
+            }
+            // warm-up, and both now hold the same poses
+            simd.Update(dt);
+            scalar.UpdateScalar(dt);
+            float maxError = 0.0f;
+            for (int i = 0; i < count; i++)
+                maxError = std::max(maxError, MatrixError(scalar.GetFinalBoneMatrices(i), simd.GetFinalBoneMatrices(i), skeleton.boneCount));
+            pass = pass && maxError <= MatrixTolerance;
+
+            const int updates = std::max(3, 20000 / std::max(count, 1));
+            auto t0 = Clock::now();
+            for (int i = 0; i < updates; i++)
+                simd.Update(dt);
+            double simdMs = Ms(t0) / updates;
+            t0 = Clock::now();
+            for (int i = 0; i < updates; i++)
+                scalar.UpdateScalar(dt);
+            double scalarMs = Ms(t0) / updates;
+
+            std::cout << "  " << count << " characters\n"
+                      << "    SIMD   " << simdMs << " ms/update, " << (simdMs > 0.0 ? count / simdMs : 0.0) << " characters/ms\n"
+                      << "    scalar " << scalarMs << " ms/update, " << (scalarMs > 0.0 ? count / scalarMs : 0.0) << " characters/ms\n"
+                      << "    max matrix difference " << maxError << (maxError <= MatrixTolerance ? "\n" : " FAILED\n");
+        }
+        return pass ? 0 : 1;
+    }
+
+    // Crowd::Update spread over 1, 2, 4 ... hardware-thread workers: time per update,
+    // speedup over one worker, and each worker's utilisation (busy / wall time).
+    static int JobScaling(const std::string &modelPath, const std::vector<std::string> &clipPaths, int count)
+    {
+        std::vector<std::unique_ptr<Animation>> animations;
+        Skeleton skeleton;
+        std::vector<BakedClip> clips;
+        if (!LoadBakedClips(modelPath, clipPaths, animations, skeleton, clips))
+            return 1;
+
+        Crowd crowd(skeleton);
+        for (int i = 0; i < count; i++)
+        {
+            const BakedClip *clip = &clips[i % clips.size()];
+            crowd.AddInstance(clip, std::fmod(i * 0.618f * clip->GetDuration(), clip->GetDuration()));
+        }
+
+        const int hardware = std::max(1, (int)std::thread::hardware_concurrency());
+        std::vector<int> workerCounts;
+        for (int w = 1; w < hardware; w *= 2)
+            workerCounts.push_back(w);
+        workerCounts.push_back(hardware);
+
+        std::cout << "job scaling: " << count << " characters, " << hardware << " hardware threads\n";
+        const float dt = 1.0f / 60.0f;
+        const int updates = std::max(3, 20000 / std::max(count, 1));
+        double singleMs = 0.0;
+        for (int workers : workerCounts)
+        {
+            JobSystem jobs(workers);
+            crowd.Update(dt, &jobs);  // sizes per-worker scratch
+            jobs.ResetStats();
+            auto t0 = Clock::now();
+            for (int i = 0; i < updates; i++)
+                crowd.Update(dt, &jobs);
+            double ms = Ms(t0) / updates;
+            if (workers == 1)
+                singleMs = ms;
+
+            std::cout << "  " << workers << " workers: " << ms << " ms/update, " << (ms > 0.0 ? singleMs / ms : 0.0) << "x\n";
+            for (int w = 0; w < workers; w++)
+                std::cout << "    worker " << w << ": " << 100.0 * jobs.Utilisation(w) << "% busy, "
+                          << jobs.GetStats(w).jobs << " jobs, " << jobs.GetStats(w).steals << " stolen\n";
+        }
+        return 0;
+    }
+
+    // Crowd::Update with animation LOD off, with Crowd::DefaultLodTiers(), and with those
+    // tiers holding poses instead of interpolating: time per update, poses evaluated
+    // per update and characters per tier. The crowd stands on main's --crowd grid, seen
+    // from the default camera. Fails if a character in a full-rate, full-detail tier
+    // differs from the same crowd updated without LOD by more than MatrixTolerance.
+    static int CrowdLod(const std::string &modelPath, const std::vector<std::string> &clipPaths, int count)
+    {
+        std::vector<std::unique_ptr<Animation>> animations;
+        Skeleton skeleton;
+        std::vector<BakedClip> clips;
+        if (!LoadBakedClips(modelPath, clipPaths, animations, skeleton, clips))
+            return 1;
+
+        // reference: LOD off, kept in step with crowd to check its full-detail instances
+        Crowd crowd(skeleton), reference(skeleton);
+        const int columns = (int)std::ceil(std::sqrt((float)count));
+        for (int i = 0; i < count; i++)
+        {
+            const BakedClip *clip = &clips[i % clips.size()];
+            const float start = std::fmod(i * 0.618f * clip->GetDuration(), clip->GetDuration());
+            glm::vec3 position((i % columns - columns * 0.5f) * 1.2f, -0.5f, -2.0f - (i / columns) * 1.2f);
+            crowd.AddInstance(clip, start, glm::scale(glm::translate(glm::mat4(1.0f), position), glm::vec3(0.5f)));
+            reference.AddInstance(clip, start);
+        }
+        crowd.SetViewer(glm::vec3(0.0f, 1.0f, 5.0f), glm::radians(45.0f));
+
+        std::vector<AnimationLodTier> held = Crowd::DefaultLodTiers();
+        for (AnimationLodTier &tier : held)
+            tier.interpolate = false;
+        struct Setting
+        {
+            const char *name;
+            std::vector<AnimationLodTier> tiers;
+        };
+        const Setting settings[] = {{"off", {}}, {"default tiers", Crowd::DefaultLodTiers()}, {"held poses", held}};
+
+        std::cout << "animation LOD: " << count << " characters, " << crowd.DetailBoneCount() << " detail bones\n";
+        JobSystem jobs;
+        const float dt = 1.0f / 60.0f;
+        const int updates = std::max(12, 20000 / std::max(count, 1));
+        double offMs = 0.0;
+        bool pass = true;
+        for (const Setting &setting : settings)
+        {
+            crowd.SetLodTiers(setting.tiers);
+            crowd.Update(dt, &jobs);  // every instance enters its tier
+            long long evaluated = 0;
+            auto t0 = Clock::now();
+            for (int i = 0; i < updates; i++)
+            {
+                crowd.Update(dt, &jobs);
+                evaluated += crowd.GetEvaluatedCount();
+            }
+            double ms = Ms(t0) / updates;
+            if (setting.tiers.empty())
+                offMs = ms;
+
+            // instances in a full-rate, full-detail tier must match the reference
+            for (int i = 0; i <= updates; i++)
+                reference.Update(dt, &jobs);
+            float maxError = 0.0f;
+            for (int i = 0; i < count; i++)
+            {
+                const AnimationLodTier &tier = crowd.GetLodTiers()[crowd.GetLodTier(i)];
+                if (tier.updateInterval <= 1 && !tier.skipDetailBones && !tier.sharedPose)
+                    maxError = std::max(maxError, MatrixError(reference.GetFinalBoneMatrices(i), crowd.GetFinalBoneMatrices(i), skeleton.boneCount));
+            }
+            pass = pass && maxError <= MatrixTolerance;
+
+            std::cout << "  " << setting.name << ": " << ms << " ms/update (" << (ms > 0.0 ? offMs / ms : 0.0) << "x), "
+                      << (double)evaluated / updates << " poses evaluated, tiers";
+            for (int n : crowd.GetLodCounts())
+                std::cout << " " << n;
+            std::cout << ", full-detail matrix difference " << maxError << (maxError <= MatrixTolerance ? "\n" : " FAILED\n");
+        }
+        return pass ? 0 : 1;
+    }
+
+private:
+    typedef std::chrono::steady_clock Clock;
+
+    static double Ms(Clock::time_point start)
+    {
+        return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+    }
+
+    // The fixture of the pose, blend and crowd benchmarks: one Animation per clip file
+    // (imported against the model at modelPath) and each clip baked against the first
+    // one's skeleton, which the clips point to. bakeMs, if given, gets each bake's time.
+    // False if there are no clips.
+    static bool LoadBakedClips(const std::string &modelPath, const std::vector<std::string> &clipPaths,
+                               std::vector<std::unique_ptr<Animation>> &animations, Skeleton &skeleton,
+                               std::vector<BakedClip> &clips, std::vector<double> *bakeMs = nullptr)
+    {
+        Model model(modelPath);
+        for (const std::string &path : clipPaths)
+            animations.emplace_back(new Animation(path, &model));
+        if (animations.empty())
+            return false;
+        skeleton = Skeleton::FromAnimation(*animations[0]);
+        for (auto &animation : animations)
+        {
+            auto t0 = Clock::now();
+            clips.push_back(BakedClip::Bake(*animation, skeleton));
+            if (bakeMs)
+                bakeMs->push_back(Ms(t0));
+        }
+        return true;
+    }
+
+    static constexpr float SkinningTolerance = 1e-4f;
+
+    // largest component difference, relative to the expected value's magnitude (at least 1)
+    static float SkinningError(const std::vector<SkinnedVertex> &expected, const std::vector<SkinnedVertex> &actual)
+    {
+        float maxError = 0.0f;
+        for (size_t v = 0; v < expected.size() && v < actual.size(); v++)
+            for (int a = 0; a < 3; a++)
+            {
+                maxError = std::max(maxError, std::fabs(expected[v].position[a] - actual[v].position[a]) / std::max(1.0f, std::fabs(expected[v].position[a])));
+                maxError = std::max(maxError, std::fabs(expected[v].normal[a] - actual[v].normal[a]) / std::max(1.0f, std::fabs(expected[v].normal[a])));
+            }
+        return maxError;
+    }
+
+    static constexpr float MatrixTolerance = 1e-4f;
+
+    // largest component difference of count bone matrices, relative as in SkinningError
+    static float MatrixError(const glm::mat4 *expected, const glm::mat4 *actual, int count)
+    {
+        float maxError = 0.0f;
+        for (int bone = 0; bone < count; bone++)
+            for (int col = 0; col < 4; col++)
+                for (int row = 0; row < 4; row++)
+                    maxError = std::max(maxError, std::fabs(expected[bone][col][row] - actual[bone][col][row]) / std::max(1.0f, std::fabs(expected[bone][col][row])));
+        return maxError;
+    }
+
+    // Runs anim_model.vs over every vertex of each mesh with the rasteriser off and reads
+    // back SkinnedPosition and SkinnedNormal through transform feedback.
+    static bool CaptureShaderSkinning(const std::string &vsPath, const std::string &fsPath, const std::vector<Mesh> &meshes,
+                                      const std::vector<glm::mat4> &bones, std::vector<std::vector<SkinnedVertex>> &captured)
+    {
+        Shader shader(vsPath.c_str(), fsPath.c_str());
+        const char *varyings[] = {"SkinnedPosition", "SkinnedNormal"};
+        glTransformFeedbackVaryings(shader.ID, 2, varyings, GL_INTERLEAVED_ATTRIBS);
+        // varyings only take effect at link time; Shader leaves its stages attached, so relink
+        glLinkProgram(shader.ID);
+        GLint linked = 0;
+        glGetProgramiv(shader.ID, GL_LINK_STATUS, &linked);
+        if (!linked)
+        {
+            std::cout << "  relinking anim_model.vs for transform feedback failed\n";
+            return false;
+        }
+        BonePalette::BindBlock(shader);
+        BonePalette palette;
+        palette.Begin();
+        palette.Add(bones);
+        palette.Upload();
+        palette.Use(0);
+        shader.use();
+        shader.setMat4("projection", glm::mat4(1.0f));
+        shader.setMat4("view", glm::mat4(1.0f));
+        shader.setMat4("model", glm::mat4(1.0f));
+
+        GLuint buffer = 0;
+        glGenBuffers(1, &buffer);
+        glEnable(GL_RASTERIZER_DISCARD);
+        for (size_t m = 0; m < meshes.size(); m++)
+        {
+            const GLsizei count = (GLsizei)meshes[m].vertices.size();
+            const GLsizeiptr bytes = count * sizeof(SkinnedVertex);
+            glBindBuffer(GL_TRANSFORM_FEEDBACK_BUFFER, buffer);
+            glBufferData(GL_TRANSFORM_FEEDBACK_BUFFER, bytes, nullptr, GL_STREAM_READ);
+            glBindBufferBase(GL_TRANSFORM_FEEDBACK_BUFFER, 0, buffer);
+            glBindVertexArray(meshes[m].VAO);
+            glBeginTransformFeedback(GL_POINTS);
+            glDrawArrays(GL_POINTS, 0, count);
+            glEndTransformFeedback();
+            captured[m].resize(count);
+            glGetBufferSubData(GL_TRANSFORM_FEEDBACK_BUFFER, 0, bytes, captured[m].data());
+        }
+        glDisable(GL_RASTERIZER_DISCARD);
+        glBindVertexArray(0);
+        glBindBufferBase(GL_TRANSFORM_FEEDBACK_BUFFER, 0, 0);
+        glDeleteBuffers(1, &buffer);
+        return true;
+    }
+
+    // largest final matrix difference, bone by bone (matched by node name), over each clip's frames
+    static float CompareClips(const std::vector<BakedClip> &reference, const AnimationLibrary &library)
+    {
+        const Skeleton &skeleton = library.GetSkeleton();
+        const Skeleton &referenceSkeleton = reference[0].GetSkeleton();
+        LocalPose pose;
+        std::vector<glm::mat4> globals, finals(BonePalette::MaxBones), referenceFinals(BonePalette::MaxBones);
+        float maxError = 0.0f;
+        for (int c = 0; c < library.ClipCount() && c < (int)reference.size(); c++)
+        {
+            for (int f = 0; f < reference[c].GetFrameCount(); f++)
+            {
+                float t = reference[c].GetDuration() * f / reference[c].GetFrameCount();
+                library.GetClip(c).Sample(t, pose);
+                skeleton.ComputeFinalMatrices(pose, globals, finals);
+                reference[c].Sample(t, pose);
+                referenceSkeleton.ComputeFinalMatrices(pose, globals, referenceFinals);
+                for (int n = 0; n < skeleton.NodeCount(); n++)
+                {
+                    int id = skeleton.boneIds[n];
+                    int node = referenceSkeleton.FindNode(skeleton.names[n]);
+                    int referenceId = node >= 0 ? referenceSkeleton.boneIds[node] : -1;
+                    if (id < 0 || id >= BonePalette::MaxBones || referenceId < 0 || referenceId >= BonePalette::MaxBones)
+                        continue;
+                    for (int col = 0; col < 4; col++)
+                        for (int row = 0; row < 4; row++)
+                            maxError = std::max(maxError, std::fabs(finals[id][col][row] - referenceFinals[referenceId][col][row]));
+                }
+            }
+        }
+        return maxError;
+    }
+
+    struct VertexDifferences
+    {
+        bool sameLayout = true;         // as many meshes, each with as many vertices
+        unsigned int vertices = 0;
+        float maxTexCoordError = 0.0f;
+        unsigned int weightMismatches = 0;
+        unsigned int trimmed = 0;       // differ, but a side uses every slot: Model keeps the
+                                        // first bones it meets, the library the heaviest
+    };
+
+    // Model's vertices against the library's, mesh by mesh: texture coordinates, and bone
+    // ids and relative weights (Model does not renormalise)
+    static VertexDifferences CompareVertices(const Model &model, const AnimationLibrary &library)
+    {
+        VertexDifferences differences;
+        const std::vector<Mesh> &meshes = library.GetMeshes();
+        if (model.meshes.size() != meshes.size())
+        {
+            differences.sameLayout = false;
+            return differences;
+        }
+        for (size_t m = 0; m < meshes.size(); m++)
+        {
+            const std::vector<Vertex> &reference = model.meshes[m].vertices, &vertices = meshes[m].vertices;
+            if (reference.size() != vertices.size())
+            {
+                differences.sameLayout = false;
+                continue;
+            }
+            differences.vertices += (unsigned int)vertices.size();
+            for (size_t v = 0; v < vertices.size(); v++)
+            {
+                const glm::vec2 &uv = vertices[v].TexCoords, &referenceUv = reference[v].TexCoords;
+                differences.maxTexCoordError = std::max(differences.maxTexCoordError,
+                                                        std::max(std::fabs(uv.x - referenceUv.x), std::fabs(uv.y - referenceUv.y)));
+                if (SameInfluences(reference[v], vertices[v]))
+                    continue;
+                if (reference[v].m_BoneIDs[MAX_BONE_INFLUENCE - 1] >= 0 || vertices[v].m_BoneIDs[MAX_BONE_INFLUENCE - 1] >= 0)
+                    differences.trimmed++;
+                else
+                    differences.weightMismatches++;
+            }
+        }
+        return differences;
+    }
+
+    // The assignment model_custom.h used to do: for every vertex, scan every bone's
+    // weight list for it (O(vertices x weights)). Kept only as the baseline; it takes
+    // the first MAX_BONE_INFLUENCE bones in index order and does not renormalise.
+    static void AssignBoneWeightsScan(const aiMesh *mesh, std::vector<Vertex> &vertices)
+    {
+        for (unsigned int i = 0; i < vertices.size(); i++)
+        {
+            Vertex &vertex = vertices[i];
+            ResetBoneInfluences(vertex);
+            std::set<unsigned int> boneSet;
+            for (unsigned int boneIndex = 0; boneIndex < mesh->mNumBones; ++boneIndex)
+            {
+                const aiBone *bone = mesh->mBones[boneIndex];
+                for (unsigned int weightIndex = 0; weightIndex < bone->mNumWeights; ++weightIndex)
+                    if (bone->mWeights[weightIndex].mVertexId == i)
+                        boneSet.insert(boneIndex);
+            }
+
+            int slot = 0;
+            for (unsigned int boneId : boneSet)
+            {
+                if (slot == MAX_BONE_INFLUENCE)
+                    break;
+                const aiBone *bone = mesh->mBones[boneId];
+                for (unsigned int weightIndex = 0; weightIndex < bone->mNumWeights; ++weightIndex)
+                {
+                    if (bone->mWeights[weightIndex].mVertexId == i)
+                    {
+                        vertex.m_BoneIDs[slot] = (int)boneId;
+                        vertex.m_Weights[slot] = bone->mWeights[weightIndex].mWeight;
+                        slot++;
+                        break;
+                    }
+                }
+            }
+        }
+    }
+
+    // Same bones with the same relative weights, for a vertex both passes kept whole.
+    static bool SameInfluences(const Vertex &scanned, const Vertex &linear)
+    {
+        float scanTotal = 0.0f;
+        int scanUsed = 0, linearUsed = 0;
+        for (int i = 0; i < MAX_BONE_INFLUENCE; i++)
+        {
+            if (scanned.m_BoneIDs[i] >= 0 && scanned.m_Weights[i] > 0.0f)
+            {
+                scanTotal += scanned.m_Weights[i];
+                scanUsed++;
+            }
+            if (linear.m_BoneIDs[i] >= 0)
+                linearUsed++;
+        }
+        if (scanUsed != linearUsed)
+            return false;
+        for (int i = 0; i < MAX_BONE_INFLUENCE; i++)
+        {
+            if (scanned.m_BoneIDs[i] < 0 || scanned.m_Weights[i] <= 0.0f)
+                continue;
+            const int *slot = std::find(linear.m_BoneIDs, linear.m_BoneIDs + MAX_BONE_INFLUENCE, scanned.m_BoneIDs[i]);
+            if (slot == linear.m_BoneIDs + MAX_BONE_INFLUENCE || std::fabs(scanned.m_Weights[i] / scanTotal - linear.m_Weights[slot - linear.m_BoneIDs]) > 1e-4f)
+                return false;
+        }
+        return true;
+    }
+};
+
+#endif
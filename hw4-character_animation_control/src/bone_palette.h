@@ -0,0 +1,109 @@
+#ifndef BONE_PALETTE_H
+#define BONE_PALETTE_H
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include <learnopengl/shader.h>
+
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+// Final bone matrices for every character drawn this frame, in one uniform buffer.
+//
+// Each character gets a slot of MaxBones matrices (padded to the driver's UBO offset
+// alignment). Per frame: Begin(), Add() each character's matrices, Upload() once,
+// then Use(slot) before that character's draw to point the shader's BonePalette
+// block at its range with glBindBufferRange. No per-bone uniform names or lookups.
+class BonePalette
+{
+public:
+    // must match MAX_BONES in shaders/anim_model.vs
+    static const int MaxBones = 100;
+    static const GLuint BindingPoint = 0;
+
+    BonePalette(int initialCharacters = 1)
+    {
+        GLint alignment = 256;
+        glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &alignment);
+        const size_t blockBytes = MaxBones * sizeof(glm::mat4);
+        slotBytes = (blockBytes + alignment - 1) / alignment * alignment;
+        glGenBuffers(1, &ubo);
+        Reserve(std::max(initialCharacters, 1));
+    }
+
+    ~BonePalette()
+    {
+        glDeleteBuffers(1, &ubo);
+    }
+
+    BonePalette(const BonePalette &) = delete;
+    BonePalette &operator=(const BonePalette &) = delete;
+
+    // ties the shader's BonePalette uniform block to BindingPoint; once per shader after linking
+    static void BindBlock(const Shader &shader)
+    {
+        GLuint index = glGetUniformBlockIndex(shader.ID, "BonePalette");
+        if (index != GL_INVALID_INDEX)
+            glUniformBlockBinding(shader.ID, index, BindingPoint);
+    }
+
+    void Begin()
+    {
+        used = 0;
+    }
+
+    // copies up to MaxBones matrices into the next slot (missing ones are identity) and returns the slot
+    int Add(const glm::mat4 *matrices, size_t count)
+    {
+        if (used == capacity)
+            Reserve(capacity * 2);
+        unsigned char *slot = staging.data() + used * slotBytes;
+        count = std::min(count, (size_t)MaxBones);
+        std::memcpy(slot, matrices, count * sizeof(glm::mat4));
+        for (size_t i = count; i < (size_t)MaxBones; i++)
+            std::memcpy(slot + i * sizeof(glm::mat4), &identity, sizeof(glm::mat4));
+        return used++;
+    }
+
+    int Add(const std::vector<glm::mat4> &matrices)
+    {
+        return Add(matrices.data(), matrices.size());
+    }
+
+    // Orphans the buffer (so the driver need not wait for last frame's draws) and
+    // uploads every slot added since Begin() with a single glBufferSubData.
+    void Upload()
+    {
+        glBindBuffer(GL_UNIFORM_BUFFER, ubo);
+        glBufferData(GL_UNIFORM_BUFFER, capacity * slotBytes, nullptr, GL_STREAM_DRAW);
+        if (used > 0)
+            glBufferSubData(GL_UNIFORM_BUFFER, 0, used * slotBytes, staging.data());
+        glBindBuffer(GL_UNIFORM_BUFFER, 0);
+    }
+
+    // binds one character's bones to BindingPoint for the next draw
+    void Use(int slot) const
+    {
+        glBindBufferRange(GL_UNIFORM_BUFFER, BindingPoint, ubo, slot * slotBytes, MaxBones * sizeof(glm::mat4));
+    }
+
+    int Size() const { return used; }
+
+private:
+    void Reserve(int characters)
+    {
+        capacity = characters;
+        staging.resize(capacity * slotBytes);
+    }
+
+    GLuint ubo = 0;
+    size_t slotBytes = 0;
+    int capacity = 0;
+    int used = 0;
+    std::vector<unsigned char> staging;
+    glm::mat4 identity = glm::mat4(1.0f);
+};
+
+#endif
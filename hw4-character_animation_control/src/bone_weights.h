@@ -0,0 +1,91 @@
+#ifndef BONE_WEIGHTS_H
+#define BONE_WEIGHTS_H
+
+#include <assimp/scene.h>
+#include <learnopengl/mesh.h>
+
+#include <vector>
+
+// Per-vertex skinning influences built from aiMesh::mBones.
+//
+// Assimp stores weights bone-major (each aiBone lists the vertices it moves),
+// while the shader wants them vertex-major in MAX_BONE_INFLUENCE fixed slots.
+// AssignBoneWeights inverts one into the other with a single pass over every
+// weight, instead of scanning all bones for every vertex.
+
+// marks every slot unused: id -1, weight 0
+inline void ResetBoneInfluences(Vertex &vertex)
+{
+    for (int i = 0; i < MAX_BONE_INFLUENCE; i++)
+    {
+        vertex.m_BoneIDs[i] = -1;
+        vertex.m_Weights[i] = 0.0f;
+    }
+}
+
+// Inserts one influence keeping the slots sorted by descending weight. When the
+// slots are full the lightest influence falls off the end, so after all bones
+// are visited the slots hold the strongest MAX_BONE_INFLUENCE regardless of bone order.
+inline void AddBoneInfluence(Vertex &vertex, int boneId, float weight)
+{
+    int slot = MAX_BONE_INFLUENCE;
+    while (slot > 0 && (vertex.m_BoneIDs[slot - 1] < 0 || vertex.m_Weights[slot - 1] < weight))
+        slot--;
+    if (slot == MAX_BONE_INFLUENCE)
+        return;
+    for (int i = MAX_BONE_INFLUENCE - 1; i > slot; i--)
+    {
+        vertex.m_BoneIDs[i] = vertex.m_BoneIDs[i - 1];
+        vertex.m_Weights[i] = vertex.m_Weights[i - 1];
+    }
+    vertex.m_BoneIDs[slot] = boneId;
+    vertex.m_Weights[slot] = weight;
+}
+
+// rescales the kept weights to sum to 1; dropped influences would otherwise pull the skinned vertex toward the origin
+inline void NormalizeBoneInfluences(Vertex &vertex)
+{
+    float total = 0.0f;
+    for (int i = 0; i < MAX_BONE_INFLUENCE; i++)
+        total += vertex.m_Weights[i];
+    if (total <= 0.0f)
+        return;
+    for (int i = 0; i < MAX_BONE_INFLUENCE; i++)
+        vertex.m_Weights[i] /= total;
+}
+
+// O(vertices + total weights). vertices must hold mesh->mNumVertices entries; bone ids are
+// the mesh-local aiBone indices, or boneIds[aiBone index] when a model-wide mapping is given.
+// Returns how many vertices had more than MAX_BONE_INFLUENCE influences and were trimmed.
+inline unsigned int AssignBoneWeights(const aiMesh *mesh, std::vector<Vertex> &vertices, const std::vector<int> *boneIds = nullptr)
+{
+    std::vector<unsigned char> influenceCount(vertices.size(), 0);
+    for (Vertex &vertex : vertices)
+        ResetBoneInfluences(vertex);
+
+    for (unsigned int boneIndex = 0; boneIndex < mesh->mNumBones; boneIndex++)
+    {
+        const aiBone *bone = mesh->mBones[boneIndex];
+        for (unsigned int w = 0; w < bone->mNumWeights; w++)
+        {
+            const aiVertexWeight &weight = bone->mWeights[w];
+            // Mixamo exports carry explicit zero weights; they only waste a slot
+            if (weight.mVertexId >= vertices.size() || weight.mWeight <= 0.0f)
+                continue;
+            AddBoneInfluence(vertices[weight.mVertexId], boneIds ? (*boneIds)[boneIndex] : (int)boneIndex, weight.mWeight);
+            if (influenceCount[weight.mVertexId] < 255)
+                influenceCount[weight.mVertexId]++;
+        }
+    }
+
+    unsigned int trimmed = 0;
+    for (size_t i = 0; i < vertices.size(); i++)
+    {
+        NormalizeBoneInfluences(vertices[i]);
+        if (influenceCount[i] > MAX_BONE_INFLUENCE)
+            trimmed++;
+    }
+    return trimmed;
+}
+
+#endif
@@ -0,0 +1,289 @@
+#ifndef CLIP_COMPRESSION_H
+#define CLIP_COMPRESSION_H
+
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+// Error budget for BakedClip::Compress
+struct ClipCompression
+{
+    // largest joint position error allowed, as a fraction of the bind pose's height
+    // (1e-4 of a 1.8 m character is 0.18 mm)
+    float tolerance = 1e-4f;
+    // how many times the per-track tolerances may be halved to get within budget
+    int maxRefinements = 6;
+};
+
+// Keyframe tracks at 64 bits per key, minus the keys linear interpolation can rebuild.
+//
+// Every node has a translation, a rotation and a scale track. A track keeps only the
+// frames needed to reconstruct all the others within its tolerance (the first and
+// last always, just the first if the track is constant). A key is its 16-bit frame
+// index plus 48 bits of value:
+// - rotations: smallest three. The largest component is dropped (made positive by
+//   negating the quaternion) and rebuilt from unit length; the other three lie in
+//   [-1/sqrt2, 1/sqrt2] and take 15 bits each, with 2 bits naming the dropped one.
+// - translations and scales: 16 bits per component across the track's own range.
+// Keys are removed by comparing the quantised values against the source, so the
+// tolerance covers both errors. To find a track's keys around a frame without a
+// binary search, each track records its key at the start of every PageFrames frames;
+// a short forward scan goes from there.
+class CompressedTracks
+{
+public:
+    static const int PageFrames = 16;
+
+    enum Channel
+    {
+        Translation,
+        Rotation,
+        Scale,
+        ChannelCount
+    };
+
+    // per node: translation distance, rotation angle (radians), largest scale component error
+    struct Tolerance
+    {
+        float translation;
+        float rotation;
+        float scale;
+    };
+
+    // Source keys are frame-major as in BakedClip, with neighbouring rotations in the same
+    // hemisphere. Frame indices are 16-bit, so frameCount is at most 65536.
+    void Build(const glm::vec3 *translations, const glm::quat *rotations, const glm::vec3 *scales, int frameCount, int nodeCount,
+               const std::vector<Tolerance> &tolerances)
+    {
+        trackStarts.assign(1, 0);
+        keyFrames.clear();
+        values.clear();
+        ranges.clear();
+        pageCount = (frameCount + PageFrames - 1) / PageFrames;
+        pages.clear();
+
+        std::vector<glm::vec3> vectorSource(frameCount), vectorDecoded(frameCount);
+        std::vector<glm::quat> rotationSource(frameCount), rotationDecoded(frameCount);
+        std::vector<uint16_t> quantised((size_t)frameCount * 3);
+        std::vector<int> kept;
+        for (int n = 0; n < nodeCount; n++)
+        {
+            for (int channel = 0; channel < ChannelCount; channel++)
+            {
+                if (channel == Rotation)
+                {
+                    for (int f = 0; f < frameCount; f++)
+                    {
+                        rotationSource[f] = rotations[(size_t)f * nodeCount + n];
+                        EncodeRotation(rotationSource[f], &quantised[f * 3]);
+                        rotationDecoded[f] = DecodeRotation(&quantised[f * 3]);
+                    }
+                    Reduce(rotationSource, rotationDecoded, tolerances[n].rotation, RotationError, kept);
+                }
+                else
+                {
+                    const glm::vec3 *source = channel == Translation ? translations : scales;
+                    for (int f = 0; f < frameCount; f++)
+                        vectorSource[f] = source[(size_t)f * nodeCount + n];
+                    glm::vec3 low = vectorSource[0], high = vectorSource[0];
+                    for (const glm::vec3 &v : vectorSource)
+                    {
+                        low = glm::min(low, v);
+                        high = glm::max(high, v);
+                    }
+                    const glm::vec3 step = (high - low) / 65535.0f;
+                    ranges.push_back(low);
+                    ranges.push_back(step);
+                    for (int f = 0; f < frameCount; f++)
+                    {
+                        EncodeVector(vectorSource[f], low, step, &quantised[f * 3]);
+                        vectorDecoded[f] = DecodeVector(&quantised[f * 3], low, step);
+                    }
+                    if (channel == Translation)
+                        Reduce(vectorSource, vectorDecoded, tolerances[n].translation, DistanceError, kept);
+                    else
+                        Reduce(vectorSource, vectorDecoded, tolerances[n].scale, ComponentError, kept);
+                }
+
+                for (int f : kept)
+                {
+                    keyFrames.push_back((uint16_t)f);
+                    values.insert(values.end(), &quantised[f * 3], &quantised[f * 3] + 3);
+                }
+                // last key at or before each page's first frame, counted from the track's first key
+                size_t k = 0;
+                for (int page = 0; page < pageCount; page++)
+                {
+                    while (k + 1 < kept.size() && kept[k + 1] <= page * PageFrames)
+                        k++;
+                    pages.push_back((uint16_t)k);
+                }
+                trackStarts.push_back((uint32_t)keyFrames.size());
+            }
+        }
+    }
+
+    bool Empty() const { return keyFrames.empty(); }
+    int KeyCount() const { return (int)keyFrames.size(); }
+    size_t GetMemoryBytes() const
+    {
+        return trackStarts.size() * sizeof(uint32_t) + keyFrames.size() * sizeof(uint16_t) + values.size() * sizeof(uint16_t) +
+               ranges.size() * sizeof(glm::vec3) + pages.size() * sizeof(uint16_t);
+    }
+
+    // node's local transform at a fractional frame index
+    void Decode(int node, float frame, glm::vec3 &t, glm::quat &r, glm::vec3 &s) const
+    {
+        const int whole = (int)frame;
+        float alpha;
+        int track = node * ChannelCount;
+        int k = KeyBefore(track + Translation, whole, frame, alpha);
+        const glm::vec3 *range = &ranges[node * 4];
+        t = DecodeVector(&values[k * 3], range[0], range[1]);
+        if (alpha > 0.0f)
+            t = glm::mix(t, DecodeVector(&values[(k + 1) * 3], range[0], range[1]), alpha);
+
+        k = KeyBefore(track + Rotation, whole, frame, alpha);
+        r = DecodeRotation(&values[k * 3]);
+        if (alpha > 0.0f)
+            r = Nlerp(r, DecodeRotation(&values[(k + 1) * 3]), alpha);
+
+        k = KeyBefore(track + Scale, whole, frame, alpha);
+        s = DecodeVector(&values[k * 3], range[2], range[3]);
+        if (alpha > 0.0f)
+            s = glm::mix(s, DecodeVector(&values[(k + 1) * 3], range[2], range[3]), alpha);
+    }
+
+private:
+    // the track's last key at or before frame (never its final key unless it is the only
+    // one) and the blend towards the next
+    int KeyBefore(int track, int whole, float frame, float &alpha) const
+    {
+        const int first = (int)trackStarts[track], end = (int)trackStarts[track + 1];
+        alpha = 0.0f;
+        if (end - first == 1)
+            return first;
+        const uint16_t *keys = keyFrames.data();
+        int k = first + pages[(size_t)track * pageCount + std::min(whole / PageFrames, pageCount - 1)];
+        while (k + 2 < end && keys[k + 1] <= whole)
+            k++;
+        k = std::min(k, end - 2);
+        alpha = std::min(std::max((frame - keys[k]) / (float)(keys[k + 1] - keys[k]), 0.0f), 1.0f);
+        return k;
+    }
+
+    // Greedy: extend each segment until some frame inside it is no longer rebuilt within
+    // tolerance from the decoded keys at its ends, then start the next one at the last good frame.
+    template <typename T, typename Error>
+    static void Reduce(const std::vector<T> &source, const std::vector<T> &decoded, float tolerance, Error error, std::vector<int> &kept)
+    {
+        const int frameCount = (int)source.size();
+        kept.assign(1, 0);
+        bool constant = true;
+        for (int f = 1; f < frameCount && constant; f++)
+            constant = error(decoded[0], source[f]) <= tolerance;
+        if (constant)
+            return;
+
+        int anchor = 0;
+        for (int end = anchor + 2; end < frameCount; end++)
+        {
+            for (int f = anchor + 1; f < end; f++)
+            {
+                if (error(Lerp(decoded[anchor], decoded[end], (float)(f - anchor) / (end - anchor)), source[f]) > tolerance)
+                {
+                    anchor = end - 1;
+                    kept.push_back(anchor);
+                    break;
+                }
+            }
+        }
+        kept.push_back(frameCount - 1);
+    }
+
+    static glm::vec3 Lerp(const glm::vec3 &a, const glm::vec3 &b, float alpha) { return glm::mix(a, b, alpha); }
+    static glm::quat Lerp(const glm::quat &a, const glm::quat &b, float alpha) { return Nlerp(a, b, alpha); }
+
+    // smallest three drops the sign, so neighbouring keys may decode in opposite hemispheres
+    static glm::quat Nlerp(const glm::quat &a, glm::quat b, float alpha)
+    {
+        if (glm::dot(a, b) < 0.0f)
+            b = -b;
+        return glm::normalize(a * (1.0f - alpha) + b * alpha);
+    }
+
+    static float DistanceError(const glm::vec3 &a, const glm::vec3 &b) { return glm::length(a - b); }
+    static float ComponentError(const glm::vec3 &a, const glm::vec3 &b)
+    {
+        glm::vec3 d = glm::abs(a - b);
+        return std::max(std::max(d.x, d.y), d.z);
+    }
+    static float RotationError(const glm::quat &a, const glm::quat &b)
+    {
+        return 2.0f * std::acos(std::min(std::fabs(glm::dot(a, b)), 1.0f));
+    }
+
+    static void EncodeVector(const glm::vec3 &v, const glm::vec3 &low, const glm::vec3 &step, uint16_t *out)
+    {
+        for (int i = 0; i < 3; i++)
+            out[i] = step[i] > 0.0f ? (uint16_t)std::min(std::max(std::lround((v[i] - low[i]) / step[i]), 0L), 65535L) : 0;
+    }
+
+    static glm::vec3 DecodeVector(const uint16_t *in, const glm::vec3 &low, const glm::vec3 &step)
+    {
+        return low + step * glm::vec3(in[0], in[1], in[2]);
+    }
+
+    static void EncodeRotation(const glm::quat &q, uint16_t *out)
+    {
+        const float c[4] = {q.x, q.y, q.z, q.w};
+        int largest = 0;
+        for (int i = 1; i < 4; i++)
+            if (std::fabs(c[i]) > std::fabs(c[largest]))
+                largest = i;
+        const float sign = c[largest] < 0.0f ? -1.0f : 1.0f;
+        uint64_t bits = (uint64_t)largest;
+        for (int i = 0; i < 4; i++)
+        {
+            if (i == largest)
+                continue;
+            float v = c[i] * sign * 1.41421356f;  // [-1, 1]
+            long u = std::lround((v * 0.5f + 0.5f) * 32767.0f);
+            bits = (bits << 15) | (uint64_t)std::min(std::max(u, 0L), 32767L);
+        }
+        out[0] = (uint16_t)(bits >> 32);
+        out[1] = (uint16_t)(bits >> 16);
+        out[2] = (uint16_t)bits;
+    }
+
+    static glm::quat DecodeRotation(const uint16_t *in)
+    {
+        // the three kept components in order, for each dropped index
+        static const int kept[4][3] = {{1, 2, 3}, {0, 2, 3}, {0, 1, 3}, {0, 1, 2}};
+        const uint64_t bits = ((uint64_t)in[0] << 32) | ((uint64_t)in[1] << 16) | in[2];
+        const int largest = (int)(bits >> 45) & 3;
+        const float scale = 2.0f / 32767.0f * 0.70710678f;
+        const float a = (float)((bits >> 30) & 0x7fff) * scale - 0.70710678f;
+        const float b = (float)((bits >> 15) & 0x7fff) * scale - 0.70710678f;
+        const float c = (float)(bits & 0x7fff) * scale - 0.70710678f;
+        float q[4];
+        q[kept[largest][0]] = a;
+        q[kept[largest][1]] = b;
+        q[kept[largest][2]] = c;
+        q[largest] = std::sqrt(std::max(1.0f - a * a - b * b - c * c, 0.0f));
+        return glm::quat(q[3], q[0], q[1], q[2]);
+    }
+
+    std::vector<uint32_t> trackStarts;  // first key of each track (node-major, ChannelCount per node), plus the end
+    std::vector<uint16_t> keyFrames;    // frame index per key
+    std::vector<uint16_t> values;       // three per key
+    std::vector<glm::vec3> ranges;      // per node: translation low and step, scale low and step
+    std::vector<uint16_t> pages;        // pageCount per track: key at each page start, from the track's first
+    int pageCount = 0;
+};
+
+#endif
@@ -0,0 +1,347 @@
+#ifndef CPU_SKINNING_H
+#define CPU_SKINNING_H
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include <learnopengl/mesh.h>
+#include <learnopengl/shader.h>
+
+#include "bone_palette.h"
+#include "crowd.h"  // crowd_lanes
+#include "job_system.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+// Linear blend skinning on the CPU, the same maths as shaders/anim_model.vs.
+//
+// Used as a fallback render path (--cpu-skinning) and as the reference the shader is
+// checked against (--bench-skinning). The kernel runs LaneWidth vertices per pass:
+// each lane gathers its bones' 3x4 matrices, blends them by weight, and transforms
+// its position and normal with the blended matrix. That equals the shader's per-bone
+// sum because skinning is linear in the matrices.
+
+// one skinned vertex in model space, laid out as the shader's transform feedback capture
+// (SkinnedPosition, SkinnedNormal interleaved) and as the fallback path's vertex stream
+struct SkinnedVertex
+{
+    glm::vec3 position;
+    glm::vec3 normal;  // unnormalised, like the shader's
+};
+
+class CpuSkinning
+{
+public:
+    // palette entry after the last bone: identity, for vertices the shader leaves in bind pose
+    static const int RestBone = BonePalette::MaxBones;
+    static const int PaletteFloats = (BonePalette::MaxBones + 1) * 12;
+
+    // Copies one mesh's vertices into SIMD-friendly arrays, padded to whole passes.
+    // The shader's per-slot rules are resolved here, once: id -1 slots are dropped and a
+    // vertex with an id past MaxBones becomes the identity bone at weight 1.
+    explicit CpuSkinning(const std::vector<Vertex> &vertices) : vertexCount((int)vertices.size())
+    {
+        const int W = crowd_lanes::LaneWidth;
+        const int padded = (vertexCount + W - 1) / W * W;
+        for (int a = 0; a < 3; a++)
+        {
+            positions[a].assign(padded, 0.0f);
+            normals[a].assign(padded, 0.0f);
+        }
+        for (int k = 0; k < MAX_BONE_INFLUENCE; k++)
+        {
+            boneIds[k].assign(padded, 0);
+            boneWeights[k].assign(padded, 0.0f);
+        }
+        passSlots.assign(padded / W, 0);
+
+        for (int v = 0; v < vertexCount; v++)
+        {
+            const Vertex &vertex = vertices[v];
+            for (int a = 0; a < 3; a++)
+            {
+                positions[a][v] = vertex.Position[a];
+                normals[a][v] = vertex.Normal[a];
+            }
+            int slots = 0;
+            for (int i = 0; i < MAX_BONE_INFLUENCE; i++)
+            {
+                int id = vertex.m_BoneIDs[i];
+                if (id < 0)
+                    continue;
+                if (id >= BonePalette::MaxBones)
+                {
+                    for (int k = 1; k < slots; k++)
+                        boneWeights[k][v] = 0.0f;
+                    slots = 1;
+                    boneIds[0][v] = RestBone;
+                    boneWeights[0][v] = 1.0f;
+                    break;
+                }
+                boneIds[slots][v] = id;
+                boneWeights[slots][v] = vertex.m_Weights[i];
+                slots++;
+            }
+            // unused slots stay bone 0 at weight 0; a pass only visits slots some lane uses
+            passSlots[v / W] = std::max(passSlots[v / W], slots);
+        }
+    }
+
+    int VertexCount() const { return vertexCount; }
+
+    // Final bone matrices (BonePalette::MaxBones of them, missing ones identity) as the
+    // kernel's palette: column-major 3x4 per bone, plus RestBone.
+    static void BuildPalette(const glm::mat4 *bones, size_t count, std::vector<float> &palette)
+    {
+        palette.resize(PaletteFloats);
+        const glm::mat4 identity(1.0f);
+        count = std::min(count, (size_t)BonePalette::MaxBones);
+        for (int b = 0; b <= BonePalette::MaxBones; b++)
+        {
+            const glm::mat4 &m = b < (int)count ? bones[b] : identity;
+            for (int c = 0; c < 4; c++)
+                for (int r = 0; r < 3; r++)
+                    palette[b * 12 + c * 3 + r] = m[c][r];
+        }
+    }
+
+    // Skins vertices [begin, end) into out (indexed by vertex). Ranges starting on a
+    // multiple of LaneWidth touch no other range's output, so they can run in parallel.
+    void Skin(const std::vector<float> &palette, int begin, int end, SkinnedVertex *out) const
+    {
+        using namespace crowd_lanes;
+        const int W = LaneWidth;
+        end = std::min(end, vertexCount);
+        for (int base = begin - begin % W; base < end; base += W)
+        {
+            Lane m[12];
+            for (int e = 0; e < 12; e++)
+                m[e] = Set1(0.0f);
+            // blended matrix per lane: sum of weight * bone over the slots in use
+            Lane bone[12];
+            const int slots = passSlots[base / W];
+            for (int k = 0; k < slots; k++)
+            {
+                GatherBones(palette.data(), &boneIds[k][base], bone);
+                Lane w = Load(&boneWeights[k][base]);
+                for (int e = 0; e < 12; e++)
+                    m[e] = Add(m[e], Mul(w, bone[e]));
+            }
+
+            Lane px = Load(&positions[0][base]), py = Load(&positions[1][base]), pz = Load(&positions[2][base]);
+            Lane nx = Load(&normals[0][base]), ny = Load(&normals[1][base]), nz = Load(&normals[2][base]);
+            float result[6][W];
+            for (int r = 0; r < 3; r++)
+            {
+                Store(result[r], Add(Add(Mul(m[r], px), Mul(m[3 + r], py)), Add(Mul(m[6 + r], pz), m[9 + r])));
+                Store(result[3 + r], Add(Add(Mul(m[r], nx), Mul(m[3 + r], ny)), Mul(m[6 + r], nz)));
+            }
+            for (int lane = std::max(begin - base, 0); lane < W && base + lane < end; lane++)
+            {
+                out[base + lane].position = glm::vec3(result[0][lane], result[1][lane], result[2][lane]);
+                out[base + lane].normal = glm::vec3(result[3][lane], result[4][lane], result[5][lane]);
+            }
+        }
+    }
+
+    // Every vertex, spread over the job system's workers when one is given.
+    void Skin(const std::vector<float> &palette, SkinnedVertex *out, JobSystem *jobs = nullptr) const
+    {
+        if (!jobs)
+        {
+            Skin(palette, 0, vertexCount, out);
+            return;
+        }
+        const int chunk = VerticesPerJob;
+        jobs->ParallelFor((vertexCount + chunk - 1) / chunk, 1, [&](int begin, int end, int)
+        {
+            Skin(palette, begin * chunk, end * chunk, out);
+        });
+    }
+
+    // anim_model.vs line for line, one vertex at a time: the reference both paths are checked against
+    static SkinnedVertex SkinReference(const Vertex &vertex, const glm::mat4 *bones)
+    {
+        glm::vec4 totalPosition(0.0f);
+        glm::vec3 totalNormal(0.0f);
+        for (int i = 0; i < MAX_BONE_INFLUENCE; i++)
+        {
+            if (vertex.m_BoneIDs[i] == -1)
+                continue;
+            if (vertex.m_BoneIDs[i] >= BonePalette::MaxBones)
+            {
+                totalPosition = glm::vec4(vertex.Position, 1.0f);
+                totalNormal = vertex.Normal;
+                break;
+            }
+            const glm::mat4 &bone = bones[vertex.m_BoneIDs[i]];
+            totalPosition += bone * glm::vec4(vertex.Position, 1.0f) * vertex.m_Weights[i];
+            totalNormal += glm::mat3(bone) * vertex.Normal * vertex.m_Weights[i];
+        }
+        SkinnedVertex skinned;
+        skinned.position = glm::vec3(totalPosition);
+        skinned.normal = totalNormal;
+        return skinned;
+    }
+
+private:
+    // Loads each lane's bone (12 floats) and transposes them so bone[e] holds element e of
+    // every lane: three 4x4 transposes per four lanes instead of 12 scalar copies per lane.
+    static void GatherBones(const float *palette, const int *ids, crowd_lanes::Lane bone[12])
+    {
+#if defined(CROWD_AVX) || defined(CROWD_SSE)
+        __m128 quarter[2][12];
+        for (int half = 0; half < crowd_lanes::LaneWidth / 4; half++)
+        {
+            const float *p0 = palette + ids[half * 4] * 12, *p1 = palette + ids[half * 4 + 1] * 12;
+            const float *p2 = palette + ids[half * 4 + 2] * 12, *p3 = palette + ids[half * 4 + 3] * 12;
+            for (int q = 0; q < 12; q += 4)
+            {
+                __m128 r0 = _mm_loadu_ps(p0 + q), r1 = _mm_loadu_ps(p1 + q), r2 = _mm_loadu_ps(p2 + q), r3 = _mm_loadu_ps(p3 + q);
+                _MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+                quarter[half][q] = r0;
+                quarter[half][q + 1] = r1;
+                quarter[half][q + 2] = r2;
+                quarter[half][q + 3] = r3;
+            }
+        }
+        for (int e = 0; e < 12; e++)
+#if defined(CROWD_AVX)
+            bone[e] = _mm256_insertf128_ps(_mm256_castps128_ps256(quarter[0][e]), quarter[1][e], 1);
+#else
+            bone[e] = quarter[0][e];
+#endif
+#else
+        for (int e = 0; e < 12; e++)
+            bone[e] = palette[ids[0] * 12 + e];
+#endif
+    }
+
+    // a multiple of every LaneWidth, so job ranges never share a pass
+    static const int VerticesPerJob = 1024;
+
+    int vertexCount = 0;
+    std::vector<float> positions[3];  // x, y, z arrays
+    std::vector<float> normals[3];
+    std::vector<int> boneIds[MAX_BONE_INFLUENCE];  // slot-major, compacted to the used slots
+    std::vector<float> boneWeights[MAX_BONE_INFLUENCE];
+    std::vector<int> passSlots;  // per pass of LaneWidth vertices: slots any of them uses
+};
+
+// The fallback render path: meshes skinned by CpuSkinning and streamed to the GPU every
+// draw, then drawn with shaders/cpu_skinned.vs. Texture binding follows Mesh::Draw, with
+// the sampler locations looked up once in the shader given at construction.
+class CpuSkinnedModel
+{
+public:
+    CpuSkinnedModel(const std::vector<Mesh> &meshes, const Shader &shader)
+    {
+        for (const Mesh &mesh : meshes)
+        {
+            Part part(mesh);
+            unsigned int diffuseNr = 1, specularNr = 1, normalNr = 1, heightNr = 1;
+            for (const Texture &texture : mesh.textures)
+            {
+                const std::string &name = texture.type;
+                std::string number;
+                if (name == "texture_diffuse")
+                    number = std::to_string(diffuseNr++);
+                else if (name == "texture_specular")
+                    number = std::to_string(specularNr++);
+                else if (name == "texture_normal")
+                    number = std::to_string(normalNr++);
+                else if (name == "texture_height")
+                    number = std::to_string(heightNr++);
+                part.samplers.push_back(glGetUniformLocation(shader.ID, (name + number).c_str()));
+            }
+
+            std::vector<glm::vec2> texCoords;
+            texCoords.reserve(mesh.vertices.size());
+            for (const Vertex &vertex : mesh.vertices)
+                texCoords.push_back(vertex.TexCoords);
+
+            glGenVertexArrays(1, &part.vao);
+            glGenBuffers(1, &part.stream);
+            glGenBuffers(1, &part.texCoords);
+            glGenBuffers(1, &part.ebo);
+            glBindVertexArray(part.vao);
+            glBindBuffer(GL_ARRAY_BUFFER, part.stream);
+            glBufferData(GL_ARRAY_BUFFER, mesh.vertices.size() * sizeof(SkinnedVertex), nullptr, GL_STREAM_DRAW);
+            glEnableVertexAttribArray(0);
+            glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(SkinnedVertex), (void *)offsetof(SkinnedVertex, position));
+            glEnableVertexAttribArray(1);
+            glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(SkinnedVertex), (void *)offsetof(SkinnedVertex, normal));
+            glBindBuffer(GL_ARRAY_BUFFER, part.texCoords);
+            glBufferData(GL_ARRAY_BUFFER, texCoords.size() * sizeof(glm::vec2), texCoords.data(), GL_STATIC_DRAW);
+            glEnableVertexAttribArray(2);
+            glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, sizeof(glm::vec2), (void *)0);
+            glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, part.ebo);
+            glBufferData(GL_ELEMENT_ARRAY_BUFFER, mesh.indices.size() * sizeof(unsigned int), mesh.indices.data(), GL_STATIC_DRAW);
+            glBindVertexArray(0);
+            parts.push_back(part);
+        }
+    }
+
+    ~CpuSkinnedModel()
+    {
+        for (Part &part : parts)
+        {
+            glDeleteVertexArrays(1, &part.vao);
+            glDeleteBuffers(1, &part.stream);
+            glDeleteBuffers(1, &part.texCoords);
+            glDeleteBuffers(1, &part.ebo);
+        }
+    }
+
+    CpuSkinnedModel(const CpuSkinnedModel &) = delete;
+    CpuSkinnedModel &operator=(const CpuSkinnedModel &) = delete;
+
+    // skins every mesh with one character's final bone matrices and draws it; the
+    // constructor's shader must be in use
+    void Draw(const glm::mat4 *bones, size_t boneCount, JobSystem *jobs = nullptr)
+    {
+        CpuSkinning::BuildPalette(bones, boneCount, palette);
+        for (Part &part : parts)
+        {
+            skinned.resize(part.skinning.VertexCount());
+            part.skinning.Skin(palette, skinned.data(), jobs);
+            glBindBuffer(GL_ARRAY_BUFFER, part.stream);
+            // orphan, so this draw does not wait on the previous character's
+            glBufferData(GL_ARRAY_BUFFER, skinned.size() * sizeof(SkinnedVertex), nullptr, GL_STREAM_DRAW);
+            glBufferSubData(GL_ARRAY_BUFFER, 0, skinned.size() * sizeof(SkinnedVertex), skinned.data());
+
+            for (unsigned int i = 0; i < part.textures.size(); i++)
+            {
+                glActiveTexture(GL_TEXTURE0 + i);
+                glUniform1i(part.samplers[i], i);
+                glBindTexture(GL_TEXTURE_2D, part.textures[i].id);
+            }
+            glBindVertexArray(part.vao);
+            glDrawElements(GL_TRIANGLES, part.indexCount, GL_UNSIGNED_INT, 0);
+            glBindVertexArray(0);
+            glActiveTexture(GL_TEXTURE0);
+        }
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+    }
+
+private:
+    struct Part
+    {
+        explicit Part(const Mesh &mesh) : skinning(mesh.vertices), textures(mesh.textures), indexCount((GLsizei)mesh.indices.size()) {}
+
+        CpuSkinning skinning;
+        std::vector<Texture> textures;
+        std::vector<GLint> samplers;  // per texture, its texture_diffuseN etc. location
+        GLsizei indexCount;
+        GLuint vao = 0, stream = 0, texCoords = 0, ebo = 0;
+    };
+
+    std::vector<Part> parts;
+    std::vector<float> palette;
+    std::vector<SkinnedVertex> skinned;  // one mesh's output, reused for every draw
+};
+
+#endif
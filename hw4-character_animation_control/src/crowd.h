@@ -0,0 +1,678 @@
+#ifndef CROWD_H
+#define CROWD_H
+
+#include <glm/glm.hpp>
+#include <glm/gtc/type_ptr.hpp>
+
+#include "baked_clip.h"
+#include "bone_palette.h"
+#include "job_system.h"
+
+#include <algorithm>
+#include <cmath>
+#include <string>
+#include <vector>
+
+#if defined(__AVX__)
+#define CROWD_AVX 1
+#include <immintrin.h>
+#elif defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#define CROWD_SSE 1
+#include <xmmintrin.h>
+#endif
+
+// One float per character of a batch: the crowd kernel runs the same skeleton for
+// LaneWidth characters at once, each character in its own SIMD lane.
+namespace crowd_lanes
+{
+#if defined(CROWD_AVX)
+    const int LaneWidth = 8;
+    typedef __m256 Lane;
+    inline Lane Set1(float v) { return _mm256_set1_ps(v); }
+    inline Lane Load(const float *p) { return _mm256_loadu_ps(p); }
+    inline void Store(float *p, Lane v) { _mm256_storeu_ps(p, v); }
+    inline Lane Add(Lane a, Lane b) { return _mm256_add_ps(a, b); }
+    inline Lane Sub(Lane a, Lane b) { return _mm256_sub_ps(a, b); }
+    inline Lane Mul(Lane a, Lane b) { return _mm256_mul_ps(a, b); }
+#elif defined(CROWD_SSE)
+    const int LaneWidth = 4;
+    typedef __m128 Lane;
+    inline Lane Set1(float v) { return _mm_set1_ps(v); }
+    inline Lane Load(const float *p) { return _mm_loadu_ps(p); }
+    inline void Store(float *p, Lane v) { _mm_storeu_ps(p, v); }
+    inline Lane Add(Lane a, Lane b) { return _mm_add_ps(a, b); }
+    inline Lane Sub(Lane a, Lane b) { return _mm_sub_ps(a, b); }
+    inline Lane Mul(Lane a, Lane b) { return _mm_mul_ps(a, b); }
+#else
+    const int LaneWidth = 1;
+    typedef float Lane;
+    inline Lane Set1(float v) { return v; }
+    inline Lane Load(const float *p) { return *p; }
+    inline void Store(float *p, Lane v) { *p = v; }
+    inline Lane Add(Lane a, Lane b) { return a + b; }
+    inline Lane Sub(Lane a, Lane b) { return a - b; }
+    inline Lane Mul(Lane a, Lane b) { return a * b; }
+#endif
+}
+
+// One animation level of detail. A character uses the first tier whose minScreenSize
+// it reaches; the last tier takes everything smaller.
+struct AnimationLodTier
+{
+    float minScreenSize = 0.0f;     // character height over viewport height
+    int updateInterval = 1;         // frames per pose evaluation
+    bool interpolate = true;        // blend towards each evaluation instead of holding the last
+    bool skipDetailBones = false;   // fingers, face and leaf bones keep their bind pose
+    bool sharedPose = false;        // one pose per clip, shared by the whole tier
+};
+
+// Many instances of one skeleton, each with its own BlendState (one clip, or a
+// crossfade of up to BlendState::MaxLayers clips) and playback times.
+//
+// Update() samples every instance's local pose, then builds final matrices for
+// LaneWidth instances per pass: local TRS -> affine matrix, concatenation with the
+// parent's global matrix, and the bone offset all run as SIMD over the flattened
+// parent-index array (parents precede children, so one forward pass suffices).
+// Matrices are kept as 3x4 affine (bone transforms have no projective row).
+// Batches are independent, so with a JobSystem they are spread across its workers,
+// each with its own scratch.
+//
+// Animation LOD: each update every instance picks a tier from its size on screen.
+// Instances due for an evaluation are grouped by tier, so every batch runs a single
+// tier's settings. Reduced-rate tiers evaluate an instance every updateInterval frames
+// (staggered by index) into a key pose, and its palette moves a step towards the key
+// each frame. That step streams the whole palette, so it only pays off over intervals
+// of a few frames; without interpolate the evaluation lands in the palette and holds.
+// Detail bones are carried rigidly by their nearest animated ancestor.
+// A sharedPose tier evaluates one palette per clip and hands it to all its instances.
+// Until SetLodTiers() is called there is a single full-rate tier.
+class Crowd
+{
+public:
+    // batches of LaneWidth instances handed to a worker at a time
+    static const int BatchesPerJob = 8;
+    // instances per job when stepping interpolated palettes
+    static const int InterpolationsPerJob = 64;
+
+    explicit Crowd(const Skeleton &skeleton) : skeleton(&skeleton)
+    {
+        const int nodeCount = skeleton.NodeCount();
+        offsets.resize(nodeCount * 12);
+        for (int n = 0; n < nodeCount; n++)
+            StoreAffine(skeleton.offsets[n], &offsets[n * 12]);
+        FindDetailBones();
+        bindHeight = skeleton.BindHeight();
+        ReserveScratch(1);
+        SetLodTiers(std::vector<AnimationLodTier>());
+    }
+
+    // Every clip must have been baked against this crowd's skeleton. transform places
+    // the instance in the world; LOD reads its position and scale from it.
+    int AddInstance(const BakedClip *clip, float time, const glm::mat4 &transform = glm::mat4(1.0f))
+    {
+        instances.emplace_back();
+        instances.back().Play(clip, time);
+        palettes.resize(instances.size() * BonePalette::MaxBones, glm::mat4(1.0f));
+        keys.resize(instances.size() * skeleton->boneCount, glm::mat4(1.0f));
+        lodStates.emplace_back();
+        sharedSlots.push_back(-1);
+        positions.emplace_back();
+        heights.emplace_back();
+        SetInstanceTransform((int)instances.size() - 1, transform);
+        return (int)instances.size() - 1;
+    }
+
+    void SetInstanceTransform(int i, const glm::mat4 &transform)
+    {
+        float scale = std::max(std::max(glm::length(glm::vec3(transform[0])), glm::length(glm::vec3(transform[1]))), glm::length(glm::vec3(transform[2])));
+        positions[i] = glm::vec3(transform[3]);
+        heights[i] = bindHeight * scale;
+    }
+
+    void Clear()
+    {
+        instances.clear();
+        palettes.clear();
+        keys.clear();
+        lodStates.clear();
+        sharedSlots.clear();
+        positions.clear();
+        heights.clear();
+    }
+
+    // Tiers from the most to the least detailed; an empty list means one full-rate tier.
+    // Every instance re-enters its tier on the next update.
+    void SetLodTiers(const std::vector<AnimationLodTier> &tiers)
+    {
+        lodTiers = tiers.empty() ? std::vector<AnimationLodTier>(1) : tiers;
+        lodCounts.assign(lodTiers.size(), 0);
+        tierEvaluations.resize(lodTiers.size());
+        for (LodState &state : lodStates)
+            state = LodState();
+    }
+
+    // Full rate up close, then a third of the rate, a sixth without detail bones, and
+    // a shared pose once a character is a few dozen pixels tall.
+    static std::vector<AnimationLodTier> DefaultLodTiers()
+    {
+        std::vector<AnimationLodTier> tiers(4);
+        tiers[0].minScreenSize = 0.25f;
+        tiers[1].minScreenSize = 0.1f;
+        tiers[1].updateInterval = 3;
+        tiers[2].minScreenSize = 0.04f;
+        tiers[2].updateInterval = 6;
+        tiers[2].skipDetailBones = true;
+        tiers[3].sharedPose = true;
+        return tiers;
+    }
+
+    // where the tiers are measured from: camera position and vertical field of view
+    void SetViewer(const glm::vec3 &position, float fovYRadians)
+    {
+        viewerPosition = position;
+        viewerTanHalfFov = std::tan(fovYRadians * 0.5f);
+    }
+
+    // jobs == nullptr runs every batch on the calling thread
+    void Update(float dt, JobSystem *jobs = nullptr)
+    {
+        Advance(dt);
+        SelectLods();
+        UpdateSharedPoses();
+        const int batches = (int)lodBatches.size();
+        const int steps = (int)interpolating.size();
+        if (!jobs)
+        {
+            for (int b = 0; b < batches; b++)
+                UpdateBatch(b, scratch[0]);
+            for (int i = 0; i < steps; i++)
+                StepTowardsKey(interpolating[i]);
+            return;
+        }
+        ReserveScratch(jobs->WorkerCount());
+        jobs->ParallelFor(batches, BatchesPerJob, [this](int begin, int end, int worker)
+        {
+            for (int b = begin; b < end; b++)
+                UpdateBatch(b, scratch[worker]);
+        });
+        jobs->ParallelFor(steps, InterpolationsPerJob, [this](int begin, int end, int)
+        {
+            for (int i = begin; i < end; i++)
+                StepTowardsKey(interpolating[i]);
+        });
+    }
+
+    // reference path: BakedClip::Sample + Skeleton::ComputeFinalMatrices per instance,
+    // every instance at full detail
+    void UpdateScalar(float dt)
+    {
+        Advance(dt);
+        for (size_t i = 0; i < instances.size(); i++)
+        {
+            lodStates[i] = LodState();
+            sharedSlots[i] = -1;
+        }
+        Scratch &s = scratch[0];
+        for (size_t i = 0; i < instances.size(); i++)
+        {
+            instances[i].Evaluate(s.pose);
+            std::vector<glm::mat4>::iterator first = palettes.begin() + i * BonePalette::MaxBones;
+            s.finals.assign(first, first + BonePalette::MaxBones);
+            skeleton->ComputeFinalMatrices(s.pose, s.matrices, s.finals);
+            std::copy(s.finals.begin(), s.finals.end(), first);
+        }
+    }
+
+    int Size() const { return (int)instances.size(); }
+    // e.g. GetInstance(i).CrossFade(clip, seconds)
+    BlendState &GetInstance(int i) { return instances[i]; }
+    // BonePalette::MaxBones matrices for instance i; shared between instances in a sharedPose tier
+    const glm::mat4 *GetFinalBoneMatrices(int i) const
+    {
+        return sharedSlots[i] >= 0 ? sharedPoses[sharedSlots[i]].palette.data() : &palettes[(size_t)i * BonePalette::MaxBones];
+    }
+
+    const std::vector<AnimationLodTier> &GetLodTiers() const { return lodTiers; }
+    // instances in each tier at the last Update()
+    const std::vector<int> &GetLodCounts() const { return lodCounts; }
+    // instance i's tier at the last Update(), -1 before it
+    int GetLodTier(int i) const { return lodStates[i].tier; }
+    // poses evaluated by the last Update(), shared poses included
+    int GetEvaluatedCount() const { return (int)lodOrder.size() + usedSharedPoses; }
+    // bones a skipDetailBones tier does not animate
+    int DetailBoneCount() const { return (int)detailBones.size(); }
+
+private:
+    static const int TrsFloats = 10;  // translation xyz, rotation xyzw, scale xyz
+
+    struct LodState
+    {
+        int tier = -1;       // -1 until the first update after SetLodTiers
+        int framesLeft = 0;  // interpolation steps until the key pose is reached
+        bool snap = false;   // palette is stale: jump straight to the next key
+    };
+
+    // the instances of one batch: lodOrder[begin, begin + count), all in one tier
+    struct LodBatch
+    {
+        int begin;
+        int count;
+        int tier;
+    };
+
+    struct SharedPose
+    {
+        const BakedClip *clip;
+        float time;
+        bool used;
+        std::vector<glm::mat4> palette;
+    };
+
+    // a bone held at its bind pose relative to the nearest animated ancestor
+    struct DetailBone
+    {
+        int anchor;      // node whose global matrix carries it
+        int id;          // palette slot
+        float rest[12];  // bind chain from the anchor, times the bone offset
+    };
+
+    // everything one batch writes besides its own palettes; one per worker
+    struct Scratch
+    {
+        std::vector<float> trs;      // node-major, LaneWidth floats per component
+        std::vector<float> globals;  // node-major 3x4, LaneWidth floats per element
+        LocalPose pose;  // blend target for every instance the worker evaluates
+        std::vector<glm::mat4> matrices, finals;  // UpdateScalar only
+    };
+
+    void ReserveScratch(int workers)
+    {
+        const int nodeCount = skeleton->NodeCount();
+        while ((int)scratch.size() < workers)
+        {
+            scratch.emplace_back();
+            scratch.back().trs.resize((size_t)nodeCount * TrsFloats * crowd_lanes::LaneWidth);
+            scratch.back().globals.resize((size_t)nodeCount * 12 * crowd_lanes::LaneWidth);
+        }
+    }
+
+    // Nodes a skipDetailBones tier leaves out: finger chains and eyes/jaw by name, plus
+    // leaves (Mixamo's *_End helpers among them) and everything below any of those.
+    // Parents precede children, so one forward pass closes the set over descendants.
+    void FindDetailBones()
+    {
+        static const char *detailNames[] = {"HandThumb", "HandIndex", "HandMiddle", "HandRing", "HandPinky", "Eye", "Jaw"};
+        const int nodeCount = skeleton->NodeCount();
+        std::vector<int> children(nodeCount, 0);
+        for (int n = 0; n < nodeCount; n++)
+            if (skeleton->parents[n] >= 0)
+                children[skeleton->parents[n]]++;
+
+        std::vector<char> detail(nodeCount, 0);
+        std::vector<int> anchors(nodeCount, -1);
+        std::vector<glm::mat4> chains(nodeCount, glm::mat4(1.0f));  // bind transform from the anchor
+        coarseNodes.clear();
+        detailBones.clear();
+        for (int n = 0; n < nodeCount; n++)
+        {
+            const int parent = skeleton->parents[n];
+            if (parent >= 0)
+            {
+                bool named = false;
+                for (const char *name : detailNames)
+                    named = named || skeleton->names[n].find(name) != std::string::npos;
+                detail[n] = detail[parent] || named || children[n] == 0;
+            }
+            if (!detail[n])
+            {
+                coarseNodes.push_back(n);
+                continue;
+            }
+            anchors[n] = detail[parent] ? anchors[parent] : parent;
+            chains[n] = detail[parent] ? chains[parent] * skeleton->bindLocal[n] : skeleton->bindLocal[n];
+            const int id = skeleton->boneIds[n];
+            if (id < 0 || id >= BonePalette::MaxBones)
+                continue;
+            DetailBone bone;
+            bone.anchor = anchors[n];
+            bone.id = id;
+            StoreAffine(chains[n] * skeleton->offsets[n], bone.rest);
+            detailBones.push_back(bone);
+        }
+    }
+
+    int ChooseTier(int i) const
+    {
+        float distance = std::max(glm::length(positions[i] - viewerPosition), 1e-3f);
+        float screenSize = heights[i] / (2.0f * distance * viewerTanHalfFov);
+        int tier = 0;
+        while (tier + 1 < (int)lodTiers.size() && screenSize < lodTiers[tier].minScreenSize)
+            tier++;
+        return tier;
+    }
+
+    // Tier per instance, then the batches of instances due for an evaluation, the
+    // instances whose palettes step towards a key and the shared pose each uses.
+    void SelectLods()
+    {
+        std::fill(lodCounts.begin(), lodCounts.end(), 0);
+        for (std::vector<int> &list : tierEvaluations)
+            list.clear();
+        interpolating.clear();
+        for (SharedPose &shared : sharedPoses)
+            shared.used = false;
+
+        for (int i = 0; i < Size(); i++)
+        {
+            const int tier = ChooseTier(i);
+            const AnimationLodTier &settings = lodTiers[tier];
+            LodState &state = lodStates[i];
+            const bool entering = state.tier != tier;
+            const bool stale = state.tier < 0 || lodTiers[state.tier].sharedPose;
+            state.tier = tier;
+            lodCounts[tier]++;
+
+            sharedSlots[i] = settings.sharedPose ? SharedSlot(instances[i].GetTarget()) : -1;
+            if (settings.sharedPose)
+                continue;
+            if (settings.updateInterval <= 1)
+            {
+                tierEvaluations[tier].push_back(i);
+                continue;
+            }
+            if (entering)
+            {
+                state.framesLeft = 0;
+                state.snap = stale;
+            }
+            if (state.framesLeft <= 0)
+            {
+                tierEvaluations[tier].push_back(i);
+                // the first cycle in a tier is shortened by index so evaluations spread over frames
+                state.framesLeft = entering ? 1 + i % settings.updateInterval : settings.updateInterval;
+            }
+            // StepTowardsKey counts the frames down for interpolated tiers
+            if (settings.interpolate)
+                interpolating.push_back(i);
+            else
+                state.framesLeft--;
+        }
+
+        lodOrder.clear();
+        lodBatches.clear();
+        for (int tier = 0; tier < (int)lodTiers.size(); tier++)
+        {
+            const std::vector<int> &list = tierEvaluations[tier];
+            for (size_t begin = 0; begin < list.size(); begin += crowd_lanes::LaneWidth)
+            {
+                LodBatch batch = {(int)(lodOrder.size() + begin), (int)std::min(list.size() - begin, (size_t)crowd_lanes::LaneWidth), tier};
+                lodBatches.push_back(batch);
+            }
+            lodOrder.insert(lodOrder.end(), list.begin(), list.end());
+        }
+    }
+
+    int SharedSlot(const BakedClip *clip)
+    {
+        if (!clip)
+            return -1;
+        for (size_t i = 0; i < sharedPoses.size(); i++)
+        {
+            if (sharedPoses[i].clip == clip)
+            {
+                sharedPoses[i].used = true;
+                return (int)i;
+            }
+        }
+        SharedPose shared = {clip, 0.0f, true, std::vector<glm::mat4>(BonePalette::MaxBones, glm::mat4(1.0f))};
+        sharedPoses.push_back(shared);
+        return (int)sharedPoses.size() - 1;
+    }
+
+    // one scalar evaluation per clip in use, on the calling thread
+    void UpdateSharedPoses()
+    {
+        Scratch &s = scratch[0];
+        usedSharedPoses = 0;
+        for (SharedPose &shared : sharedPoses)
+        {
+            if (!shared.used)
+                continue;
+            shared.clip->Sample(shared.time, s.pose);
+            skeleton->ComputeFinalMatrices(s.pose, s.matrices, shared.palette);
+            usedSharedPoses++;
+        }
+    }
+
+    // One interpolation step: the remaining distance to the key over the frames left.
+    // Keys have the palette's layout, so this is one flat lerp the compiler vectorises.
+    void StepTowardsKey(int i)
+    {
+        LodState &state = lodStates[i];
+        const float t = state.snap ? 1.0f : 1.0f / std::max(state.framesLeft, 1);
+        const int floats = std::min(skeleton->boneCount, BonePalette::MaxBones) * 16;
+        const float *key = glm::value_ptr(keys[(size_t)i * skeleton->boneCount]);
+        float *palette = glm::value_ptr(palettes[(size_t)i * BonePalette::MaxBones]);
+        for (int f = 0; f < floats; f++)
+            palette[f] += (key[f] - palette[f]) * t;
+        state.snap = false;
+        state.framesLeft--;
+    }
+
+    void UpdateBatch(int batch, Scratch &s)
+    {
+        const int W = crowd_lanes::LaneWidth;
+        const LodBatch &b = lodBatches[batch];
+        const AnimationLodTier &settings = lodTiers[b.tier];
+        const int *members = &lodOrder[b.begin];
+        const std::vector<int> *nodes = settings.skipDetailBones ? &coarseNodes : nullptr;
+        for (int l = 0; l < W; l++)
+        {
+            if (l < b.count)
+            {
+                instances[members[l]].Evaluate(s.pose, nodes);
+                ScatterPose(s.pose, l, s.trs, nodes);
+            }
+            else
+            {
+                ScatterIdentity(l, s.trs, nodes);
+            }
+        }
+        ComputeBatch(members, b.count, settings.updateInterval > 1 && settings.interpolate, nodes, s);
+    }
+
+    static void StoreAffine(const glm::mat4 &m, float *out)
+    {
+        for (int c = 0; c < 4; c++)
+            for (int r = 0; r < 3; r++)
+                out[c * 3 + r] = m[c][r];
+    }
+
+    void Advance(float dt)
+    {
+        for (BlendState &instance : instances)
+            instance.Advance(dt);
+        for (SharedPose &shared : sharedPoses)
+            shared.time = std::fmod(shared.time + dt, std::max(shared.clip->GetDuration(), 1e-6f));
+    }
+
+    // one instance's pose into lane l of the batch's TRS block (only the listed nodes, if any)
+    void ScatterPose(const LocalPose &p, int l, std::vector<float> &trs, const std::vector<int> *nodes) const
+    {
+        const int W = crowd_lanes::LaneWidth;
+        const int count = nodes ? (int)nodes->size() : skeleton->NodeCount();
+        for (int i = 0; i < count; i++)
+        {
+            const int n = nodes ? (*nodes)[i] : i;
+            float *node = &trs[(size_t)n * TrsFloats * W];
+            node[0 * W + l] = p.translations[n].x;
+            node[1 * W + l] = p.translations[n].y;
+            node[2 * W + l] = p.translations[n].z;
+            node[3 * W + l] = p.rotations[n].x;
+            node[4 * W + l] = p.rotations[n].y;
+            node[5 * W + l] = p.rotations[n].z;
+            node[6 * W + l] = p.rotations[n].w;
+            node[7 * W + l] = p.scales[n].x;
+            node[8 * W + l] = p.scales[n].y;
+            node[9 * W + l] = p.scales[n].z;
+        }
+    }
+
+    // unused lanes of the last batch get a valid identity pose and are never written back
+    void ScatterIdentity(int l, std::vector<float> &trs, const std::vector<int> *nodes) const
+    {
+        const int W = crowd_lanes::LaneWidth;
+        const int count = nodes ? (int)nodes->size() : skeleton->NodeCount();
+        for (int i = 0; i < count; i++)
+        {
+            const int n = nodes ? (*nodes)[i] : i;
+            float *node = &trs[(size_t)n * TrsFloats * W];
+            for (int k = 0; k < TrsFloats; k++)
+                node[k * W + l] = k >= 6 ? 1.0f : 0.0f;  // rotation w and scale
+        }
+    }
+
+    // members[0, lanes) are the instances in the batch's lanes. Finals go to their
+    // palettes, or to their key poses for a reduced-rate tier. With a node list only
+    // those nodes are composed and the detail bones follow their anchors.
+    void ComputeBatch(const int *members, int lanes, bool toKeys, const std::vector<int> *nodes, Scratch &s)
+    {
+        using namespace crowd_lanes;
+        const int W = LaneWidth;
+        const int count = nodes ? (int)nodes->size() : skeleton->NodeCount();
+        const Lane one = Set1(1.0f), two = Set1(2.0f);
+        float out[12 * LaneWidth];
+
+        for (int i = 0; i < count; i++)
+        {
+            const int n = nodes ? (*nodes)[i] : i;
+            const float *node = &s.trs[(size_t)n * TrsFloats * W];
+            Lane tx = Load(node + 0 * W), ty = Load(node + 1 * W), tz = Load(node + 2 * W);
+            Lane qx = Load(node + 3 * W), qy = Load(node + 4 * W), qz = Load(node + 5 * W), qw = Load(node + 6 * W);
+            Lane sx = Load(node + 7 * W), sy = Load(node + 8 * W), sz = Load(node + 9 * W);
+
+            // local = T * R(q) * S, columns scaled by s
+            Lane xx = Mul(qx, qx), yy = Mul(qy, qy), zz = Mul(qz, qz);
+            Lane xy = Mul(qx, qy), xz = Mul(qx, qz), yz = Mul(qy, qz);
+            Lane wx = Mul(qw, qx), wy = Mul(qw, qy), wz = Mul(qw, qz);
+            Lane L[12];
+            L[0] = Mul(Sub(one, Mul(two, Add(yy, zz))), sx);
+            L[1] = Mul(Mul(two, Add(xy, wz)), sx);
+            L[2] = Mul(Mul(two, Sub(xz, wy)), sx);
+            L[3] = Mul(Mul(two, Sub(xy, wz)), sy);
+            L[4] = Mul(Sub(one, Mul(two, Add(xx, zz))), sy);
+            L[5] = Mul(Mul(two, Add(yz, wx)), sy);
+            L[6] = Mul(Mul(two, Add(xz, wy)), sz);
+            L[7] = Mul(Mul(two, Sub(yz, wx)), sz);
+            L[8] = Mul(Sub(one, Mul(two, Add(xx, yy))), sz);
+            L[9] = tx;
+            L[10] = ty;
+            L[11] = tz;
+
+            // global = parent global * local
+            Lane G[12];
+            float *global = &s.globals[(size_t)n * 12 * W];
+            const int parent = skeleton->parents[n];
+            if (parent < 0)
+            {
+                for (int e = 0; e < 12; e++)
+                    G[e] = L[e];
+            }
+            else
+            {
+                const float *pg = &s.globals[(size_t)parent * 12 * W];
+                Lane P[12];
+                for (int e = 0; e < 12; e++)
+                    P[e] = Load(pg + e * W);
+                for (int c = 0; c < 4; c++)
+                {
+                    for (int r = 0; r < 3; r++)
+                    {
+                        Lane v = Add(Add(Mul(P[0 + r], L[c * 3 + 0]), Mul(P[3 + r], L[c * 3 + 1])), Mul(P[6 + r], L[c * 3 + 2]));
+                        G[c * 3 + r] = c == 3 ? Add(v, P[9 + r]) : v;
+                    }
+                }
+            }
+            for (int e = 0; e < 12; e++)
+                Store(global + e * W, G[e]);
+
+            const int id = skeleton->boneIds[n];
+            if (id < 0 || id >= BonePalette::MaxBones)
+                continue;
+
+            // final = global * offset (the offset is shared by every lane)
+            MulShared(G, &offsets[n * 12], out);
+            StoreFinals(members, lanes, id, out, toKeys);
+        }
+        if (!nodes)
+            return;
+
+        for (const DetailBone &bone : detailBones)
+        {
+            const float *anchor = &s.globals[(size_t)bone.anchor * 12 * W];
+            Lane G[12];
+            for (int e = 0; e < 12; e++)
+                G[e] = Load(anchor + e * W);
+            MulShared(G, bone.rest, out);
+            StoreFinals(members, lanes, bone.id, out, toKeys);
+        }
+    }
+
+    // out = G * m for a 3x4 m shared by every lane
+    static void MulShared(const crowd_lanes::Lane *G, const float *m, float *out)
+    {
+        using namespace crowd_lanes;
+        const int W = LaneWidth;
+        for (int c = 0; c < 4; c++)
+        {
+            for (int r = 0; r < 3; r++)
+            {
+                Lane v = Add(Add(Mul(G[0 + r], Set1(m[c * 3 + 0])), Mul(G[3 + r], Set1(m[c * 3 + 1]))), Mul(G[6 + r], Set1(m[c * 3 + 2])));
+                Store(out + (c * 3 + r) * W, c == 3 ? Add(v, G[9 + r]) : v);
+            }
+        }
+    }
+
+    void StoreFinals(const int *members, int lanes, int id, const float *out, bool toKeys)
+    {
+        const int W = crowd_lanes::LaneWidth;
+        for (int l = 0; l < lanes; l++)
+        {
+            glm::mat4 &m = toKeys ? keys[(size_t)members[l] * skeleton->boneCount + id]
+                                  : palettes[(size_t)members[l] * BonePalette::MaxBones + id];
+            for (int c = 0; c < 4; c++)
+                m[c] = glm::vec4(out[(c * 3 + 0) * W + l], out[(c * 3 + 1) * W + l], out[(c * 3 + 2) * W + l], c == 3 ? 1.0f : 0.0f);
+        }
+    }
+
+    const Skeleton *skeleton;
+    std::vector<BlendState> instances;
+    std::vector<glm::mat4> palettes;  // MaxBones per instance
+    std::vector<glm::mat4> keys;      // boneCount per instance: where a reduced-rate palette is heading
+    std::vector<float> offsets;       // 12 per node, column-major 3x4
+    std::vector<Scratch> scratch;
+
+    std::vector<AnimationLodTier> lodTiers;
+    std::vector<LodState> lodStates;
+    std::vector<glm::vec3> positions;  // world position per instance
+    std::vector<float> heights;        // world height per instance
+    glm::vec3 viewerPosition = glm::vec3(0.0f);
+    float viewerTanHalfFov = 0.41421356f;  // 45 degrees
+    float bindHeight = 1.0f;
+
+    // rebuilt every update, capacity kept
+    std::vector<int> lodCounts;
+    std::vector<std::vector<int>> tierEvaluations;
+    std::vector<int> lodOrder;
+    std::vector<LodBatch> lodBatches;
+    std::vector<int> interpolating;
+
+    std::vector<int> sharedSlots;  // per instance, -1 unless in a sharedPose tier
+    std::vector<SharedPose> sharedPoses;
+    int usedSharedPoses = 0;
+
+    std::vector<int> coarseNodes;  // nodes a skipDetailBones tier still animates
+    std::vector<DetailBone> detailBones;
+};
+
+#endif
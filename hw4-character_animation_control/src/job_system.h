@@ -0,0 +1,229 @@
+#ifndef JOB_SYSTEM_H
+#define JOB_SYSTEM_H
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Work-stealing thread pool for data-parallel loops (independent characters' poses).
+//
+// Worker 0 is the thread that calls ParallelFor; the others are pool threads. Each
+// worker owns a fixed-size job ring: ParallelFor deals the chunks of a loop across the
+// rings, every worker drains its own ring from the back and, when empty, steals from
+// the front of another's. The caller works too and returns once every chunk has run.
+// Job storage is preallocated and loop bodies are referenced, not copied, so a
+// ParallelFor allocates nothing.
+class JobSystem
+{
+public:
+    struct WorkerStats
+    {
+        double busyMs = 0.0;    // time spent inside loop bodies
+        unsigned int jobs = 0;  // chunks executed
+        unsigned int steals = 0;
+    };
+
+    // workerCount 0 = one per hardware thread (the calling thread included)
+    explicit JobSystem(int workerCount = 0)
+    {
+        if (workerCount <= 0)
+            workerCount = std::max(1, (int)std::thread::hardware_concurrency());
+        for (int i = 0; i < workerCount; i++)
+            workers.emplace_back(new Worker());
+        for (int i = 1; i < workerCount; i++)
+            workers[i]->thread = std::thread(&JobSystem::WorkerLoop, this, i);
+        ResetStats();
+    }
+
+    ~JobSystem()
+    {
+        {
+            std::lock_guard<std::mutex> guard(sleepLock);
+            quit = true;
+        }
+        wake.notify_all();
+        for (size_t i = 1; i < workers.size(); i++)
+            workers[i]->thread.join();
+    }
+
+    JobSystem(const JobSystem &) = delete;
+    JobSystem &operator=(const JobSystem &) = delete;
+
+    int WorkerCount() const { return (int)workers.size(); }
+
+    // Runs body(begin, end, worker) over [0, count) in chunks of about grain items and
+    // waits for all of them. worker is in [0, WorkerCount()), for per-worker scratch.
+    // Must not be called from inside a body.
+    template <typename Body>
+    void ParallelFor(int count, int grain, const Body &body)
+    {
+        if (count <= 0)
+            return;
+        grain = std::max(grain, 1);
+        const int chunks = (count + grain - 1) / grain;
+        std::atomic<int> remaining(chunks);
+
+        Job job;
+        job.invoke = &Invoke<Body>;
+        job.body = &body;
+        job.remaining = &remaining;
+        for (int c = 0; c < chunks; c++)
+        {
+            job.begin = c * grain;
+            job.end = std::min(count, job.begin + grain);
+            // a full ring means the loop is far finer than the pool; run the chunk here
+            if (!Push(c % (int)workers.size(), job))
+                Run(0, job);
+        }
+        if (workers.size() > 1)
+        {
+            std::lock_guard<std::mutex> guard(sleepLock);
+            wake.notify_all();
+        }
+
+        while (remaining.load(std::memory_order_acquire) > 0)
+        {
+            if (TakeJob(0, job))
+                Run(0, job);
+            else
+                std::this_thread::yield();
+        }
+    }
+
+    void ResetStats()
+    {
+        for (auto &worker : workers)
+        {
+            std::lock_guard<std::mutex> guard(worker->lock);
+            worker->stats = WorkerStats();
+        }
+        statsStart = Clock::now();
+    }
+
+    const WorkerStats &GetStats(int worker) const { return workers[worker]->stats; }
+
+    // busy time over wall time since ResetStats, 0..1
+    double Utilisation(int worker) const
+    {
+        double wallMs = std::chrono::duration<double, std::milli>(Clock::now() - statsStart).count();
+        return wallMs > 0.0 ? workers[worker]->stats.busyMs / wallMs : 0.0;
+    }
+
+private:
+    typedef std::chrono::steady_clock Clock;
+    static const int RingCapacity = 1024;
+
+    struct Job
+    {
+        void (*invoke)(const void *body, int begin, int end, int worker) = nullptr;
+        const void *body = nullptr;
+        int begin = 0;
+        int end = 0;
+        std::atomic<int> *remaining = nullptr;
+    };
+
+    struct Worker
+    {
+        std::mutex lock;  // guards the ring and stats; held only to push, pop or steal one job
+        Job ring[RingCapacity];
+        int head = 0;  // oldest job, taken by thieves
+        int size = 0;
+        WorkerStats stats;
+        std::thread thread;
+    };
+
+    template <typename Body>
+    static void Invoke(const void *body, int begin, int end, int worker)
+    {
+        (*static_cast<const Body *>(body))(begin, end, worker);
+    }
+
+    bool Push(int w, const Job &job)
+    {
+        Worker &worker = *workers[w];
+        std::lock_guard<std::mutex> guard(worker.lock);
+        if (worker.size == RingCapacity)
+            return false;
+        worker.ring[(worker.head + worker.size) % RingCapacity] = job;
+        worker.size++;
+        queued.fetch_add(1, std::memory_order_release);
+        return true;
+    }
+
+    // own ring from the back (most recently dealt), then other rings from the front
+    bool TakeJob(int w, Job &job)
+    {
+        {
+            Worker &own = *workers[w];
+            std::lock_guard<std::mutex> guard(own.lock);
+            if (own.size > 0)
+            {
+                own.size--;
+                job = own.ring[(own.head + own.size) % RingCapacity];
+                queued.fetch_sub(1, std::memory_order_relaxed);
+                return true;
+            }
+        }
+        const int count = (int)workers.size();
+        for (int i = 1; i < count; i++)
+        {
+            Worker &victim = *workers[(w + i) % count];
+            std::unique_lock<std::mutex> guard(victim.lock, std::try_to_lock);
+            if (!guard.owns_lock() || victim.size == 0)
+                continue;
+            job = victim.ring[victim.head];
+            victim.head = (victim.head + 1) % RingCapacity;
+            victim.size--;
+            queued.fetch_sub(1, std::memory_order_relaxed);
+            guard.unlock();
+            std::lock_guard<std::mutex> own(workers[w]->lock);
+            workers[w]->stats.steals++;
+            return true;
+        }
+        return false;
+    }
+
+    void Run(int w, const Job &job)
+    {
+        auto start = Clock::now();
+        job.invoke(job.body, job.begin, job.end, w);
+        double ms = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+        {
+            std::lock_guard<std::mutex> guard(workers[w]->lock);
+            workers[w]->stats.busyMs += ms;
+            workers[w]->stats.jobs++;
+        }
+        job.remaining->fetch_sub(1, std::memory_order_release);
+    }
+
+    void WorkerLoop(int w)
+    {
+        Job job;
+        for (;;)
+        {
+            if (TakeJob(w, job))
+            {
+                Run(w, job);
+                continue;
+            }
+            std::unique_lock<std::mutex> guard(sleepLock);
+            wake.wait(guard, [this] { return quit || queued.load(std::memory_order_acquire) > 0; });
+            if (quit)
+                return;
+        }
+    }
+
+    std::vector<std::unique_ptr<Worker>> workers;
+    std::atomic<int> queued{0};  // jobs sitting in rings, so idle workers know when to wake
+    std::mutex sleepLock;
+    std::condition_variable wake;
+    bool quit = false;  // guarded by sleepLock
+    Clock::time_point statsStart;
+};
+
+#endif
@@ -10,10 +10,23 @@
 #include "animator.h"
 #include "model_animation.h"
 #include "filesystem.h"
+#include "bone_palette.h"
+#include "baked_clip.h"
+#include "crowd.h"
+#include "job_system.h"
+#include "animation_library.h"
+#include "cpu_skinning.h"
+#include "benchmark.h"
 
 #include <iostream>
+#include <string>
+#include <vector>
+#include <memory>
+#include <algorithm>
 #include <filesystem>
 #include <cstdlib>
+#include <cmath>
+#include <cstdio>
 #include <direct.h>
 
 const unsigned int SCR_WIDTH = 800;
@@ -30,26 +43,59 @@ float lastFrame = 0.0f;
 void framebuffer_size_callback(GLFWwindow* window, int width, int height);
 void mouse_callback(GLFWwindow* window, double xpos, double ypos);
 void scroll_callback(GLFWwindow* window, double xoffset, double yoffset);
-void processInput(GLFWwindow *window, Animator &animator, glm::vec3 &characterPos, float &characterRotation);
+void processInput(GLFWwindow *window, BakedAnimator &animator, glm::vec3 &characterPos, float &characterRotation);
 
 // Global animation pointers
-Animation* idleAnim_ptr = nullptr;
-Animation* walkAnim_ptr = nullptr;
-Animation* danceAnim_ptr = nullptr;
-Animation* g_currentAnimation = nullptr;  // Track current animation to prevent restarting
+const BakedClip* idleAnim_ptr = nullptr;
+const BakedClip* walkAnim_ptr = nullptr;
+const BakedClip* danceAnim_ptr = nullptr;
+const BakedClip* g_currentAnimation = nullptr;  // Track current animation to prevent restarting
+
+// Blend time when switching between idle, walk and dance
+float crossFadeSeconds = 0.25f;
 
 // Dance state tracking
 bool isDancingState = false;
 float lastDanceKeyPressTime = -1.0f;
-float danceAnimationDuration = 0.0f;
+float danceAnimationDuration = 0.0f;  // seconds, as glfwGetTime
 
-int main()
+int main(int argc, char** argv)
 {
+    // --bench-weights [file.dae ...]: bone weight assignment timings, no window needed
+    if(argc>1 && std::string(argv[1])=="--bench-weights"){
+        std::vector<std::string> files(argv+2, argv+argc);
+        if(files.empty())
+            files={"resources/objects/doozy/Happy Idle.dae","resources/objects/doozy/Walking.dae","resources/objects/doozy/Gangnam Style.dae"};
+        return Benchmark::BoneWeights(files);
+    }
+
     glfwInit();
     glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR,3);
     glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR,3);
     glfwWindowHint(GLFW_OPENGL_PROFILE,GLFW_OPENGL_CORE_PROFILE);
 
+    // --bench-pose [updates], --bench-blend [updates], --bench-compression [samples], --bench-crowd, --bench-jobs [N],
+    // --bench-lod [N], --bench-startup [runs], --bench-skinning: need a GL context (Model loads textures) but no visible window
+    std::string mode = argc>1 ? argv[1] : "";
+    bool benchStartup = mode=="--bench-startup";
+    bool benchSkinning = mode=="--bench-skinning";
+    bool benchPose = mode=="--bench-pose";
+    bool benchBlend = mode=="--bench-blend";
+    bool benchCompression = mode=="--bench-compression";
+    bool benchCrowd = mode=="--bench-crowd";
+    bool benchJobs = mode=="--bench-jobs";
+    bool benchLod = mode=="--bench-lod";
+    if(benchStartup || benchSkinning || benchPose || benchBlend || benchCompression || benchCrowd || benchJobs || benchLod)
+        glfwWindowHint(GLFW_VISIBLE,GLFW_FALSE);
+    // --crowd [N]: N more doozy instances around the player, each with its own clip and time
+    int crowdSize = mode=="--crowd" ? (argc>2 ? std::max(1, std::atoi(argv[2])) : 100) : 0;
+    // --cpu-skinning (anywhere on the command line): skin on the CPU and stream the vertices instead of skinning in anim_model.vs
+    bool cpuSkinningMode = std::find(argv+1, argv+argc, std::string("--cpu-skinning")) != argv+argc;
+    // --no-lod (anywhere on the command line): every crowd member at full animation detail
+    bool crowdLod = std::find(argv+1, argv+argc, std::string("--no-lod")) == argv+argc;
+    // --compress-clips (anywhere on the command line): keep the clips as error-bounded 48-bit keys instead of float frames
+    bool compressClips = std::find(argv+1, argv+argc, std::string("--compress-clips")) != argv+argc;
+
     GLFWwindow* window = glfwCreateWindow(SCR_WIDTH,SCR_HEIGHT,"Character Animation Control - WASD to move, E to dance, Arrow keys for camera",NULL,NULL);
     if(!window){
         std::cout<<"Failed to create GLFW window\n";
@@ -80,24 +126,125 @@ int main()
     std::string danceModelPath = "resources/objects/doozy/Gangnam Style.dae";
     std::string shaderVSPath = FileSystem::getPath("shaders/anim_model.vs");
     std::string shaderFSPath = FileSystem::getPath("shaders/anim_model.fs");
+
+    if(benchStartup){
+        int runs = argc>2 ? std::max(1, std::atoi(argv[2])) : 3;
+        int result = Benchmark::Startup(modelPath, {modelPath, walkModelPath, danceModelPath}, runs);
+        glfwTerminate();
+        return result;
+    }
+    if(benchSkinning){
+        int result = Benchmark::Skinning(modelPath, {modelPath, walkModelPath, danceModelPath}, shaderVSPath, shaderFSPath);
+        glfwTerminate();
+        return result;
+    }
+    if(benchPose){
+        int updates = argc>2 ? std::max(1, std::atoi(argv[2])) : 10000;
+        int result = Benchmark::PoseEvaluation(modelPath, {modelPath, walkModelPath, danceModelPath}, updates);
+        glfwTerminate();
+        return result;
+    }
+    if(benchBlend){
+        int updates = argc>2 ? std::max(1, std::atoi(argv[2])) : 10000;
+        int result = Benchmark::BlendEvaluation(modelPath, {modelPath, walkModelPath, danceModelPath}, updates);
+        glfwTerminate();
+        return result;
+    }
+    if(benchCompression){
+        int samples = argc>2 ? std::max(1, std::atoi(argv[2])) : 10000;
+        int result = Benchmark::Compression(modelPath, {modelPath, walkModelPath, danceModelPath}, samples);
+        glfwTerminate();
+        return result;
+    }
+    if(benchCrowd){
+        int result = Benchmark::CrowdUpdate(modelPath, {modelPath, walkModelPath, danceModelPath}, {100, 1000, 10000});
+        glfwTerminate();
+        return result;
+    }
+    if(benchJobs){
+        int count = argc>2 ? std::max(1, std::atoi(argv[2])) : 10000;
+        int result = Benchmark::JobScaling(modelPath, {modelPath, walkModelPath, danceModelPath}, count);
+        glfwTerminate();
+        return result;
+    }
+    if(benchLod){
+        int count = argc>2 ? std::max(1, std::atoi(argv[2])) : 10000;
+        int result = Benchmark::CrowdLod(modelPath, {modelPath, walkModelPath, danceModelPath}, count);
+        glfwTerminate();
+        return result;
+    }
     
     // Load shader first
     Shader ourShader(shaderVSPath.c_str(), shaderFSPath.c_str());
+    BonePalette::BindBlock(ourShader);
+    BonePalette bonePalette;
 
-    // Load models using relative paths
+    // Crowd characters are independent; their poses are evaluated across all cores
+    JobSystem jobs;
 
-    Model ourModel(modelPath);
-    Animation idleAnim(modelPath, &ourModel);
-    Animation walkAnim(walkModelPath, &ourModel);
-    Animation danceAnim(danceModelPath, &ourModel);
+    // Load models using relative paths. The idle file is imported once for the mesh, skeleton
+    // and idle clip; the other clips are imported on the workers for their channels only.
+    // Every clip is resampled into flat tracks, so per-frame pose sampling needs no key
+    // search or name lookups.
+    AnimationLibrary library;
+    if(!library.Load(modelPath, {modelPath, walkModelPath, danceModelPath}, jobs)){
+        glfwTerminate();
+        return -1;
+    }
+    const AnimationLibrary::LoadTimes& loadTimes = library.GetLoadTimes();
+    std::cout<<"Loaded character in "<<loadTimes.totalMs<<" ms (import "<<loadTimes.importMs<<", bake "<<loadTimes.bakeMs
+             <<", meshes "<<loadTimes.meshMs<<")\n";
+    if(compressClips){
+        double compressMs = library.CompressClips(ClipCompression(), jobs);
+        std::cout<<"Compressed clips in "<<compressMs<<" ms:";
+        for(int c=0;c<library.ClipCount();++c)
+            std::cout<<" "<<library.GetClip(c).GetMemoryBytes()/1024<<" KiB (error "<<library.GetClip(c).GetCompressionError()<<")";
+        std::cout<<"\n";
+    }
+    const Skeleton& skeleton = library.GetSkeleton();
+    const BakedClip& idleClip = library.GetClip(0);
+    const BakedClip& walkClip = library.GetClip(1);
+    const BakedClip& danceClip = library.GetClip(2);
     
     // Set global pointers
-    idleAnim_ptr = &idleAnim;
-    walkAnim_ptr = &walkAnim;
-    danceAnim_ptr = &danceAnim;
-    danceAnimationDuration = danceAnim.GetDuration();
+    idleAnim_ptr = &idleClip;
+    walkAnim_ptr = &walkClip;
+    danceAnim_ptr = &danceClip;
+    // BakedClip durations are in seconds; Animation::GetDuration() was in ticks, which
+    // made the dance state last ticks-many seconds (the clip looped meanwhile)
+    danceAnimationDuration = danceClip.GetDuration();
     
-    Animator animator(&idleAnim);
+    BakedAnimator animator(&idleClip);
+
+    // CPU skinning fallback: pre-skinned vertices drawn with a pass-through vertex shader
+    std::unique_ptr<Shader> cpuSkinnedShader;
+    std::unique_ptr<CpuSkinnedModel> cpuSkinnedModel;
+    if(cpuSkinningMode){
+        cpuSkinnedShader.reset(new Shader(FileSystem::getPath("shaders/cpu_skinned.vs").c_str(), shaderFSPath.c_str()));
+        cpuSkinnedModel.reset(new CpuSkinnedModel(library.GetMeshes(), *cpuSkinnedShader));
+    }
+
+    float jobStatsStart = 0.0f;
+    float crowdSwitchTime = 0.0f;
+    int crowdSwitches = 0;
+    double crowdUpdateSeconds = 0.0;
+    int crowdUpdates = 0;
+
+    // Crowd on a grid behind the player, cycling through the clips with staggered start times.
+    // Animation detail drops with size on screen: reduced update rates, no finger or face
+    // bones, then one shared pose per clip (Crowd::DefaultLodTiers; edit the table to tune).
+    Crowd crowd(skeleton);
+    if(crowdLod)
+        crowd.SetLodTiers(Crowd::DefaultLodTiers());
+    std::vector<glm::mat4> crowdTransforms;
+    const BakedClip* crowdClips[] = {&idleClip, &walkClip, &danceClip};
+    int crowdColumns = (int)std::ceil(std::sqrt((float)crowdSize));
+    for(int i=0;i<crowdSize;++i){
+        const BakedClip* clip = crowdClips[i%3];
+        glm::vec3 pos((i%crowdColumns - crowdColumns*0.5f)*1.2f, -0.5f, -2.0f - (i/crowdColumns)*1.2f);
+        crowdTransforms.push_back(glm::scale(glm::translate(glm::mat4(1.0f), pos), glm::vec3(0.5f)));
+        crowd.AddInstance(clip, std::fmod(i*0.618f*clip->GetDuration(), clip->GetDuration()), crowdTransforms.back());
+    }
     
     // Character position and rotation
     glm::vec3 characterPos(0.0f, -0.5f, 0.0f);
@@ -114,28 +261,81 @@ int main()
 
         processInput(window, animator, characterPos, characterRotation);
         animator.UpdateAnimation(deltaTime);
+        if(crowd.Size()>0){
+            // every few seconds each crowd member crossfades to its next clip
+            if(currentFrame - crowdSwitchTime >= 4.0f){
+                ++crowdSwitches;
+                for(int i=0;i<crowd.Size();++i)
+                    crowd.GetInstance(i).CrossFade(crowdClips[(i+crowdSwitches)%3], crossFadeSeconds*2.0f);
+                crowdSwitchTime = currentFrame;
+            }
+            double crowdStart = glfwGetTime();
+            crowd.SetViewer(camera.Position, glm::radians(camera.Zoom));
+            crowd.Update(deltaTime, &jobs);
+            crowdUpdateSeconds += glfwGetTime() - crowdStart;
+            ++crowdUpdates;
+            // once a second: crowd update cost, characters per LOD tier and how busy the job workers were
+            if(currentFrame - jobStatsStart >= 1.0f){
+                double busy = 0.0;
+                for(int w=0;w<jobs.WorkerCount();++w)
+                    busy += jobs.Utilisation(w);
+                std::string tiers;
+                for(int n : crowd.GetLodCounts())
+                    tiers += (tiers.empty() ? "" : "/") + std::to_string(n);
+                char title[200];
+                std::snprintf(title, sizeof(title), "Crowd %d - update %.2f ms - LOD %s - %d workers %.0f%% busy",
+                              crowd.Size(), 1000.0*crowdUpdateSeconds/crowdUpdates, tiers.c_str(), jobs.WorkerCount(), 100.0*busy/jobs.WorkerCount());
+                glfwSetWindowTitle(window, title);
+                jobs.ResetStats();
+                jobStatsStart = currentFrame;
+                crowdUpdateSeconds = 0.0;
+                crowdUpdates = 0;
+            }
+        }
 
         glClearColor(0.1f,0.1f,0.1f,1.0f);
         glClear(GL_COLOR_BUFFER_BIT|GL_DEPTH_BUFFER_BIT);
 
-        ourShader.use();
+        Shader& shader = cpuSkinningMode ? *cpuSkinnedShader : ourShader;
+        shader.use();
 
         glm::mat4 projection = glm::perspective(glm::radians(camera.Zoom), (float)SCR_WIDTH/(float)SCR_HEIGHT, 0.1f,100.0f);
         glm::mat4 view = camera.GetViewMatrix();
-        ourShader.setMat4("projection",projection);
-        ourShader.setMat4("view",view);
-
-        auto transforms = animator.GetFinalBoneMatrices();
-        for(int i=0;i<transforms.size();++i)
-            ourShader.setMat4("finalBonesMatrices["+std::to_string(i)+"]",transforms[i]);
+        shader.setMat4("projection",projection);
+        shader.setMat4("view",view);
 
         glm::mat4 model=glm::mat4(1.0f);
         model=glm::translate(model, characterPos);
         model=glm::rotate(model, characterRotation, glm::vec3(0.0f, 1.0f, 0.0f));
         model=glm::scale(model,glm::vec3(0.5f));
-        ourShader.setMat4("model",model);
+        shader.setMat4("model",model);
+
+        if(cpuSkinningMode){
+            // each character is skinned across the workers, streamed and drawn in turn
+            const std::vector<glm::mat4>& bones = animator.GetFinalBoneMatrices();
+            cpuSkinnedModel->Draw(bones.data(), bones.size(), &jobs);
+            for(int i=0;i<crowd.Size();++i){
+                shader.setMat4("model",crowdTransforms[i]);
+                cpuSkinnedModel->Draw(crowd.GetFinalBoneMatrices(i), BonePalette::MaxBones, &jobs);
+            }
+        }
+        else{
+            // every character's bones go up in one UBO upload; each draw binds its own range
+            bonePalette.Begin();
+            int characterSlot = bonePalette.Add(animator.GetFinalBoneMatrices());
+            for(int i=0;i<crowd.Size();++i)
+                bonePalette.Add(crowd.GetFinalBoneMatrices(i), BonePalette::MaxBones);
+            bonePalette.Upload();
+            bonePalette.Use(characterSlot);
+
+            library.Draw(shader);
 
-        ourModel.Draw(ourShader);
+            for(int i=0;i<crowd.Size();++i){
+                bonePalette.Use(characterSlot+1+i);
+                shader.setMat4("model",crowdTransforms[i]);
+                library.Draw(shader);
+            }
+        }
 
         glfwSwapBuffers(window);
         glfwPollEvents();
@@ -145,7 +345,7 @@ int main()
     return 0;
 }
 
-void processInput(GLFWwindow* window, Animator &animator, glm::vec3 &characterPos, float &characterRotation)
+void processInput(GLFWwindow* window, BakedAnimator &animator, glm::vec3 &characterPos, float &characterRotation)
 {
     if(glfwGetKey(window,GLFW_KEY_ESCAPE)==GLFW_PRESS)
         glfwSetWindowShouldClose(window,true);
@@ -191,7 +391,7 @@ void processInput(GLFWwindow* window, Animator &animator, glm::vec3 &characterPo
     }
     
     // Determine target animation
-    Animation* targetAnimation = nullptr;
+    const BakedClip* targetAnimation = nullptr;
     if (isDancingState) {
         targetAnimation = danceAnim_ptr;
     } else if (isMoving) {
@@ -200,9 +400,9 @@ void processInput(GLFWwindow* window, Animator &animator, glm::vec3 &characterPo
         targetAnimation = idleAnim_ptr;
     }
     
-    // Only change animation if it's different from current
+    // Only change animation if it's different from current; blend into it instead of popping
     if (targetAnimation != g_currentAnimation) {
-        animator.PlayAnimation(targetAnimation);
+        animator.CrossFade(targetAnimation, crossFadeSeconds);
         g_currentAnimation = targetAnimation;
     }
     
@@ -13,6 +13,8 @@
 #include <learnopengl/mesh.h>
 #include <learnopengl/shader.h>
 
+#include "bone_weights.h"
+
 #include <string>
 #include <fstream>
 #include <sstream>
@@ -94,6 +96,7 @@ private:
         vector<Vertex> vertices;
         vector<unsigned int> indices;
         vector<Texture> textures;
+        vertices.reserve(mesh->mNumVertices);
 
         // Walk through each of the mesh's vertices
         for(unsigned int i = 0; i < mesh->mNumVertices; i++)
@@ -141,29 +144,10 @@ private:
                 vertex.Bitangent = vector;
             }
 
-            // bones
-            set<unsigned int> boneSet;
-            for(int boneIndex = 0; boneIndex < mesh->mNumBones; ++boneIndex) {
-                aiBone* bone = mesh->mBones[boneIndex];
-                for(int weightIndex = 0; weightIndex < bone->mNumWeights; ++weightIndex) {
-                    if(bone->mWeights[weightIndex].mVertexId == (unsigned int)i) {
-                        boneSet.insert(boneIndex);
-                    }
-                }
-            }
-
-            for(int boneId : boneSet) {
-                vertex.m_BoneIDs.push_back(boneId);
-                for(int weightIndex = 0; weightIndex < mesh->mBones[boneId]->mNumWeights; ++weightIndex) {
-                    if(mesh->mBones[boneId]->mWeights[weightIndex].mVertexId == (unsigned int)i) {
-                        vertex.m_Weights.push_back(mesh->mBones[boneId]->mWeights[weightIndex].mWeight);
-                        break;
-                    }
-                }
-            }
-
             vertices.push_back(vertex);
         }
+        // bone influences: one pass over every aiBone's weights, top MAX_BONE_INFLUENCE per vertex, renormalised
+        AssignBoneWeights(mesh, vertices);
         // now wak through each of the mesh's faces (a face is a mesh its triangle) and retrieve the corresponding vertex indices.
         for(unsigned int i = 0; i < mesh->mNumFaces; i++)
         {